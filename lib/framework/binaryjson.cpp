@@ -0,0 +1,397 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2005-2019  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/**
+ * @file binaryjson.cpp
+ *
+ * File format, fixed size numbers big endian, the rest as variable length unsigned integers (varint,
+ * 7 bits per byte, least significant first, high bit set if more follow):
+ *   "WZbj", uint32_t version,
+ *   uint32_t length, string table: varint count, then for each string: varint length, bytes,
+ *   uint32_t length, the root value.
+ * Each value is a tag byte followed by:
+ *   null, false, true: nothing,
+ *   integer: varint of the zigzag encoded value, unsigned: varint, float: uint64_t of the IEEE double,
+ *   string: varint index into the string table,
+ *   array: varint count, then the values,
+ *   object: varint count, then for each member: varint index of the key into the string table, value.
+ */
+#include "frame.h"
+#include "binaryjson.h"
+
+#include <string.h>
+#include <unordered_map>
+#include <vector>
+
+#define BINARY_JSON_VERSION 1
+#define BINARY_JSON_MAX_DEPTH 64  ///< Deepest nesting of arrays and objects accepted when decoding.
+
+enum BINARY_JSON_TAG
+{
+	BJ_NULL,
+	BJ_FALSE,
+	BJ_TRUE,
+	BJ_INTEGER,
+	BJ_UNSIGNED,
+	BJ_FLOAT,
+	BJ_STRING,
+	BJ_ARRAY,
+	BJ_OBJECT,
+};
+
+bool binaryJsonDetect(const char *data, size_t size)
+{
+	return size >= 4 && memcmp(data, "WZbj", 4) == 0;
+}
+
+// Encoding
+
+namespace
+{
+struct Encoder
+{
+	std::unordered_map<std::string, uint32_t> stringIndices;
+	std::vector<std::string const *> strings;  ///< Points at the keys of stringIndices.
+	std::string body;
+
+	void putVarint(std::string &out, uint64_t v)
+	{
+		while (v >= 0x80)
+		{
+			out.push_back(char((v & 0x7F) | 0x80));
+			v >>= 7;
+		}
+		out.push_back(char(v));
+	}
+
+	void putString(std::string const &str)
+	{
+		auto it = stringIndices.find(str);
+		if (it == stringIndices.end())
+		{
+			it = stringIndices.emplace(str, strings.size()).first;
+			strings.push_back(&it->first);
+		}
+		putVarint(body, it->second);
+	}
+
+	void putValue(nlohmann::json const &value)
+	{
+		switch (value.type())
+		{
+		case nlohmann::json::value_t::boolean:
+			body.push_back(value.get<bool>() ? BJ_TRUE : BJ_FALSE);
+			break;
+		case nlohmann::json::value_t::number_integer:
+			{
+				int64_t i = value.get<int64_t>();
+				body.push_back(BJ_INTEGER);
+				putVarint(body, (uint64_t(i) << 1) ^ uint64_t(i >> 63));
+				break;
+			}
+		case nlohmann::json::value_t::number_unsigned:
+			body.push_back(BJ_UNSIGNED);
+			putVarint(body, value.get<uint64_t>());
+			break;
+		case nlohmann::json::value_t::number_float:
+			{
+				double d = value.get<double>();
+				uint64_t bits;
+				memcpy(&bits, &d, sizeof(bits));
+				body.push_back(BJ_FLOAT);
+				for (int shift = 56; shift >= 0; shift -= 8)
+				{
+					body.push_back(char(bits >> shift));
+				}
+				break;
+			}
+		case nlohmann::json::value_t::string:
+			body.push_back(BJ_STRING);
+			putString(value.get_ref<std::string const &>());
+			break;
+		case nlohmann::json::value_t::array:
+			body.push_back(BJ_ARRAY);
+			putVarint(body, value.size());
+			for (auto const &element : value)
+			{
+				putValue(element);
+			}
+			break;
+		case nlohmann::json::value_t::object:
+			body.push_back(BJ_OBJECT);
+			putVarint(body, value.size());
+			for (auto it = value.begin(); it != value.end(); ++it)
+			{
+				putString(it.key());
+				putValue(it.value());
+			}
+			break;
+		default:  // null and discarded
+			body.push_back(BJ_NULL);
+			break;
+		}
+	}
+};
+
+void appendUint32(std::string &out, uint32_t v)
+{
+	out.push_back(char(v >> 24));
+	out.push_back(char(v >> 16));
+	out.push_back(char(v >> 8));
+	out.push_back(char(v));
+}
+}
+
+std::string binaryJsonEncode(const nlohmann::json &root)
+{
+	Encoder encoder;
+	encoder.putValue(root);
+
+	std::string table;
+	encoder.putVarint(table, encoder.strings.size());
+	for (std::string const *str : encoder.strings)
+	{
+		encoder.putVarint(table, str->size());
+		table += *str;
+	}
+
+	std::string out = "WZbj";
+	out.reserve(16 + table.size() + encoder.body.size());
+	appendUint32(out, BINARY_JSON_VERSION);
+	appendUint32(out, table.size());
+	out += table;
+	appendUint32(out, encoder.body.size());
+	out += encoder.body;
+	return out;
+}
+
+// Decoding
+
+namespace
+{
+/// Reads the data front to back, failing instead of reading past the end.
+struct Decoder
+{
+	const uint8_t *pos;
+	const uint8_t *end;
+	std::vector<std::string> strings;
+	bool ok = true;
+
+	bool getByte(uint8_t &b)
+	{
+		if (pos == end)
+		{
+			return ok = false;
+		}
+		b = *pos++;
+		return true;
+	}
+
+	bool getVarint(uint64_t &v)
+	{
+		v = 0;
+		for (unsigned shift = 0; shift < 64; shift += 7)
+		{
+			uint8_t b;
+			if (!getByte(b))
+			{
+				return false;
+			}
+			v |= uint64_t(b & 0x7F) << shift;
+			if (!(b & 0x80))
+			{
+				return true;
+			}
+		}
+		return ok = false;
+	}
+
+	bool getUint32(uint32_t &v)
+	{
+		if (end - pos < 4)
+		{
+			return ok = false;
+		}
+		v = uint32_t(pos[0]) << 24 | uint32_t(pos[1]) << 16 | uint32_t(pos[2]) << 8 | pos[3];
+		pos += 4;
+		return true;
+	}
+
+	std::string const *getString()
+	{
+		uint64_t index;
+		if (!getVarint(index) || index >= strings.size())
+		{
+			ok = false;
+			return nullptr;
+		}
+		return &strings[index];
+	}
+
+	bool getStringTable()
+	{
+		uint64_t count;
+		if (!getVarint(count) || count > uint64_t(end - pos))  // Each string takes at least a byte.
+		{
+			return ok = false;
+		}
+		strings.resize(count);
+		for (std::string &str : strings)
+		{
+			uint64_t length;
+			if (!getVarint(length) || length > uint64_t(end - pos))
+			{
+				return ok = false;
+			}
+			str.assign((const char *)pos, length);
+			pos += length;
+		}
+		return true;
+	}
+
+	void getValue(nlohmann::json &value, unsigned depth = 0)
+	{
+		uint8_t tag;
+		if (!getByte(tag))
+		{
+			return;
+		}
+		uint64_t v = 0;
+		switch (tag)
+		{
+		case BJ_NULL:
+			value = nullptr;
+			break;
+		case BJ_FALSE:
+			value = false;
+			break;
+		case BJ_TRUE:
+			value = true;
+			break;
+		case BJ_INTEGER:
+			if (getVarint(v))
+			{
+				value = int64_t(v >> 1) ^ -int64_t(v & 1);
+			}
+			break;
+		case BJ_UNSIGNED:
+			if (getVarint(v))
+			{
+				value = v;
+			}
+			break;
+		case BJ_FLOAT:
+			if (end - pos < 8)
+			{
+				ok = false;
+				break;
+			}
+			for (int i = 0; i < 8; ++i)
+			{
+				v = v << 8 | *pos++;
+			}
+			{
+				double d;
+				memcpy(&d, &v, sizeof(d));
+				value = d;
+			}
+			break;
+		case BJ_STRING:
+			if (std::string const *str = getString())
+			{
+				value = *str;
+			}
+			break;
+		case BJ_ARRAY:
+			if (depth >= BINARY_JSON_MAX_DEPTH || !getVarint(v) || v > uint64_t(end - pos))  // Each element takes at least a byte.
+			{
+				ok = false;
+				break;
+			}
+			value = nlohmann::json::array();
+			value.get_ref<nlohmann::json::array_t &>().resize(v);
+			for (auto &element : value)
+			{
+				getValue(element, depth + 1);
+				if (!ok)
+				{
+					break;
+				}
+			}
+			break;
+		case BJ_OBJECT:
+			if (depth >= BINARY_JSON_MAX_DEPTH || !getVarint(v) || v > uint64_t(end - pos))
+			{
+				ok = false;
+				break;
+			}
+			value = nlohmann::json::object();
+			for (uint64_t i = 0; i < v && ok; ++i)
+			{
+				std::string const *key = getString();
+				if (key != nullptr)
+				{
+					getValue(value[*key], depth + 1);
+				}
+			}
+			break;
+		default:
+			ok = false;
+			break;
+		}
+	}
+};
+}
+
+bool binaryJsonDecode(const char *data, size_t size, nlohmann::json &root)
+{
+	Decoder decoder;
+	decoder.pos = (const uint8_t *)data;
+	decoder.end = decoder.pos + size;
+	uint32_t version, tableSize, bodySize;
+	if (!binaryJsonDetect(data, size))
+	{
+		return false;
+	}
+	decoder.pos += 4;
+	if (!decoder.getUint32(version) || version > BINARY_JSON_VERSION)
+	{
+		debug(LOG_ERROR, "Unsupported binary JSON version");
+		return false;
+	}
+	if (!decoder.getUint32(tableSize) || tableSize > size_t(decoder.end - decoder.pos))
+	{
+		return false;
+	}
+	const uint8_t *tableEnd = decoder.pos + tableSize;
+	const uint8_t *end = decoder.end;
+	decoder.end = tableEnd;  // The string table must not run into the values.
+	if (!decoder.getStringTable())
+	{
+		return false;
+	}
+	decoder.pos = tableEnd;
+	decoder.end = end;
+	if (!decoder.getUint32(bodySize) || bodySize > size_t(decoder.end - decoder.pos))
+	{
+		return false;
+	}
+	decoder.end = decoder.pos + bodySize;
+	decoder.getValue(root);
+	return decoder.ok;
+}
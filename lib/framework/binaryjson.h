@@ -0,0 +1,40 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2005-2019  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/** @file
+ *  A compact binary form of the JSON documents written by WzConfig, used for savegames.
+ *
+ *  Keys and string values, such as stat names, are stored once in a string table and referred to
+ *  by index. WzConfig reads either form, telling them apart by the first bytes of the file.
+ */
+
+#ifndef __INCLUDED_LIB_FRAMEWORK_BINARYJSON_H__
+#define __INCLUDED_LIB_FRAMEWORK_BINARYJSON_H__
+
+#include "lib/framework/wzconfig.h"
+
+#include <string>
+
+/// Whether the data starts like binaryJsonEncode() output.
+bool binaryJsonDetect(const char *data, size_t size);
+/// Encodes the document, which may then be written as is.
+std::string binaryJsonEncode(const nlohmann::json &root);
+/// Decodes binaryJsonEncode() output. Returns false if the data is broken or from a newer version.
+bool binaryJsonDecode(const char *data, size_t size, nlohmann::json &root);
+
+#endif // __INCLUDED_LIB_FRAMEWORK_BINARYJSON_H__
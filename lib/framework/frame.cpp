@@ -33,6 +33,7 @@
 
 #include "frameresource.h"
 #include "input.h"
+#include "savewriter.h"
 
 /************************************************************************************
  *
@@ -123,6 +124,8 @@ void frameUpdate()
  */
 void frameShutDown()
 {
+	saveWriterWait();
+
 	// Shutdown the resource stuff
 	debug(LOG_NEVER, "No more resources!");
 	resShutDown();
@@ -268,6 +271,12 @@ bool saveFile(const char *pFileName, const char *pFileData, UDWORD fileSize)
 	PHYSFS_file *pfile;
 	PHYSFS_uint32 size = fileSize;
 
+	if (saveWriterCollecting())
+	{
+		saveWriterAddFile(pFileName, pFileData, fileSize);
+		return true;
+	}
+
 	debug(LOG_WZ, "We are to write (%s) of size %d", pFileName, fileSize);
 	pfile = openSaveFile(pFileName);
 	if (!pfile)
@@ -29,6 +29,16 @@
 
 #include "file.h"
 #include "resly.h"
+#include "wzapp.h"
+#include "math_ext.h"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+/// Upper limit of worker threads preparing the files of a .wrf.
+#define RES_MAX_PREPARE_THREADS 8
 
 // Local prototypes
 static RES_TYPE *psResTypes = nullptr;
@@ -40,9 +50,6 @@ char aCurrResDir[PATH_MAX];
 // the current resource block ID
 static SDWORD resBlockID;
 
-// prototypes
-static void ResetResourceFile();
-
 // callback to resload screen.
 static RESLOAD_CALLBACK resLoadCallback = nullptr;
 
@@ -150,8 +157,6 @@ bool resInitialise()
 	resBlockID = 0;
 	resLoadCallback = nullptr;
 
-	ResetResourceFile();
-
 	return true;
 }
 
@@ -179,11 +184,169 @@ void resSetBaseDir(const char *pResDir)
 	sstrcpy(aResDir, pResDir);
 }
 
+typedef std::chrono::steady_clock ResClock;
+
+static double resMilliseconds(ResClock::duration duration)
+{
+	return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+/// A file line of the .wrf being loaded. All lines are parsed before any is loaded, so that
+/// worker threads can read and prepare the files while the main thread loads them in order.
+struct RES_QUEUED
+{
+	RES_TYPE *psT = nullptr;
+	std::string file;                       ///< Name from the .wrf.
+	std::string fileName;                   ///< Full path handed to the load function.
+	WZ_SEMAPHORE *prepared = nullptr;       ///< Posted by the worker thread, NULL if there is nothing to prepare.
+	char *pBuffer = nullptr;                ///< File contents, for buffer load types.
+	UDWORD size = 0;
+	void *pPreparedData = nullptr;          ///< Result of the prepare function.
+	ResClock::duration prepareTime = ResClock::duration::zero();
+	ResClock::duration waitTime = ResClock::duration::zero();
+	ResClock::duration loadTime = ResClock::duration::zero();
+};
+
+static std::vector<RES_QUEUED> *resQueue = nullptr;  ///< Lines of the .wrf being parsed, NULL outside resLoad().
+static std::vector<RES_QUEUED> *resPrepareQueue = nullptr;
+static std::atomic<size_t> resPrepareNext;
+static void *resPreparedData = nullptr;  ///< For resTakePreparedData().
+
+static bool resLoadFileData(RES_TYPE *psT, const char *pFile, const char *aFileName, char *pBuffer, UDWORD size);
+
+static int resPrepareThreadFunc(void *)
+{
+	std::vector<RES_QUEUED> &queue = *resPrepareQueue;
+	for (size_t i = resPrepareNext++; i < queue.size(); i = resPrepareNext++)
+	{
+		RES_QUEUED &entry = queue[i];
+		if (entry.prepared == nullptr)
+		{
+			continue;
+		}
+
+		const ResClock::time_point start = ResClock::now();
+		if (entry.psT->buffLoad != nullptr && !loadFile(entry.fileName.c_str(), &entry.pBuffer, &entry.size))
+		{
+			entry.pBuffer = nullptr;  // The main thread tries again, and reports the error.
+		}
+		if (entry.psT->prepare != nullptr)
+		{
+			entry.pPreparedData = entry.psT->prepare(entry.fileName.c_str());
+		}
+		entry.prepareTime = ResClock::now() - start;
+
+		wzSemaphorePost(entry.prepared);
+	}
+	return 0;
+}
+
+static void resDiscardPreparedData(RES_TYPE *psT, void *pData)
+{
+	if (pData != nullptr && psT->discard != nullptr)
+	{
+		psT->discard(pData);
+	}
+}
+
+/// Loads the parsed lines of a .wrf in order, with file reads and prepare functions running ahead on worker threads.
+static bool resLoadQueued(std::vector<RES_QUEUED> &queue, const char *pResFile)
+{
+	const ResClock::time_point start = ResClock::now();
+
+	int numPrepare = 0;
+	for (RES_QUEUED &entry : queue)
+	{
+		if (entry.psT->buffLoad != nullptr || entry.psT->prepare != nullptr)
+		{
+			entry.prepared = wzSemaphoreCreate(0);
+			++numPrepare;
+		}
+	}
+
+	std::vector<WZ_THREAD *> threads;
+	const int numThreads = std::min(clip(wzGetCPUCount() - 1, 1, RES_MAX_PREPARE_THREADS), numPrepare);
+	resPrepareQueue = &queue;
+	resPrepareNext = 0;
+	for (int i = 0; i < numThreads; ++i)
+	{
+		WZ_THREAD *thread = wzThreadCreate(resPrepareThreadFunc, nullptr);
+		wzThreadStart(thread);
+		threads.push_back(thread);
+	}
+
+	bool retval = true;
+	size_t numLoaded = 0;
+	ResClock::duration waitTime = ResClock::duration::zero();
+	for (RES_QUEUED &entry : queue)
+	{
+		const ResClock::time_point waitStart = ResClock::now();
+		if (entry.prepared != nullptr)
+		{
+			wzSemaphoreWait(entry.prepared);
+		}
+		const ResClock::time_point loadStart = ResClock::now();
+		entry.waitTime = loadStart - waitStart;
+		waitTime += entry.waitTime;
+
+		resPreparedData = entry.pPreparedData;
+		entry.pPreparedData = nullptr;
+		bool success = resLoadFileData(entry.psT, entry.file.c_str(), entry.fileName.c_str(), entry.pBuffer, entry.size);
+		entry.pBuffer = nullptr;  // Freed by resLoadFileData().
+		resDiscardPreparedData(entry.psT, resTakePreparedData());
+		entry.loadTime = ResClock::now() - loadStart;
+		++numLoaded;
+
+		if (!success)
+		{
+			resPrepareNext = queue.size();  // Stop the worker threads early.
+			retval = false;
+			break;
+		}
+	}
+
+	for (WZ_THREAD *thread : threads)
+	{
+		wzThreadJoin(thread);
+	}
+	resPrepareQueue = nullptr;
+	for (RES_QUEUED &entry : queue)
+	{
+		// Only left over if a load failed.
+		free(entry.pBuffer);
+		resDiscardPreparedData(entry.psT, entry.pPreparedData);
+		if (entry.prepared != nullptr)
+		{
+			wzSemaphoreDestroy(entry.prepared);
+		}
+	}
+
+	debug(LOG_WZ, "resLoad: %s: %u files in %.1f ms, %.1f ms of it waiting on %d threads", pResFile,
+	      (unsigned)numLoaded, resMilliseconds(ResClock::now() - start), resMilliseconds(waitTime), numThreads);
+	for (size_t i = 0; i < numLoaded; ++i)
+	{
+		debug(LOG_WZ, "resLoad: %-10s %s: prepared in %.2f ms, waited %.2f ms, loaded in %.2f ms", queue[i].psT->aType, queue[i].file.c_str(),
+		      resMilliseconds(queue[i].prepareTime), resMilliseconds(queue[i].waitTime), resMilliseconds(queue[i].loadTime));
+	}
+
+	return retval;
+}
+
+void *resTakePreparedData()
+{
+	void *pData = resPreparedData;
+	resPreparedData = nullptr;
+	return pData;
+}
+
 /* Parse the res file */
 bool resLoad(const char *pResFile, SDWORD blockID)
 {
 	bool retval = true;
 	lexerinput_t input;
+	std::vector<RES_QUEUED> queue;
+
+	ASSERT_OR_RETURN(false, resQueue == nullptr, "resLoad(%s) called while parsing another .wrf", pResFile);
 
 	sstrcpy(aCurrResDir, aResDir);
 
@@ -203,15 +366,23 @@ bool resLoad(const char *pResFile, SDWORD blockID)
 
 	// and parse it
 	res_set_extra(&input);
+	resQueue = &queue;
 	if (res_parse() != 0)
 	{
 		debug(LOG_FATAL, "Failed to parse %s", pResFile);
 		retval = false;
 	}
+	resQueue = nullptr;
 
 	res_lex_destroy();
 	PHYSFS_close(input.input.physfsfile);
 
+	// Load whatever was parsed, even if the rest of the file was not
+	if (!resLoadQueued(queue, pResFile))
+	{
+		retval = false;
+	}
+
 	return retval;
 }
 
@@ -234,6 +405,8 @@ static RES_TYPE *resAlloc(const char *pType)
 	sstrcpy(psT->aType, pType);
 	psT->HashedType = HashString(psT->aType); // store a hased version for super speed !
 	psT->psRes = nullptr;
+	psT->prepare = nullptr;
+	psT->discard = nullptr;
 
 	return psT;
 }
@@ -270,6 +443,23 @@ bool resAddFileLoad(const char *pType, RES_FILELOAD fileLoad, RES_FREE release)
 	return true;
 }
 
+/* Add a prepare function for a file type */
+bool resAddPrepare(const char *pType, RES_PREPARE prepare, RES_FREE discard)
+{
+	for (RES_TYPE *psT = psResTypes; psT != nullptr; psT = psT->psNext)
+	{
+		if (strcmp(psT->aType, pType) == 0)
+		{
+			psT->prepare = prepare;
+			psT->discard = discard;
+			return true;
+		}
+	}
+
+	debug(LOG_ERROR, "resAddPrepare: Unknown type: %s", pType);
+	return false;
+}
+
 // Make a string lower case
 void resToLower(char *pStr)
 {
@@ -304,100 +494,6 @@ void SetLastResourceFilename(const char *pName)
 }
 
 
-// Structure for each file currently in use in the resource  ... probably only going to be one ... but we will handle upto MAXLOADEDRESOURCE
-struct RESOURCEFILE
-{
-	char *pBuffer;	// a pointer to the data
-	UDWORD size;	// number of bytes
-	UBYTE	type;	// what type of resource is it
-};
-
-#define RESFILETYPE_EMPTY (0)			// empty entry
-#define RESFILETYPE_LOADED (2)			// Loaded from a file (!)
-
-
-#define MAXLOADEDRESOURCES (6)
-static RESOURCEFILE LoadedResourceFiles[MAXLOADEDRESOURCES];
-
-
-
-// Clear out the resource list ... needs to be called during init.
-static void ResetResourceFile()
-{
-	UWORD i;
-
-	for (i = 0; i < MAXLOADEDRESOURCES; i++)
-	{
-		LoadedResourceFiles[i].type = RESFILETYPE_EMPTY;
-	}
-}
-
-// Returns an empty resource entry or -1 if none exsist
-static SDWORD FindEmptyResourceFile()
-{
-	UWORD i;
-	for (i = 0; i < MAXLOADEDRESOURCES ; i++)
-	{
-		if (LoadedResourceFiles[i].type == RESFILETYPE_EMPTY)
-		{
-			return (i);
-		}
-
-	}
-	return (-1);			// ERROR
-}
-
-
-// Get a resource data file ... either loads it or just returns a pointer
-static bool RetreiveResourceFile(char *ResourceName, RESOURCEFILE **NewResource)
-{
-	SDWORD ResID;
-	RESOURCEFILE *ResData;
-	UDWORD size;
-	char *pBuffer;
-
-	ResID = FindEmptyResourceFile();
-	if (ResID == -1)
-	{
-		return (false);    // all resource files are full
-	}
-
-	ResData = &LoadedResourceFiles[ResID];
-	*NewResource = ResData;
-
-	// This is needed for files that do not fit in the WDG cache ... (VAB file for example)
-	if (!loadFile(ResourceName, &pBuffer, &size))
-	{
-		return false;
-	}
-
-	ResData->type = RESFILETYPE_LOADED;
-	ResData->size = size;
-	ResData->pBuffer = pBuffer;
-	return (true);
-}
-
-
-// Free up the file depending on what type it is
-static void FreeResourceFile(RESOURCEFILE *OldResource)
-{
-	switch (OldResource->type)
-	{
-	case RESFILETYPE_LOADED:
-		free(OldResource->pBuffer);
-		OldResource->pBuffer = nullptr;
-		break;
-
-	default:
-		debug(LOG_WARNING, "resource not freed");
-	}
-
-
-	// Remove from the list
-	OldResource->type = RESFILETYPE_EMPTY;
-}
-
-
 static inline RES_DATA *resDataInit(const char *DebugName, UDWORD DataIDHash, void *pData, UDWORD BlockID)
 {
 	char *resID;
@@ -466,10 +562,8 @@ static void makeLocaleFile(char *fileName, size_t maxlen)  // given string must
 bool resLoadFile(const char *pType, const char *pFile)
 {
 	RES_TYPE	*psT = nullptr;
-	void		*pData = nullptr;
-	RES_DATA	*psRes = nullptr;
 	char		aFileName[PATH_MAX];
-	UDWORD HashedName, HashedType = HashString(pType);
+	UDWORD HashedType = HashString(pType);
 
 	// Find the resource-type
 	for (psT = psResTypes; psT != nullptr; psT = psT->psNext)
@@ -487,6 +581,41 @@ bool resLoadFile(const char *pType, const char *pFile)
 		return false;
 	}
 
+	// Create the file name
+	if (strlen(aCurrResDir) + strlen(pFile) + 1 >= PATH_MAX)
+	{
+		debug(LOG_ERROR, "resLoadFile: Filename too long!! %s%s", aCurrResDir, pFile);
+		return false;
+	}
+	sstrcpy(aFileName, aCurrResDir);
+	sstrcat(aFileName, pFile);
+
+	makeLocaleFile(aFileName, sizeof(aFileName));  // check for translated file
+
+	if (resQueue != nullptr)
+	{
+		// Parsing a .wrf, resLoad() loads it once the whole file is parsed
+		RES_QUEUED entry;
+		entry.psT = psT;
+		entry.file = pFile;
+		entry.fileName = aFileName;
+		resQueue->push_back(std::move(entry));
+		return true;
+	}
+
+	return resLoadFileData(psT, pFile, aFileName, nullptr, 0);
+}
+
+/*!
+ * Call the load function for a file, with its contents already read into pBuffer
+ * for buffer load types if pBuffer is not NULL. Frees pBuffer.
+ */
+static bool resLoadFileData(RES_TYPE *psT, const char *pFile, const char *aFileName, char *pBuffer, UDWORD size)
+{
+	void		*pData = nullptr;
+	RES_DATA	*psRes = nullptr;
+	UDWORD HashedName;
+
 	// Check for duplicates
 	HashedName = HashStringIgnoreCase(pFile);
 	for (psRes = psT->psRes; psRes; psRes = psRes->psNext)
@@ -498,40 +627,28 @@ bool resLoadFile(const char *pType, const char *pFile)
 			      pFile, HashedName, psT->aType);
 			// assume that they are actually both the same and silently fail
 			// lovely little hack to allow some files to be loaded from disk (believe it or not!).
+			free(pBuffer);
 			return true;
 		}
 	}
 
-	// Create the file name
-	if (strlen(aCurrResDir) + strlen(pFile) + 1 >= PATH_MAX)
-	{
-		debug(LOG_ERROR, "resLoadFile: Filename too long!! %s%s", aCurrResDir, pFile);
-		return false;
-	}
-	sstrcpy(aFileName, aCurrResDir);
-	sstrcat(aFileName, pFile);
-
-	makeLocaleFile(aFileName, sizeof(aFileName));  // check for translated file
-
 	SetLastResourceFilename(pFile); // Save the filename in case any routines need it
 
 	// load the resource
 	if (psT->buffLoad)
 	{
-		RESOURCEFILE *Resource;
-
-		// Load the file in a buffer
-		if (!RetreiveResourceFile(aFileName, &Resource))
+		// Load the file in a buffer, unless a worker thread already did
+		if (pBuffer == nullptr && !loadFile(aFileName, &pBuffer, &size))
 		{
 			debug(LOG_ERROR, "resLoadFile: Unable to retreive resource - %s", aFileName);
 			return false;
 		}
 
 		// Now process the buffer data
-		if (!psT->buffLoad(Resource->pBuffer, Resource->size, &pData))
+		if (!psT->buffLoad(pBuffer, size, &pData))
 		{
-			ASSERT(false, "The load function for resource type \"%s\" failed for file \"%s\"", pType, pFile);
-			FreeResourceFile(Resource);
+			ASSERT(false, "The load function for resource type \"%s\" failed for file \"%s\"", psT->aType, pFile);
+			free(pBuffer);
 			if (psT->release != nullptr)
 			{
 				psT->release(pData);
@@ -539,14 +656,14 @@ bool resLoadFile(const char *pType, const char *pFile)
 			return false;
 		}
 
-		FreeResourceFile(Resource);
+		free(pBuffer);
 	}
 	else if (psT->fileLoad)
 	{
 		// Process data directly from file
 		if (!psT->fileLoad(aFileName, &pData))
 		{
-			ASSERT(false, "The load function for resource type \"%s\" failed for file \"%s\"", pType, pFile);
+			ASSERT(false, "The load function for resource type \"%s\" failed for file \"%s\"", psT->aType, pFile);
 			if (psT->release != nullptr)
 			{
 				psT->release(pData);
@@ -39,6 +39,10 @@ typedef bool (*RES_FILELOAD)(const char *pFile, void **pData);
 /** Function pointer for releasing a resource loaded by the above functions. */
 typedef void (*RES_FREE)(void *pData);
 
+/** Function pointer for the part of a file load that can run on a worker thread, ahead of the load function.
+ *  It must not touch the GPU or any state shared with the main thread. */
+typedef void *(*RES_PREPARE)(const char *pFile);
+
 /** callback type for resload display callback. */
 typedef void (*RESLOAD_CALLBACK)();
 
@@ -72,6 +76,9 @@ struct RES_TYPE
 
 	RES_FILELOAD	fileLoad;		// This isn't really used any more ?
 	RES_TYPE       *psNext;
+
+	RES_PREPARE prepare;		// routine run on a worker thread while loading a .wrf (NULL indicates none)
+	RES_FREE discard;			// routine to free prepared data the load function did not take
 };
 
 
@@ -106,6 +113,12 @@ WZ_DECL_NONNULL(1) bool resAddBufferLoad(const char *pType, RES_BUFFERLOAD buffL
 /** Add a file name load and release function for a file type. */
 WZ_DECL_NONNULL(1) bool resAddFileLoad(const char *pType, RES_FILELOAD fileLoad, RES_FREE release);
 
+/** Add a prepare function for a file type, run ahead of the load function while loading a .wrf. */
+WZ_DECL_NONNULL(1, 2) bool resAddPrepare(const char *pType, RES_PREPARE prepare, RES_FREE discard);
+
+/** Take the data the prepare function produced for the file being loaded, or NULL if there is none. */
+void *resTakePreparedData();
+
 /** Call the load function for a file. */
 WZ_DECL_NONNULL(1, 2) bool resLoadFile(const char *pType, const char *pFile);
 
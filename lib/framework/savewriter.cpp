@@ -0,0 +1,147 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2005-2019  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/**
+ * @file savewriter.cpp
+ *
+ * Only one save is written at a time. The writer thread owns writerFiles while it runs, and the main
+ * thread only starts collecting again after joining it, so nothing here needs a lock.
+ */
+#include "frame.h"
+#include "file.h"
+#include "wzapp.h"
+#include "savewriter.h"
+#include "binaryjson.h"
+
+#include <sstream>
+#include <vector>
+
+struct SaveWriterFile
+{
+	std::string fileName;
+	std::vector<char> data;
+	nlohmann::json root;  ///< Formatted by the writer thread, if isJson.
+	bool isJson;
+	bool binary;          ///< Whether to use binaryJsonEncode() rather than JSON text.
+};
+
+static bool collecting = false;
+static bool collectingBinary = false;
+static std::vector<SaveWriterFile> collectedFiles;
+
+static WZ_THREAD *writerThread = nullptr;
+static std::vector<SaveWriterFile> writerFiles;
+static std::function<void (bool)> writerDone;
+static bool lastSaveOk = true;
+
+static int saveWriterThreadFunc(void *)
+{
+	bool ok = true;
+	for (SaveWriterFile &file : writerFiles)
+	{
+		if (file.isJson && file.binary)
+		{
+			std::string encoded = binaryJsonEncode(file.root);
+			ok = saveFile(file.fileName.c_str(), encoded.data(), encoded.size()) && ok;
+		}
+		else if (file.isJson)
+		{
+			std::ostringstream stream;
+			stream << file.root.dump(4) << std::endl;
+			std::string jsonString = stream.str();
+			ok = saveFile(file.fileName.c_str(), jsonString.c_str(), jsonString.size()) && ok;
+		}
+		else
+		{
+			ok = saveFile(file.fileName.c_str(), file.data.data(), file.data.size()) && ok;
+		}
+		debug(LOG_SAVE, "Wrote %s", file.fileName.c_str());
+	}
+	writerFiles.clear();
+	if (writerDone)
+	{
+		std::function<void (bool)> done = writerDone;
+		wzAsyncExecOnMainThread([done, ok] { done(ok); });
+	}
+	return ok;
+}
+
+bool saveWriterWait()
+{
+	if (writerThread != nullptr)
+	{
+		lastSaveOk = wzThreadJoin(writerThread) != 0;
+		writerThread = nullptr;
+		writerDone = nullptr;
+	}
+	return lastSaveOk;
+}
+
+void saveWriterBegin(bool binary)
+{
+	ASSERT(!collecting, "Already saving");
+	saveWriterWait();
+	lastSaveOk = true;
+	collectedFiles.clear();
+	collecting = true;
+	collectingBinary = binary;
+}
+
+void saveWriterEnd(const std::function<void (bool)> &done)
+{
+	ASSERT_OR_RETURN(, collecting, "Not saving");
+	collecting = false;
+	if (collectedFiles.empty())
+	{
+		if (done)
+		{
+			done(true);
+		}
+		return;
+	}
+	writerFiles = std::move(collectedFiles);
+	collectedFiles.clear();
+	writerDone = done;
+	writerThread = wzThreadCreate(saveWriterThreadFunc, nullptr);
+	wzThreadStart(writerThread);
+}
+
+bool saveWriterCollecting()
+{
+	return collecting;
+}
+
+void saveWriterAddFile(const char *fileName, const char *data, size_t size)
+{
+	SaveWriterFile file;
+	file.fileName = fileName;
+	file.data.assign(data, data + size);
+	file.isJson = false;
+	file.binary = false;
+	collectedFiles.push_back(std::move(file));
+}
+
+void saveWriterAddJson(const char *fileName, nlohmann::json &&root)
+{
+	SaveWriterFile file;
+	file.fileName = fileName;
+	file.root = std::move(root);
+	file.isJson = true;
+	file.binary = collectingBinary;
+	collectedFiles.push_back(std::move(file));
+}
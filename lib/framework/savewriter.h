@@ -0,0 +1,50 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2005-2019  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/** @file
+ *  Writes savegames in the background.
+ *
+ *  Between saveWriterBegin() and saveWriterEnd(), files saved with saveFile() or a ReadAndWrite
+ *  WzConfig are not written, but kept in memory. saveWriterEnd() then formats and writes them all
+ *  on a thread of their own, and saveWriterWait() tells whether every one of them was written.
+ */
+
+#ifndef __INCLUDED_LIB_FRAMEWORK_SAVEWRITER_H__
+#define __INCLUDED_LIB_FRAMEWORK_SAVEWRITER_H__
+
+#include "lib/framework/wzconfig.h"
+
+#include <functional>
+#include <string>
+
+/// Starts keeping files in memory instead of writing them. Waits for the previous save to be written first.
+/// If binary, the JSON files are written in the form of binaryJsonEncode(), else as JSON text.
+void saveWriterBegin(bool binary);
+/// Writes the files kept since saveWriterBegin() in the background, then calls done on the main thread, with whether all were written.
+void saveWriterEnd(const std::function<void (bool)> &done);
+/// Waits until all files have been written. Returns false if any could not be.
+bool saveWriterWait();
+
+/// True between saveWriterBegin() and saveWriterEnd().
+bool saveWriterCollecting();
+/// Keeps a copy of the data, to be written by saveWriterEnd().
+void saveWriterAddFile(const char *fileName, const char *data, size_t size);
+/// Keeps the JSON, to be formatted and written by saveWriterEnd().
+void saveWriterAddJson(const char *fileName, nlohmann::json &&root);
+
+#endif // __INCLUDED_LIB_FRAMEWORK_SAVEWRITER_H__
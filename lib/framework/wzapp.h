@@ -107,6 +107,9 @@ WZ_DECL_NONNULL(1) int wzThreadJoin(WZ_THREAD *thread);
 WZ_DECL_NONNULL(1) void wzThreadDetach(WZ_THREAD *thread);
 WZ_DECL_NONNULL(1) void wzThreadStart(WZ_THREAD *thread);
 void wzYieldCurrentThread();
+int wzGetCPUCount();	///< Number of logical CPU cores
+void wzSetHeadless(bool headless);	///< Run without a window, graphics or sound. Must be set before wzMainScreenSetup.
+bool wzIsHeadless();	///< Whether running without a window, graphics or sound
 WZ_MUTEX *wzMutexCreate();
 WZ_DECL_NONNULL(1) void wzMutexDestroy(WZ_MUTEX *mutex);
 WZ_DECL_NONNULL(1) void wzMutexLock(WZ_MUTEX *mutex);
@@ -26,13 +26,81 @@
 #include "wzconfig.h"
 #include <physfs.h>
 #include "file.h"
+#include "savewriter.h"
+#include "binaryjson.h"
+#include "wzapp.h"
 #include <sstream>
+#include <unordered_map>
+
+/// Documents parsed by wzConfigPrepare(), waiting for their WzConfig.
+static std::unordered_map<std::string, nlohmann::json> preparedDocuments;
+static wz::mutex preparedDocumentsMutex;
+
+bool wzConfigPrepare(const char *name)
+{
+	UDWORD size;
+	char *data;
+
+	if (!PHYSFS_exists(name) || !loadFile(name, &data, &size))
+	{
+		return false;
+	}
+	nlohmann::json root;
+	if (!binaryJsonDetect(data, size))
+	{
+		try {
+			root = nlohmann::json::parse(data, data + size);
+		}
+		catch (...) {
+			root = nullptr;
+		}
+	}
+	free(data);
+	if (!root.is_object())
+	{
+		return false;
+	}
+
+	std::lock_guard<wz::mutex> lock(preparedDocumentsMutex);
+	preparedDocuments[name] = std::move(root);
+	return true;
+}
+
+void wzConfigDiscardPrepared(const char *name)
+{
+	std::lock_guard<wz::mutex> lock(preparedDocumentsMutex);
+	preparedDocuments.erase(name);
+}
+
+static bool takePreparedDocument(const WzString &name, nlohmann::json &root)
+{
+	std::lock_guard<wz::mutex> lock(preparedDocumentsMutex);
+	if (preparedDocuments.empty())
+	{
+		return false;
+	}
+	auto it = preparedDocuments.find(name.toStdString());
+	if (it == preparedDocuments.end())
+	{
+		return false;
+	}
+	root = std::move(it->second);
+	preparedDocuments.erase(it);
+	return true;
+}
 
 WzConfig::~WzConfig()
 {
 	if (mWarning == ReadAndWrite)
 	{
 		ASSERT(mObjStack.empty(), "Some json groups have not been closed, stack size %lu.", mObjStack.size());
+		if (saveWriterCollecting())
+		{
+			// Formatting is left to the save writer thread, along with the writing.
+			saveWriterAddJson(mFilename.toUtf8().c_str(), std::move(mRoot));
+			debug(LOG_SAVE, "Saving %s in the background", mFilename.toUtf8().c_str());
+			return;
+		}
 		std::ostringstream stream;
 		stream << mRoot.dump(4) << std::endl;
 		std::string jsonString = stream.str();
@@ -74,40 +142,61 @@ WzConfig::WzConfig(const WzString &name, WzConfig::warning warning)
 	mWarning = warning;
 	pCurrentObj = &mRoot;
 
-	if (!PHYSFS_exists(name.toUtf8().c_str()))
+	if (warning != ReadAndWrite && takePreparedDocument(name, mRoot))
 	{
-		if (warning == ReadOnly)
+		data = nullptr;  // Already read and parsed by wzConfigPrepare().
+	}
+	else
+	{
+		if (!PHYSFS_exists(name.toUtf8().c_str()))
 		{
-			mStatus = false;
-			return;
+			if (warning == ReadOnly)
+			{
+				mStatus = false;
+				return;
+			}
+			else if (warning == ReadOnlyAndRequired)
+			{
+				debug(LOG_FATAL, "Missing required file %s", name.toUtf8().c_str());
+				abort();
+			}
+			else if (warning == ReadAndWrite)
+			{
+				return;
+			}
 		}
-		else if (warning == ReadOnlyAndRequired)
+		if (!loadFile(name.toUtf8().c_str(), &data, &size))
 		{
-			debug(LOG_FATAL, "Missing required file %s", name.toUtf8().c_str());
-			abort();
+			debug(LOG_FATAL, "Could not open \"%s\"", name.toUtf8().c_str());
 		}
-		else if (warning == ReadAndWrite)
+
+		if (binaryJsonDetect(data, size))
 		{
-			return;
+			// Savegames may be in the binary form instead.
+			if (!binaryJsonDecode(data, size, mRoot))
+			{
+				ASSERT(false, "Binary JSON document from %s is invalid", name.toUtf8().c_str());
+				mRoot = nlohmann::json::object();
+			}
+			free(data);
+			data = nullptr;
+		}
+		else
+		{
+			try {
+				mRoot = nlohmann::json::parse(data, data + size);
+			}
+			catch (const std::exception &e) {
+				ASSERT(false, "JSON document from %s is invalid: %s", name.toUtf8().c_str(), e.what());
+			}
+			catch (...) {
+				debug(LOG_FATAL, "Unexpected exception parsing JSON %s", name.toUtf8().c_str());
+			}
 		}
-	}
-	if (!loadFile(name.toUtf8().c_str(), &data, &size))
-	{
-		debug(LOG_FATAL, "Could not open \"%s\"", name.toUtf8().c_str());
-	}
-
-	try {
-		mRoot = nlohmann::json::parse(data, data + size);
-	}
-	catch (const std::exception &e) {
-		ASSERT(false, "JSON document from %s is invalid: %s", name.toUtf8().c_str(), e.what());
-	}
-	catch (...) {
-		debug(LOG_FATAL, "Unexpected exception parsing JSON %s", name.toUtf8().c_str());
 	}
 	pCurrentObj = &mRoot;
 	ASSERT(!mRoot.is_null(), "JSON document from %s is null", name.toUtf8().c_str());
-	ASSERT(mRoot.is_object(), "JSON document from %s is not an object. Read: \n%s", name.toUtf8().c_str(), data);
+	ASSERT(mRoot.is_object(), "JSON document from %s is not an object. Read: \n%s", name.toUtf8().c_str(), data ? data : "(binary)");
 	free(data);
 	char **diffList = PHYSFS_enumerateFiles("diffs");
 	for (char **i = diffList; *i != nullptr; i++)
@@ -175,6 +175,14 @@ inline void from_json(const json& j, WzString& p) {
 	p = WzString::fromUtf8(str.c_str());
 }
 
+/// Read and parse a JSON file ahead of time, from any thread. The next WzConfig opened read-only on
+/// the same file name takes the parsed document instead of loading it again. Returns false if the
+/// file could not be read or parsed, leaving it for WzConfig to report.
+bool wzConfigPrepare(const char *name);
+
+/// Drop a document from wzConfigPrepare() that was never opened.
+void wzConfigDiscardPrepared(const char *name);
+
 // Convenience methods to retrieve a json_variant from any json object
 json_variant json_getValue(const nlohmann::json& json, const WzString &key, const json_variant &defaultValue = json_variant());
 json_variant json_getValue(const nlohmann::json& json, nlohmann::json::size_type idx, const json_variant &defaultValue = json_variant());
@@ -52,6 +52,9 @@ static uint32_t prevRealTime;
   **/
 static UDWORD	stopCount;
 
+/// Ignore the wall clock, and tick as often as gameTimeUpdate() is allowed to.
+static bool fastForward = false;
+
 static uint32_t gameQueueTime[MAX_PLAYERS];
 static uint32_t gameQueueCheckTime[MAX_PLAYERS];
 static uint32_t gameQueueCheckCrc[MAX_PLAYERS];
@@ -173,6 +176,12 @@ void gameTimeUpdate(bool mayUpdate)
 	int newDeltaGraphicsTime = quantiseFraction(modifier.n, modifier.d, currTime, prevRealTime);
 	ASSERT(newDeltaGraphicsTime >= 0, "Something very wrong.");
 
+	if (fastForward && mayUpdate)
+	{
+		// Alternate between catching up graphicsTime and ticking.
+		newDeltaGraphicsTime = (graphicsTime < gameTime ? gameTime : gameTime + 1) - graphicsTime;
+	}
+
 	uint32_t newGraphicsTime = graphicsTime + newDeltaGraphicsTime;
 
 	if (newGraphicsTime > gameTime && !mayUpdate)
@@ -276,6 +285,12 @@ Rational gameTimeGetMod()
 	return modifier;
 }
 
+// tick as fast as possible
+void gameTimeSetFastForward(bool enable)
+{
+	fastForward = enable;
+}
+
 bool gameTimeIsStopped(void)
 {
 	return stopCount != 0;
@@ -99,6 +99,9 @@ void gameTimeSetMod(Rational mod);
 /** Get the current time modifier. */
 Rational gameTimeGetMod();
 
+/** Tick as fast as possible, instead of following the wall clock. Used for benchmarking. */
+void gameTimeSetFastForward(bool enable);
+
 /**
  * Returns the game time, modulo the time period, scaled to 0..requiredRange.
  * For instance getModularScaledGameTime(4096,256) will return a number that cycles through the values
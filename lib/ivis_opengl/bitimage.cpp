@@ -158,7 +158,14 @@ inline void ImageMerge::arrange()
 	}
 }
 
-IMAGEFILE *iV_LoadImageFile(const char *fileName)
+/// An image file with its sprites decoded and merged onto texture pages, not yet uploaded.
+struct IMAGEFILE_PREPARED
+{
+	IMAGEFILE *imageFile;
+	std::vector<iV_Image> pages;
+};
+
+IMAGEFILE_PREPARED *iV_PrepareImageFile(const char *fileName)
 {
 	// Find the directory of images.
 	std::string imageDir = fileName;
@@ -224,8 +231,6 @@ IMAGEFILE *iV_LoadImageFile(const char *fileName)
 		numImages++;
 		ptr += temp;
 		while (ptr < pFileData + pFileSize && *ptr++ != '\n') {} // skip rest of line
-
-		images.insert(std::make_pair(WzString::fromUtf8(tmpName), ImageDef));
 	}
 	free(pFileData);
 
@@ -234,7 +239,10 @@ IMAGEFILE *iV_LoadImageFile(const char *fileName)
 	pageLayout.arrange();  // Arrange all the images onto texture pages (attempt to do so with as few pages as possible).
 	imageFile->pages.resize(pageLayout.pages.size());
 
-	std::vector<iV_Image> ivImages(pageLayout.pages.size());
+	IMAGEFILE_PREPARED *prepared = new IMAGEFILE_PREPARED;
+	prepared->imageFile = imageFile;
+	std::vector<iV_Image> &ivImages = prepared->pages;
+	ivImages.resize(pageLayout.pages.size());
 
 	for (unsigned p = 0; p < pageLayout.pages.size(); ++p)
 	{
@@ -294,8 +302,26 @@ IMAGEFILE *iV_LoadImageFile(const char *fileName)
 		fclose(f);
 	}*/
 
+	return prepared;
+}
+
+IMAGEFILE *iV_FinishImageFile(IMAGEFILE_PREPARED *prepared, const char *fileName)
+{
+	if (prepared == nullptr)
+	{
+		return nullptr;
+	}
+	IMAGEFILE *imageFile = prepared->imageFile;
+	std::vector<iV_Image> &ivImages = prepared->pages;
+
+	// imageNames is sorted by name and then index, so the first of any duplicate names wins, as it did in file order.
+	for (auto const &name : imageFile->imageNames)
+	{
+		images.insert(std::make_pair(WzString::fromUtf8(name.first), &imageFile->imageDefs[name.second]));
+	}
+
 	// Upload texture pages and free image data.
-	for (unsigned p = 0; p < pageLayout.pages.size(); ++p)
+	for (unsigned p = 0; p < ivImages.size(); ++p)
 	{
 		char arbitraryName[256];
 		ssprintf(arbitraryName, "%s-%03u", fileName, p);
@@ -311,10 +337,26 @@ IMAGEFILE *iV_LoadImageFile(const char *fileName)
 	}
 
 	files.push_back(imageFile);
+	delete prepared;
 
 	return imageFile;
 }
 
+void iV_DiscardPreparedImageFile(IMAGEFILE_PREPARED *prepared)
+{
+	for (iV_Image &page : prepared->pages)
+	{
+		free(page.bmp);
+	}
+	delete prepared->imageFile;
+	delete prepared;
+}
+
+IMAGEFILE *iV_LoadImageFile(const char *fileName)
+{
+	return iV_FinishImageFile(iV_PrepareImageFile(fileName), fileName);
+}
+
 void iV_FreeImageFile(IMAGEFILE *imageFile)
 {
 	// so when we get here, it is time to redo everything. will clean this up later. TODO.
@@ -53,6 +53,12 @@ static inline WZ_DECL_PURE short iV_GetImageYOffset(const IMAGEFILE *ImageFile,
 
 ImageDef *iV_GetImage(const WzString &filename);
 IMAGEFILE *iV_LoadImageFile(const char *FileData);
+
+/// Image file loading split in two, so the first part can run on a worker thread.
+struct IMAGEFILE_PREPARED;
+IMAGEFILE_PREPARED *iV_PrepareImageFile(const char *fileName);  ///< Reads and decodes the sprites and lays out the texture pages, thread safe.
+IMAGEFILE *iV_FinishImageFile(IMAGEFILE_PREPARED *prepared, const char *fileName);  ///< Uploads the texture pages, main thread only.
+void iV_DiscardPreparedImageFile(IMAGEFILE_PREPARED *prepared);
 void iV_FreeImageFile(IMAGEFILE *ImageFile);
 
 #endif
@@ -18,7 +18,9 @@
 */
 
 #include "lib/framework/frame.h"
+#include "lib/framework/wzapp.h"
 #include "gfx_api_gl.h"
+#include "gfx_api_null.h"
 
 static GLenum to_gl(const gfx_api::pixel_format& format)
 {
@@ -176,6 +178,11 @@ gfx_api::buffer * gl_context::create_buffer_object(const gfx_api::buffer::usage
 
 gfx_api::context& gfx_api::context::get()
 {
+	if (wzIsHeadless())
+	{
+		static null_context nullCtx;
+		return nullCtx;
+	}
 	static gl_context ctx;
 	return ctx;
 }
@@ -0,0 +1,46 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2017-2019  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#pragma once
+
+#include "gfx_api.h"
+
+// A backend that accepts every call and does nothing, used when running headless.
+
+struct null_texture final : public gfx_api::texture
+{
+	virtual void bind() override;
+	virtual void upload(const size_t& mip_level, const size_t& offset_x, const size_t& offset_y, const size_t & width, const size_t & height, const gfx_api::pixel_format & buffer_format, const void * data, bool generate_mip_levels = false) override;
+	virtual unsigned id() override;
+};
+
+struct null_buffer final : public gfx_api::buffer
+{
+	size_t buffer_size = 0;
+
+	void bind() override;
+	virtual void upload(const size_t & size, const void * data) override;
+	virtual void update(const size_t & start, const size_t & size, const void * data) override;
+};
+
+struct null_context final : public gfx_api::context
+{
+	virtual gfx_api::texture* create_texture(const size_t & width, const size_t & height, const gfx_api::pixel_format & internal_format, const std::string& filename) override;
+	virtual gfx_api::buffer * create_buffer_object(const gfx_api::buffer::usage &usage, const buffer_storage_hint& hint = buffer_storage_hint::static_draw) override;
+};
@@ -25,6 +25,7 @@
 /***************************************************************************/
 
 #include "lib/framework/frame.h"
+#include "lib/framework/wzapp.h"
 #include "lib/framework/opengl.h"
 #include "lib/framework/fixedpoint.h"
 #include "lib/gamelib/gtime.h"
@@ -100,13 +101,17 @@ void GFX::makeTexture(int width, int height, GLenum filter, const gfx_api::pixel
 	mTexture = gfx_api::context::get().create_texture(width, height, format);
 	if (image != nullptr)
 		mTexture->upload(0u, 0u, 0u, width, height, format, image);
+	mWidth = width;
+	mHeight = height;
+	mFormat = format;
+	if (wzIsHeadless())
+	{
+		return;
+	}
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	mWidth = width;
-	mHeight = height;
-	mFormat = format;
 }
 
 void GFX::updateTexture(const void *image, int width, int height)
@@ -143,8 +148,12 @@ void GFX::buffers(int vertices, const GLvoid *vertBuf, const GLvoid *auxBuf)
 			mBuffers[VBO_TEXCOORD] = gfx_api::context::get().create_buffer_object(gfx_api::buffer::usage::vertex_buffer);
 		mBuffers[VBO_TEXCOORD]->upload(vertices * 4 * sizeof(GLbyte), auxBuf);
 	}
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	mSize = vertices;
+	if (wzIsHeadless())
+	{
+		return;
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 #define VERTEX_POS_ATTRIB_INDEX 0
@@ -153,6 +162,10 @@ void GFX::buffers(int vertices, const GLvoid *vertBuf, const GLvoid *auxBuf)
 
 void GFX::draw(const glm::mat4 &modelViewProjectionMatrix)
 {
+	if (wzIsHeadless())
+	{
+		return;
+	}
 	if (mType == GFX_TEXTURE)
 	{
 		pie_SetTexturePage(TEXPAGE_EXTERN);
@@ -655,10 +668,14 @@ bool pie_ShutdownRadar()
 void pie_SetRadar(gfx_api::gfxFloat x, gfx_api::gfxFloat y, gfx_api::gfxFloat width, gfx_api::gfxFloat height, int twidth, int theight)
 {
 	radarGfx->makeTexture(twidth, theight, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);  // Want GL_LINEAR (or GL_LINEAR_MIPMAP_NEAREST) for min filter, but GL_NEAREST for mag filter.
 	gfx_api::gfxFloat texcoords[] = { 0.0f, 0.0f,  1.0f, 0.0f,  0.0f, 1.0f,  1.0f, 1.0f };
 	gfx_api::gfxFloat vertices[] = { x, y,  x + width, y,  x, y + height,  x + width, y + height };
 	radarGfx->buffers(4, vertices, texcoords);
+	if (wzIsHeadless())
+	{
+		return;
+	}
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);  // Want GL_LINEAR (or GL_LINEAR_MIPMAP_NEAREST) for min filter, but GL_NEAREST for mag filter.
 }
 
 /** Store radar texture with given width and height. */
@@ -60,6 +60,8 @@ struct iIMDShape;
 bool pie_Draw3DShape(iIMDShape *shape, int frame, int team, PIELIGHT colour, int pieFlag, int pieFlagData, const glm::mat4 &modelView);
 
 void pie_GetResetCounts(unsigned int *pPieCount, unsigned int *pPolyCount);
+/** Model draw calls, and full shader/texture/buffer setups for them, since the last call. */
+void pie_GetResetDrawCounts(unsigned int *pDrawCalls, unsigned int *pStateChanges);
 
 /** Setup stencil shadows and OpenGL lighting. */
 void pie_BeginLighting(const Vector3f &light);
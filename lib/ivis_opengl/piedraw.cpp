@@ -41,6 +41,7 @@
 #include <string.h>
 #include <vector>
 #include <algorithm>
+#include <functional>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -63,6 +64,8 @@ static GLenum ss_op_depth_pass_back = GL_DECR;
 
 static unsigned int pieCount = 0;
 static unsigned int polyCount = 0;
+static unsigned int drawCallCount = 0;
+static unsigned int stateChangeCount = 0;  ///< Full shader, texture and buffer setups for a model draw.
 static bool shadows = false;
 static gfx_api::gfxFloat lighting0[LIGHT_MAX][4];
 
@@ -173,11 +176,14 @@ static void pie_Draw3DButton(iIMDShape *shape, PIELIGHT teamcolour, const glm::m
 	glDrawElements(GL_TRIANGLES, shape->polys.size() * 3, GL_UNSIGNED_SHORT, nullptr);
 	disableArrays();
 	polyCount += shape->polys.size();
+	++drawCallCount;
+	++stateChangeCount;
 	pie_DeactivateShader();
 	pie_SetDepthBufferStatus(DEPTH_CMP_ALWAYS_WRT_ON);
 }
 
-static void pie_Draw3DShape2(const iIMDShape *shape, int frame, PIELIGHT colour, PIELIGHT teamcolour, int pieFlag, int pieFlagData, glm::mat4 const &matrix)
+/// Sets up the shader, texture and buffers for drawing shape, followed by pie_Draw3DShapeElements() and pie_Draw3DShapeEnd().
+static pie_internal::SHADER_PROGRAM &pie_Draw3DShapeBegin(const iIMDShape *shape, PIELIGHT colour, PIELIGHT teamcolour, int pieFlag, int pieFlagData, glm::mat4 const &matrix)
 {
 	bool light = true;
 
@@ -235,16 +241,28 @@ static void pie_Draw3DShape2(const iIMDShape *shape, int frame, PIELIGHT colour,
 
 	pie_SetTexturePage(shape->texpage);
 
-	frame %= std::max<int>(1, shape->numFrames);
-
 	enableArray(shape->buffers[VBO_VERTEX], program.locVertex, 3, GL_FLOAT, false, 0, 0);
 	enableArray(shape->buffers[VBO_NORMAL], program.locNormal, 3, GL_FLOAT, false, 0, 0);
 	enableArray(shape->buffers[VBO_TEXCOORD], program.locTexCoord, 2, GL_FLOAT, false, 0, 0);
 	shape->buffers[VBO_INDEX]->bind();
+
+	++stateChangeCount;
+	return program;
+}
+
+static void pie_Draw3DShapeElements(const iIMDShape *shape, int frame)
+{
+	frame %= std::max<int>(1, shape->numFrames);
+
 	glDrawElements(GL_TRIANGLES, shape->polys.size() * 3, GL_UNSIGNED_SHORT, BUFFER_OFFSET(frame * shape->polys.size() * 3 * sizeof(uint16_t)));
-	disableArrays();
 
 	polyCount += shape->polys.size();
+	++drawCallCount;
+}
+
+static void pie_Draw3DShapeEnd()
+{
+	disableArrays();
 
 	pie_SetShaderEcmEffect(false);
 	// NOTE: Do *not* call pie_DeactivateShader() here, to avoid unecessary state transitions.
@@ -252,6 +270,53 @@ static void pie_Draw3DShape2(const iIMDShape *shape, int frame, PIELIGHT colour,
 	// (activateShader handles changing the active shader *if necessary*.)
 }
 
+static void pie_Draw3DShape2(const iIMDShape *shape, int frame, PIELIGHT colour, PIELIGHT teamcolour, int pieFlag, int pieFlagData, glm::mat4 const &matrix)
+{
+	pie_Draw3DShapeBegin(shape, colour, teamcolour, pieFlag, pieFlagData, matrix);
+	pie_Draw3DShapeElements(shape, frame);
+	pie_Draw3DShapeEnd();
+}
+
+/// Order of opaque shapes, grouping the same shader, texture page, shape and frame together.
+static bool shapeDrawOrder(SHAPE const &a, SHAPE const &b)
+{
+	// ECM shapes are alpha blended, so keep them after the others.
+	const bool aEcm = (a.flag & pie_ECM) != 0, bEcm = (b.flag & pie_ECM) != 0;
+	if (aEcm != bEcm)
+	{
+		return bEcm;
+	}
+	if (a.shape->shaderProgram != b.shape->shaderProgram)
+	{
+		return a.shape->shaderProgram < b.shape->shaderProgram;
+	}
+	if (a.shape->texpage != b.shape->texpage)
+	{
+		return a.shape->texpage < b.shape->texpage;
+	}
+	if (a.shape != b.shape)
+	{
+		return std::less<const iIMDShape *>()(a.shape, b.shape);
+	}
+	return a.frame < b.frame;
+}
+
+/// Draws the opaque shapes [first, last), which share shape, frame and ECM flag, setting up the state once
+/// and changing only the per-instance uniforms between draws.
+static void pie_Draw3DShapeInstances(SHAPE const *first, SHAPE const *last)
+{
+	pie_SetShaderStretchDepth(first->stretch);
+	pie_internal::SHADER_PROGRAM &program = pie_Draw3DShapeBegin(first->shape, first->colour, first->teamcolour, first->flag, first->flag_data, first->matrix);
+	pie_Draw3DShapeElements(first->shape, first->frame);
+	for (SHAPE const *instance = first + 1; instance != last; ++instance)
+	{
+		pie_SetShaderStretchDepth(instance->stretch);
+		pie_SetShaderInstance(program, instance->teamcolour, instance->colour, instance->matrix, pie_PerspectiveGet());
+		pie_Draw3DShapeElements(instance->shape, instance->frame);
+	}
+	pie_Draw3DShapeEnd();
+}
+
 static inline bool edgeLessThan(EDGE const &e1, EDGE const &e2)
 {
 	if (e1.from != e2.from)
@@ -743,13 +808,14 @@ static void pie_DrawShadows(uint64_t currentGameFrame)
 
 void pie_RemainingPasses(uint64_t currentGameFrame)
 {
-	// Draw models
-	// TODO, sort list to reduce state changes
+	// Draw models, sorted to reduce state changes
 	GL_DEBUG("Remaining passes - opaque models");
-	for (SHAPE const &shape : shapes)
+	std::stable_sort(shapes.begin(), shapes.end(), shapeDrawOrder);
+	for (size_t first = 0, last; first < shapes.size(); first = last)
 	{
-		pie_SetShaderStretchDepth(shape.stretch);
-		pie_Draw3DShape2(shape.shape, shape.frame, shape.colour, shape.teamcolour, shape.flag, shape.flag_data, shape.matrix);
+		for (last = first + 1; last < shapes.size() && shapes[last].shape == shapes[first].shape && shapes[last].frame == shapes[first].frame
+		     && (shapes[last].flag & pie_ECM) == (shapes[first].flag & pie_ECM); ++last) {}
+		pie_Draw3DShapeInstances(&shapes[first], &shapes[0] + last);
 	}
 	GL_DEBUG("Remaining passes - shadows");
 	// Draw shadows
@@ -781,6 +847,15 @@ void pie_GetResetCounts(unsigned int *pPieCount, unsigned int *pPolyCount)
 	polyCount = 0;
 }
 
+void pie_GetResetDrawCounts(unsigned int *pDrawCalls, unsigned int *pStateChanges)
+{
+	*pDrawCalls = drawCallCount;
+	*pStateChanges = stateChangeCount;
+
+	drawCallCount = 0;
+	stateChangeCount = 0;
+}
+
 // GL 2.0 1-pass version
 static void ss_GL2_1pass()
 {
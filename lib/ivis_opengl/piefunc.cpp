@@ -22,6 +22,7 @@
  */
 
 #include "lib/framework/frame.h"
+#include "lib/framework/wzapp.h"
 #include "lib/framework/opengl.h"
 
 #include "lib/gamelib/gtime.h"
@@ -195,6 +196,10 @@ void pie_Skybox_Init()
 void pie_Skybox_Texture(const char *filename)
 {
 	skyboxGfx->loadTexture(filename);
+	if (wzIsHeadless())
+	{
+		return;
+	}
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
 }
 
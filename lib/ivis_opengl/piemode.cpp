@@ -94,6 +94,11 @@ void pie_ScreenFlip(int clearMode)
 {
 	GLbitfield clearFlags = 0;
 
+	if (wzIsHeadless())
+	{
+		return;
+	}
+
 	screenDoDumpToDiskIfRequired();
 	wzScreenFlip();
 	wzPerfFrame();
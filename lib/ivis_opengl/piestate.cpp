@@ -22,6 +22,7 @@
  */
 #include "lib/framework/frame.h"
 #include "lib/framework/opengl.h"
+#include "lib/framework/wzapp.h"
 
 #include <physfs.h>
 #include "lib/framework/physfs_ext.h"
@@ -885,8 +886,25 @@ pie_internal::SHADER_PROGRAM &pie_ActivateShaderDeprecated(SHADER_MODE shaderMod
 	return program;
 }
 
+void pie_SetShaderInstance(pie_internal::SHADER_PROGRAM &program, PIELIGHT teamcolour, PIELIGHT colour, const glm::mat4 &ModelView, const glm::mat4 &Proj)
+{
+	glUniform4fv(program.locations[0], 1, &pal_PIELIGHTtoVec4(colour)[0]);
+	glUniform4fv(program.locations[1], 1, &pal_PIELIGHTtoVec4(teamcolour)[0]);
+	glUniformMatrix4fv(program.locations[10], 1, GL_FALSE, glm::value_ptr(ModelView));
+	glUniformMatrix4fv(program.locations[11], 1, GL_FALSE, glm::value_ptr(Proj * ModelView));
+	glUniformMatrix4fv(program.locations[12], 1, GL_FALSE, glm::value_ptr(glm::transpose(glm::inverse(ModelView))));
+	if (program.locations[2] >= 0)
+	{
+		glUniform1f(program.locations[2], shaderStretch);
+	}
+}
+
 void pie_SetDepthBufferStatus(DEPTH_MODE depthMode)
 {
+	if (wzIsHeadless())
+	{
+		return;
+	}
 	switch (depthMode)
 	{
 	case DEPTH_CMP_LEQ_WRT_ON:
@@ -911,6 +929,10 @@ void pie_SetDepthBufferStatus(DEPTH_MODE depthMode)
 /// Negative values are closer to the screen
 void pie_SetDepthOffset(float offset)
 {
+	if (wzIsHeadless())
+	{
+		return;
+	}
 	if (offset == 0.0f)
 	{
 		glDisable(GL_POLYGON_OFFSET_FILL);
@@ -948,6 +970,10 @@ void pie_SetFogStatus(bool val)
  */
 void pie_SetTexturePage(SDWORD num)
 {
+	if (wzIsHeadless())
+	{
+		return;
+	}
 	// Only bind textures when they're not bound already
 	if (num != rendStates.texPage)
 	{
@@ -967,6 +993,10 @@ void pie_SetTexturePage(SDWORD num)
 
 void pie_SetRendMode(REND_MODE rendMode)
 {
+	if (wzIsHeadless())
+	{
+		return;
+	}
 	if (rendMode != rendStates.rendMode)
 	{
 		rendStates.rendMode = rendMode;
@@ -150,6 +150,15 @@ bool screenInitialise()
 	GLint glMaxTUs;
 	GLenum err;
 
+	if (wzIsHeadless())
+	{
+		// No OpenGL context to query, only set up the objects the rest of the code expects to exist
+		debug(LOG_3D, "Running headless, skipping OpenGL initialisation");
+		pie_Skybox_Init();
+		backdropGfx = new GFX(GFX_TEXTURE, GL_TRIANGLE_STRIP, 2);
+		return true;
+	}
+
 #if defined(WZ_USE_OPENGL_3_2_CORE_PROFILE)
 	const char * _glewMajorVersionString = (const char*)glewGetString(GLEW_VERSION_MAJOR);
 	const char * _glewMinorVersionString = (const char*)glewGetString(GLEW_VERSION_MINOR);
@@ -504,6 +513,10 @@ void screenShutDown()
 
 	delete backdropGfx;
 
+	if (wzIsHeadless())
+	{
+		return;
+	}
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 }
 
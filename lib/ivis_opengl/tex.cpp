@@ -19,6 +19,7 @@
 */
 
 #include "lib/framework/frame.h"
+#include "lib/framework/wzapp.h"
 
 #include "lib/ivis_opengl/ivisdef.h"
 #include "lib/ivis_opengl/piestate.h"
@@ -99,6 +100,15 @@ int pie_AddTexPage(iV_Image *s, const char *filename, bool gameTexture, int page
 	}
 	debug(LOG_TEXTURE, "%s page=%d", filename, page);
 
+	if (wzIsHeadless())
+	{
+		// Nothing is ever drawn, so keep the page slot but skip the upload
+		pie_AssignTexture(page, gfx_api::context::get().create_texture(s->width, s->height, gfx_api::pixel_format::rgba, filename));
+		free(s->bmp);
+		s->bmp = nullptr;
+		return page;
+	}
+
 	if (gameTexture) // this is a game texture, use texture compression
 	{
 		gfx_api::pixel_format format{};
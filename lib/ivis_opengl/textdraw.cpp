@@ -19,6 +19,7 @@
 */
 
 #include "lib/framework/frame.h"
+#include "lib/framework/wzapp.h"
 #include "lib/framework/file.h"
 #include "lib/framework/opengl.h"
 #include <stdlib.h>
@@ -914,6 +915,11 @@ void WzText::drawAndCacheText(const std::string &string, iV_fonts fontID)
 		texture = nullptr;
 	}
 
+	if (wzIsHeadless())
+	{
+		return;
+	}
+
 	if (dimensions.x > 0 && dimensions.y > 0)
 	{
 		pie_SetTexturePage(TEXPAGE_EXTERN);
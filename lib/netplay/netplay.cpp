@@ -45,6 +45,7 @@
 #include "netplay.h"
 #include "netlog.h"
 #include "netsocket.h"
+#include "netreplay.h"
 
 #include <miniupnpc/miniwget.h>
 #include <miniupnpc/miniupnpc.h>
@@ -1922,12 +1923,25 @@ bool NETrecvGame(NETQUEUE *queue, uint8_t *type)
 		*queue = NETgameQueue(current);
 		while (!checkPlayerGameTime(current))  // Check for any messages that are scheduled to be read now.
 		{
+			if (NETisReplay())
+			{
+				// Read the replay until it has the next message for this player.
+				NetMessage message;
+				uint8_t player;
+				while (!NETisMessageReady(*queue) && NETreplayLoadNetMessage(message, player))
+				{
+					NETinsertMessageFromNet(NETgameQueue(player), &message);
+				}
+			}
+
 			if (!NETisMessageReady(*queue))
 			{
 				return false;  // Still waiting for messages from this player, and all players should process messages in the same order. Will have to freeze the game while waiting.
 			}
 
-			*type = NETgetMessage(*queue)->type;
+			NetMessage const *message = NETgetMessage(*queue);
+			*type = message->type;
+			NETreplaySaveNetMessage(*message, current);
 
 			if (*type == GAME_GAME_TIME)
 			{
@@ -3191,20 +3205,163 @@ struct SyncDebugEntry
 	char const *function;
 };
 
-struct SyncDebugString : public SyncDebugEntry
+#define SYNC_DEBUG_MAX_ARGS 40
+
+/// How a syncDebug() argument is read from the va_list, given by the length modifier and conversion of its format specification.
+enum SyncDebugArgType
+{
+	SDA_NONE,        ///< "%%", or an unknown conversion. No argument.
+	SDA_COUNT,       ///< "%n". Its argument is skipped, and nothing is stored.
+	SDA_INT,
+	SDA_UINT,
+	SDA_LONG,
+	SDA_ULONG,
+	SDA_LONGLONG,
+	SDA_ULONGLONG,
+	SDA_SIZE,
+	SDA_INTMAX,
+	SDA_UINTMAX,
+	SDA_PTRDIFF,
+	SDA_DOUBLE,
+	SDA_LONGDOUBLE,  ///< Stored and printed as a double.
+	SDA_STRING,      ///< Stored as an offset into SyncDebugLog::chars.
+	SDA_POINTER,
+};
+
+/// Parses the format specification starting at the '%' at spec. Returns a pointer to just after it.
+static char const *syncDebugParseSpec(char const *spec, unsigned &numStars, SyncDebugArgType &type)
 {
-	void set(uint32_t &crc, char const *f, char const *string)
+	char const *c = spec + 1;
+	numStars = 0;
+	while (*c != '\0' && strchr("-+ #0123456789.*'", *c) != nullptr)  // Flags, width and precision.
 	{
-		function = f;
-		crc = crcSum(crc, function, strlen(function) + 1);
-		crc = crcSum(crc, string,   strlen(string) + 1);
+		numStars += *c == '*';
+		++c;
 	}
-	int snprint(char *buf, size_t bufSize, char const *&string) const
+
+	enum {LEN_NONE, LEN_LONG, LEN_LONGLONG, LEN_SIZE, LEN_INTMAX, LEN_PTRDIFF, LEN_LONGDOUBLE} length = LEN_NONE;
+	switch (*c)
 	{
-		int ret = snprintf(buf, bufSize, "[%s] %s\n", function, string);
-		string += strlen(string) + 1;
-		return ret;
+	case 'h': c += c[1] == 'h' ? 2 : 1; break;  // Promoted to int anyway.
+	case 'l': length = c[1] == 'l' ? LEN_LONGLONG : LEN_LONG; c += c[1] == 'l' ? 2 : 1; break;
+	case 'q': length = LEN_LONGLONG; ++c; break;
+	case 'z': length = LEN_SIZE; ++c; break;
+	case 'j': length = LEN_INTMAX; ++c; break;
+	case 't': length = LEN_PTRDIFF; ++c; break;
+	case 'L': length = LEN_LONGDOUBLE; ++c; break;
+	case 'I':  // MSVC and MinGW, as in PRId64.
+		if (c[1] == '6' && c[2] == '4') { length = LEN_LONGLONG; c += 3; }
+		else if (c[1] == '3' && c[2] == '2') { c += 3; }
+		else { length = LEN_SIZE; ++c; }
+		break;
+	default: break;
 	}
+
+	bool isSigned = true;
+	switch (*c)
+	{
+	case 'u': case 'o': case 'x': case 'X':
+		isSigned = false;
+		// Fall through.
+	case 'd': case 'i':
+		switch (length)
+		{
+		case LEN_LONG:     type = isSigned ? SDA_LONG : SDA_ULONG; break;
+		case LEN_LONGLONG: type = isSigned ? SDA_LONGLONG : SDA_ULONGLONG; break;
+		case LEN_SIZE:     type = SDA_SIZE; break;
+		case LEN_INTMAX:   type = isSigned ? SDA_INTMAX : SDA_UINTMAX; break;
+		case LEN_PTRDIFF:  type = SDA_PTRDIFF; break;
+		default:           type = isSigned ? SDA_INT : SDA_UINT; break;
+		}
+		break;
+	case 'c':
+		type = SDA_INT;
+		break;
+	case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+		type = length == LEN_LONGDOUBLE ? SDA_LONGDOUBLE : SDA_DOUBLE;
+		break;
+	case 's': type = SDA_STRING; break;
+	case 'p': type = SDA_POINTER; break;
+	case 'n': type = SDA_COUNT; break;
+	default:  type = SDA_NONE; break;
+	}
+	return *c != '\0' ? c + 1 : c;
+}
+
+/// A syncDebug() call, stored as its format string and raw arguments, and only formatted if the log is dumped.
+struct SyncDebugFormat : public SyncDebugEntry
+{
+	int snprint(char *buf, size_t bufSize, uint64_t const *&args, char const *chars) const
+	{
+		uint64_t const *argsEnd = args + numArgs;
+		size_t index = snprintf(buf, bufSize, "[%s] ", function);
+		char const *c = format;
+		while (*c != '\0' && index < bufSize)
+		{
+			char const *spec = strchr(c, '%');
+			unsigned numStars;
+			SyncDebugArgType type;
+			char const *specEnd = spec != nullptr ? syncDebugParseSpec(spec, numStars, type) : nullptr;
+			unsigned argsNeeded = spec == nullptr ? 0 : numStars + (type != SDA_NONE && type != SDA_COUNT);
+			if (spec == nullptr || argsNeeded > unsigned(argsEnd - args))
+			{
+				index += snprintf(buf + index, bufSize - index, "%s", c);  // Rest of the format, or arguments beyond SYNC_DEBUG_MAX_ARGS.
+				break;
+			}
+			index += snprintf(buf + index, bufSize - index, "%.*s", int(spec - c), c);
+			c = specEnd;
+			if (index >= bufSize || type == SDA_COUNT)
+			{
+				continue;
+			}
+
+			// Copy the specification, with any '*' replaced by the stored width or precision.
+			char specBuf[64];
+			size_t specLen = 0;
+			for (char const *s = spec; s != specEnd && specLen + 12 < sizeof(specBuf); ++s)
+			{
+				if (*s == '*')
+				{
+					specLen += snprintf(specBuf + specLen, sizeof(specBuf) - specLen, "%d", int(*args++));
+				}
+				else if (*s != 'L' || type != SDA_LONGDOUBLE)
+				{
+					specBuf[specLen++] = *s;
+				}
+			}
+			specBuf[specLen] = '\0';
+
+			double d;
+			switch (type)
+			{
+			case SDA_NONE:       index += snprintf(buf + index, bufSize - index, "%s", c[-1] == '%' ? "%" : specBuf); break;
+			case SDA_COUNT:      break;
+			case SDA_INT:        index += snprintf(buf + index, bufSize - index, specBuf, int(*args++)); break;
+			case SDA_UINT:       index += snprintf(buf + index, bufSize - index, specBuf, unsigned(*args++)); break;
+			case SDA_LONG:       index += snprintf(buf + index, bufSize - index, specBuf, long(*args++)); break;
+			case SDA_ULONG:      index += snprintf(buf + index, bufSize - index, specBuf, (unsigned long)*args++); break;
+			case SDA_LONGLONG:   index += snprintf(buf + index, bufSize - index, specBuf, (long long)*args++); break;
+			case SDA_ULONGLONG:  index += snprintf(buf + index, bufSize - index, specBuf, (unsigned long long)*args++); break;
+			case SDA_SIZE:       index += snprintf(buf + index, bufSize - index, specBuf, size_t(*args++)); break;
+			case SDA_INTMAX:     index += snprintf(buf + index, bufSize - index, specBuf, intmax_t(*args++)); break;
+			case SDA_UINTMAX:    index += snprintf(buf + index, bufSize - index, specBuf, uintmax_t(*args++)); break;
+			case SDA_PTRDIFF:    index += snprintf(buf + index, bufSize - index, specBuf, ptrdiff_t(*args++)); break;
+			case SDA_DOUBLE:
+			case SDA_LONGDOUBLE: memcpy(&d, args++, sizeof(d)); index += snprintf(buf + index, bufSize - index, specBuf, d); break;
+			case SDA_STRING:     index += snprintf(buf + index, bufSize - index, specBuf, chars + *args++); break;
+			case SDA_POINTER:    index += snprintf(buf + index, bufSize - index, specBuf, (void *)uintptr_t(*args++)); break;
+			}
+		}
+		if (index < bufSize)
+		{
+			index += snprintf(buf + index, bufSize - index, "\n");
+		}
+		args = argsEnd;
+		return index;
+	}
+
+	char const *format;  ///< Must outlive the log, so should be a string literal.
+	unsigned numArgs;
 };
 
 struct SyncDebugValueChange : public SyncDebugEntry
@@ -3323,24 +3480,83 @@ struct SyncDebugLog
 		log.clear();
 		time = 0;
 		crc = 0x00000000;
-		//printf("Freeing %d strings, %d valueChanges, %d intLists, %d chars, %d ints\n", (int)strings.size(), (int)valueChanges.size(), (int)intLists.size(), (int)chars.size(), (int)ints.size());
-		strings.clear();
+		//printf("Freeing %d formats, %d valueChanges, %d intLists, %d args, %d chars, %d ints\n", (int)formats.size(), (int)valueChanges.size(), (int)intLists.size(), (int)args.size(), (int)chars.size(), (int)ints.size());
+		formats.clear();
 		valueChanges.clear();
 		intLists.clear();
+		args.clear();
 		chars.clear();
 		ints.clear();
 	}
-	void string(char const *f, char const *s)
+	/// Stores the arguments without formatting them. The CRC is of the function, format and raw argument values.
+	void format(char const *f, char const *fmt, va_list ap)
 	{
-		size_t offset = chars.size();
-		chars.resize(chars.size() + strlen(s) + 1);
-		char *buf = &chars[offset];
-		strcpy(buf, s);
+		formats.resize(formats.size() + 1);
+		SyncDebugFormat &entry = formats.back();
+		entry.function = f;
+		entry.format = fmt;
+		entry.numArgs = 0;
 
-		strings.resize(strings.size() + 1);
-		strings.back().set(crc, f, buf);
+		crc = crcSum(crc, f,   strlen(f) + 1);
+		crc = crcSum(crc, fmt, strlen(fmt) + 1);
 
-		log.push_back('s');
+		uint32_t valueBytes[2 * SYNC_DEBUG_MAX_ARGS];
+		unsigned numValueBytes = 0;
+		for (char const *c = strchr(fmt, '%'); c != nullptr; c = strchr(c, '%'))
+		{
+			unsigned numStars;
+			SyncDebugArgType type;
+			c = syncDebugParseSpec(c, numStars, type);
+			if (entry.numArgs + numStars + 1 > SYNC_DEBUG_MAX_ARGS)
+			{
+				break;
+			}
+			for (unsigned n = 0; n < numStars; ++n)
+			{
+				args.push_back(uint64_t(int64_t(va_arg(ap, int))));
+				++entry.numArgs;
+			}
+
+			uint64_t value;
+			double d;
+			switch (type)
+			{
+			case SDA_NONE:       continue;
+			case SDA_COUNT:      (void)va_arg(ap, int *); continue;
+			case SDA_INT:        value = int64_t(va_arg(ap, int)); break;
+			case SDA_UINT:       value = va_arg(ap, unsigned); break;
+			case SDA_LONG:       value = int64_t(va_arg(ap, long)); break;
+			case SDA_ULONG:      value = va_arg(ap, unsigned long); break;
+			case SDA_LONGLONG:   value = int64_t(va_arg(ap, long long)); break;
+			case SDA_ULONGLONG:  value = va_arg(ap, unsigned long long); break;
+			case SDA_SIZE:       value = va_arg(ap, size_t); break;
+			case SDA_INTMAX:     value = int64_t(va_arg(ap, intmax_t)); break;
+			case SDA_UINTMAX:    value = va_arg(ap, uintmax_t); break;
+			case SDA_PTRDIFF:    value = int64_t(va_arg(ap, ptrdiff_t)); break;
+			case SDA_DOUBLE:     d = va_arg(ap, double); memcpy(&value, &d, sizeof(d)); break;
+			case SDA_LONGDOUBLE: d = double(va_arg(ap, long double)); memcpy(&value, &d, sizeof(d)); break;
+			case SDA_POINTER:    value = uintptr_t(va_arg(ap, void *)); break;
+			case SDA_STRING:
+				{
+					char const *string = va_arg(ap, char const *);
+					string = string != nullptr ? string : "(null)";
+					size_t length = strlen(string) + 1;
+					value = chars.size();
+					chars.insert(chars.end(), string, string + length);
+					crc = crcSum(crc, string, length);
+					args.push_back(value);
+					++entry.numArgs;
+				}
+				continue;
+			}
+			args.push_back(value);
+			++entry.numArgs;
+			valueBytes[numValueBytes++] = htonl(uint32_t(value >> 32));
+			valueBytes[numValueBytes++] = htonl(uint32_t(value));
+		}
+		crc = crcSum(crc, valueBytes, 4 * numValueBytes);
+
+		log.push_back('f');
 	}
 	void valueChange(char const *f, char const *vn, int nv, int i)
 	{
@@ -3361,11 +3577,12 @@ struct SyncDebugLog
 	}
 	int snprint(char *buf, size_t bufSize)
 	{
-		SyncDebugString const *stringPtr = strings.empty() ? nullptr : &strings[0]; // .empty() check, since &strings[0] is undefined if strings is empty(), even if it's likely to work, anyway.
+		SyncDebugFormat const *formatPtr = formats.empty() ? nullptr : &formats[0]; // .empty() check, since &formats[0] is undefined if formats is empty(), even if it's likely to work, anyway.
 		SyncDebugValueChange const *valueChangePtr = valueChanges.empty() ? nullptr : &valueChanges[0];
 		SyncDebugIntList const *intListPtr = intLists.empty() ? nullptr : &intLists[0];
 		char const *charPtr = chars.empty() ? nullptr : &chars[0];
 		int const *intPtr = ints.empty() ? nullptr : &ints[0];
+		uint64_t const *argPtr = args.empty() ? nullptr : &args[0];
 
 		int index = 0;
 		for (size_t n = 0; n < log.size() && (size_t)index < bufSize; ++n)
@@ -3373,8 +3590,8 @@ struct SyncDebugLog
 			char type = log[n];
 			switch (type)
 			{
-			case 's':
-				index += stringPtr++->snprint(buf + index, bufSize - index, charPtr);
+			case 'f':
+				index += formatPtr++->snprint(buf + index, bufSize - index, argPtr, charPtr);
 				break;
 			case 'v':
 				index += valueChangePtr++->snprint(buf + index, bufSize - index);
@@ -3415,11 +3632,12 @@ private:
 	uint32_t time;
 	uint32_t crc;
 
-	std::vector<SyncDebugString> strings;
+	std::vector<SyncDebugFormat> formats;
 	std::vector<SyncDebugValueChange> valueChanges;
 	std::vector<SyncDebugIntList> intLists;
 
-	std::vector<char> chars;
+	std::vector<uint64_t> args;  ///< Raw arguments of formats.
+	std::vector<char> chars;     ///< Copies of the string arguments of formats.
 	std::vector<int> ints;
 
 private:
@@ -3427,7 +3645,6 @@ private:
 	SyncDebugLog &operator =(SyncDebugLog const &)/* = delete*/;
 };
 
-#define MAX_LEN_LOG_LINE 512  // From debug.c - no use printing something longer.
 #define MAX_SYNC_HISTORY 12
 
 static unsigned syncDebugNext = 0;
@@ -3447,13 +3664,10 @@ void _syncDebug(const char *function, const char *str, ...)
 #endif
 
 	va_list ap;
-	char outputBuffer[MAX_LEN_LOG_LINE];
 
 	va_start(ap, str);
-	vssprintf(outputBuffer, str, ap);
+	syncDebugLog[syncDebugNext].format(function, str, ap);
 	va_end(ap);
-
-	syncDebugLog[syncDebugNext].string(function, outputBuffer);
 }
 
 void _syncDebugIntList(const char *function, const char *str, int *ints, size_t numInts)
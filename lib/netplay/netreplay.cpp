@@ -0,0 +1,230 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2005-2019  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/**
+ * @file netreplay.cpp
+ *
+ * Replay file format, all numbers big endian:
+ *   "WZrp", uint32_t version, uint32_t settings length, settings,
+ *   then for each message: uint8_t player, message in the same encoding as sent over the net,
+ *   and finally a player of REPLAY_END. A file without the end marker (crash) plays back until it ends.
+ */
+#include "lib/framework/frame.h"
+
+#include <physfs.h>
+#include "lib/framework/physfs_ext.h"
+
+#include "netreplay.h"
+#include "netqueue.h"
+
+#include <vector>
+
+#define REPLAY_VERSION 1
+#define REPLAY_END 0xFF
+#define REPLAY_BUFFER_SIZE (64 * 1024)
+
+static PHYSFS_file *saveHandle = nullptr;
+static std::vector<uint8_t> saveBuffer;  ///< Written in large chunks, not once per message.
+
+static PHYSFS_file *loadHandle = nullptr;
+static std::vector<uint8_t> loadBuffer;
+static size_t loadPos = 0;
+static bool loadFinished = false;
+
+static void flushSaveBuffer()
+{
+	if (!saveBuffer.empty())
+	{
+		WZ_PHYSFS_writeBytes(saveHandle, saveBuffer.data(), saveBuffer.size());
+		saveBuffer.clear();
+	}
+}
+
+static void appendUint32(std::vector<uint8_t> &buffer, uint32_t v)
+{
+	uint8_t b[4] = {uint8_t(v >> 24), uint8_t(v >> 16), uint8_t(v >> 8), uint8_t(v)};
+	buffer.insert(buffer.end(), b, b + 4);
+}
+
+bool NETreplaySaveStart(const char *filename, const std::string &settings)
+{
+	ASSERT_OR_RETURN(false, saveHandle == nullptr, "Already recording a replay");
+	saveHandle = PHYSFS_openWrite(filename);
+	if (!saveHandle)
+	{
+		debug(LOG_ERROR, "Could not create replay %s: %s", filename, WZ_PHYSFS_getLastError());
+		return false;
+	}
+	saveBuffer.clear();
+	saveBuffer.insert(saveBuffer.end(), {'W', 'Z', 'r', 'p'});
+	appendUint32(saveBuffer, REPLAY_VERSION);
+	appendUint32(saveBuffer, settings.size());
+	saveBuffer.insert(saveBuffer.end(), settings.begin(), settings.end());
+	flushSaveBuffer();
+	debug(LOG_NET, "Recording replay %s", filename);
+	return true;
+}
+
+void NETreplaySaveNetMessage(const NetMessage &message, uint8_t player)
+{
+	if (saveHandle == nullptr)
+	{
+		return;
+	}
+	saveBuffer.push_back(player);
+	size_t oldSize = saveBuffer.size();
+	saveBuffer.resize(oldSize + message.rawLen());
+	uint8_t *raw = message.rawDataDup();
+	std::copy(raw, raw + message.rawLen(), saveBuffer.begin() + oldSize);
+	delete[] raw;
+	if (saveBuffer.size() >= REPLAY_BUFFER_SIZE)
+	{
+		flushSaveBuffer();
+	}
+}
+
+bool NETreplaySaveStop()
+{
+	if (saveHandle == nullptr)
+	{
+		return false;
+	}
+	saveBuffer.push_back(REPLAY_END);
+	flushSaveBuffer();
+	PHYSFS_close(saveHandle);
+	saveHandle = nullptr;
+	return true;
+}
+
+/// Makes sure that at least len bytes are buffered, reading more of the file if needed.
+static bool loadBytes(size_t len)
+{
+	if (loadBuffer.size() - loadPos >= len)
+	{
+		return true;
+	}
+	loadBuffer.erase(loadBuffer.begin(), loadBuffer.begin() + loadPos);
+	loadPos = 0;
+	size_t oldSize = loadBuffer.size();
+	size_t want = std::max<size_t>(len - oldSize, REPLAY_BUFFER_SIZE);
+	loadBuffer.resize(oldSize + want);
+	PHYSFS_sint64 got = WZ_PHYSFS_readBytes(loadHandle, loadBuffer.data() + oldSize, want);
+	loadBuffer.resize(oldSize + std::max<PHYSFS_sint64>(got, 0));
+	return loadBuffer.size() >= len;
+}
+
+static uint32_t loadUint32()
+{
+	const uint8_t *b = &loadBuffer[loadPos];
+	loadPos += 4;
+	return uint32_t(b[0]) << 24 | uint32_t(b[1]) << 16 | uint32_t(b[2]) << 8 | b[3];
+}
+
+bool NETreplayLoadStart(const char *filename, std::string &settings)
+{
+	ASSERT_OR_RETURN(false, loadHandle == nullptr, "Already playing a replay");
+	loadHandle = PHYSFS_openRead(filename);
+	if (!loadHandle)
+	{
+		debug(LOG_ERROR, "Could not open replay %s: %s", filename, WZ_PHYSFS_getLastError());
+		return false;
+	}
+	loadBuffer.clear();
+	loadPos = 0;
+	loadFinished = false;
+	if (!loadBytes(12) || memcmp(&loadBuffer[0], "WZrp", 4) != 0)
+	{
+		debug(LOG_ERROR, "%s is not a replay", filename);
+		NETreplayLoadStop();
+		return false;
+	}
+	loadPos = 4;
+	uint32_t version = loadUint32();
+	if (version != REPLAY_VERSION)
+	{
+		debug(LOG_ERROR, "Replay %s has unsupported version %u", filename, version);
+		NETreplayLoadStop();
+		return false;
+	}
+	uint32_t settingsLen = loadUint32();
+	if (!loadBytes(settingsLen))
+	{
+		debug(LOG_ERROR, "Replay %s is truncated", filename);
+		NETreplayLoadStop();
+		return false;
+	}
+	settings.assign(loadBuffer.begin() + loadPos, loadBuffer.begin() + loadPos + settingsLen);
+	loadPos += settingsLen;
+	debug(LOG_NET, "Playing replay %s", filename);
+	return true;
+}
+
+bool NETreplayLoadNetMessage(NetMessage &message, uint8_t &player)
+{
+	if (loadHandle == nullptr || loadFinished)
+	{
+		return false;
+	}
+	// Player and message type, then the length, using the same encoding as NetMessage::rawDataDup().
+	uint32_t len = 0;
+	size_t header = 2;
+	bool moreBytes = true;
+	for (unsigned n = 0; moreBytes; ++n, ++header)
+	{
+		if (!loadBytes(header + 1) || loadBuffer[loadPos] == REPLAY_END)
+		{
+			loadFinished = true;
+			return false;
+		}
+		moreBytes = decode_uint32_t(loadBuffer[loadPos + header], len, n);
+	}
+	if (!loadBytes(header + len))
+	{
+		debug(LOG_WARNING, "Replay ends in the middle of a message");
+		loadFinished = true;
+		return false;
+	}
+	player = loadBuffer[loadPos];
+	message.type = loadBuffer[loadPos + 1];
+	message.data.assign(loadBuffer.begin() + loadPos + header, loadBuffer.begin() + loadPos + header + len);
+	loadPos += header + len;
+	return true;
+}
+
+bool NETreplayLoadStop()
+{
+	if (loadHandle == nullptr)
+	{
+		return false;
+	}
+	PHYSFS_close(loadHandle);
+	loadHandle = nullptr;
+	loadBuffer.clear();
+	loadPos = 0;
+	return true;
+}
+
+bool NETisReplay()
+{
+	return loadHandle != nullptr;
+}
+
+bool NETreplayFinished()
+{
+	return loadFinished;
+}
@@ -0,0 +1,53 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2005-2019  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/** @file
+ *  Recording and playback of the game queues.
+ *
+ *  A replay file holds the game setup, as an opaque string from the game, followed by every
+ *  message in the order it was taken from the game queues. Since the game queues are all that
+ *  drives the synchronised simulation, feeding the messages back reproduces the game exactly.
+ */
+
+#ifndef _netreplay_h
+#define _netreplay_h
+
+#include "lib/framework/frame.h"
+
+#include <string>
+
+class NetMessage;
+
+/// Starts writing a replay file, beginning with the game setup.
+bool NETreplaySaveStart(const char *filename, const std::string &settings);
+/// Appends a message which was just taken from the game queue of the given player.
+void NETreplaySaveNetMessage(const NetMessage &message, uint8_t player);
+bool NETreplaySaveStop();
+
+/// Opens a replay file for playback, and returns its game setup.
+bool NETreplayLoadStart(const char *filename, std::string &settings);
+/// Reads the next recorded message. Returns false at the end of the replay.
+bool NETreplayLoadNetMessage(NetMessage &message, uint8_t &player);
+bool NETreplayLoadStop();
+
+/// True while playing back a replay, in which case the game queues are fed from the file only.
+bool NETisReplay();
+/// True once all recorded messages have been read.
+bool NETreplayFinished();
+
+#endif // _netreplay_h
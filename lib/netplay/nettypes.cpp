@@ -38,6 +38,7 @@
 #include "nettypes.h"
 #include "netqueue.h"
 #include "netlog.h"
+#include "netreplay.h"
 #include "src/order.h"
 #include <cstring>
 
@@ -474,6 +475,13 @@ bool NETend()
 	// If we are encoding just return true
 	if (NETgetPacketDir() == PACKET_ENCODE)
 	{
+		if ((queueInfo.queueType == QUEUE_GAME || queueInfo.queueType == QUEUE_GAME_FORCED) && NETisReplay())
+		{
+			// Only the recorded messages may drive the game when playing back a replay.
+			NETsetPacketDir(PACKET_INVALID);
+			return true;
+		}
+
 		// Push the message onto the list.
 		NetQueue *queue = sendQueue(queueInfo);
 		if (queue == nullptr) {
@@ -27,16 +27,47 @@
 #include "event.h"
 #include "script.h"
 
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
 // array to store release functions
 static VAL_CREATE_FUNC	*asCreateFuncs = nullptr;
 static VAL_RELEASE_FUNC	*asReleaseFuncs = nullptr;
 static UDWORD		numFuncs;
 
-/** The list of currently active triggers */
-ACTIVE_TRIGGER		*psTrigList = nullptr;
+/*
+ * The timed triggers are kept in a hierarchical timer wheel. Level 0 has a slot for each of the next
+ * TRIGGER_WHEEL_SLOTS script ticks, and each following level has slots spanning TRIGGER_WHEEL_SLOTS
+ * times as many ticks. When the wheel time reaches the start of a slot on a higher level, the triggers
+ * in it are moved down to the level that now fits them.
+ */
+#define TRIGGER_WHEEL_BITS		8
+#define TRIGGER_WHEEL_SLOTS		(1 << TRIGGER_WHEEL_BITS)
+#define TRIGGER_WHEEL_MASK		(TRIGGER_WHEEL_SLOTS - 1)
+#define TRIGGER_WHEEL_LEVELS	4		// enough for any UDWORD time
+
+static ACTIVE_TRIGGER	*asTriggerWheel[TRIGGER_WHEEL_LEVELS][TRIGGER_WHEEL_SLOTS];
+static UDWORD		aTriggerWheelCount[TRIGGER_WHEEL_LEVELS];
+
+/** All timed triggers due before this time have been taken out of the wheel */
+static UDWORD		triggerWheelTime = 0;
+
+/** Timed triggers which were already due when they were added */
+static ACTIVE_TRIGGER	*psOverdueTriggers = nullptr;
+
+/** The callback triggers, one list for each type from TR_CALLBACKSTART */
+static std::vector<ACTIVE_TRIGGER *> apsCallbackTriggers;
+
+/** Numbers the triggers as they are added. Triggers due at the same time fire the most recently added first. */
+static UDWORD		triggerSequence = 0;
 
-/** The list of callback triggers */
-ACTIVE_TRIGGER		*psCallbackList = nullptr;
+/** The due triggers eventProcessTriggers is firing, in order. Set to nullptr if freed before they fire. */
+static std::vector<ACTIVE_TRIGGER *> apsDueTriggers;
+static size_t		nextDueTrigger = 0;
+
+/** Whether any trigger has been marked for deletion since the lists were last pruned */
+static bool		triggersMarked = false;
 
 /** The new triggers added this loop */
 static ACTIVE_TRIGGER	*psAddedTriggers = nullptr;
@@ -98,25 +129,241 @@ static void eventAddTrigger(ACTIVE_TRIGGER *psTrigger);
 static void eventFreeTrigger(ACTIVE_TRIGGER *psTrigger);
 
 // Remove triggers marked for deletion
-static void eventPruneList(ACTIVE_TRIGGER **psList);
+static void eventPruneList(ACTIVE_TRIGGER **psList, UDWORD *pCount);
 static void eventPruneLists(void)
 {
-	eventPruneList(&psTrigList);
-	eventPruneList(&psCallbackList);
-	eventPruneList(&psAddedTriggers);
+	if (triggersMarked)
+	{
+		eventPruneList(&psOverdueTriggers, nullptr);
+		for (int level = 0; level < TRIGGER_WHEEL_LEVELS; level++)
+		{
+			for (int slot = 0; slot < TRIGGER_WHEEL_SLOTS; slot++)
+			{
+				eventPruneList(&asTriggerWheel[level][slot], &aTriggerWheelCount[level]);
+			}
+		}
+		for (ACTIVE_TRIGGER *&psCallbacks : apsCallbackTriggers)
+		{
+			eventPruneList(&psCallbacks, nullptr);
+		}
+		triggersMarked = false;
+	}
+	eventPruneList(&psAddedTriggers, nullptr);
+}
+
+// Put a timed trigger in the wheel slot for its time
+static void eventWheelInsert(ACTIVE_TRIGGER *psTrigger)
+{
+	UDWORD	testTime = psTrigger->testTime;
+	UDWORD	delta = testTime - triggerWheelTime;
+	int		level = 0;
+
+	if (testTime < triggerWheelTime)
+	{
+		psTrigger->psNext = psOverdueTriggers;
+		psOverdueTriggers = psTrigger;
+		return;
+	}
+	while (level + 1 < TRIGGER_WHEEL_LEVELS && delta >= 1u << ((level + 1) * TRIGGER_WHEEL_BITS))
+	{
+		level++;
+	}
+	ACTIVE_TRIGGER **ppsSlot = &asTriggerWheel[level][(testTime >> (level * TRIGGER_WHEEL_BITS)) & TRIGGER_WHEEL_MASK];
+	psTrigger->psNext = *ppsSlot;
+	*ppsSlot = psTrigger;
+	aTriggerWheelCount[level]++;
+}
+
+// Move the triggers in a slot of a higher level down the wheel
+static void eventWheelCascade(int level, int slot)
+{
+	ACTIVE_TRIGGER *psCurr = asTriggerWheel[level][slot], *psNext;
+
+	asTriggerWheel[level][slot] = nullptr;
+	for (; psCurr; psCurr = psNext)
+	{
+		psNext = psCurr->psNext;
+		aTriggerWheelCount[level]--;
+		eventWheelInsert(psCurr);
+	}
+}
+
+// Take all the timed triggers due by currTime out of the wheel, into apsDueTriggers in the order they fire
+static void eventWheelTakeDue(UDWORD currTime)
+{
+	ACTIVE_TRIGGER	*psCurr, *psNext;
+	int				level;
+
+	apsDueTriggers.clear();
+	nextDueTrigger = 0;
+	for (psCurr = psOverdueTriggers; psCurr; psCurr = psNext)
+	{
+		psNext = psCurr->psNext;
+		apsDueTriggers.push_back(psCurr);
+	}
+	psOverdueTriggers = nullptr;
+
+	while (triggerWheelTime <= currTime)
+	{
+		for (level = 1; level < TRIGGER_WHEEL_LEVELS && (triggerWheelTime & ((1u << (level * TRIGGER_WHEEL_BITS)) - 1)) == 0; level++)
+		{
+			eventWheelCascade(level, (triggerWheelTime >> (level * TRIGGER_WHEEL_BITS)) & TRIGGER_WHEEL_MASK);
+		}
+
+		ACTIVE_TRIGGER **ppsSlot = &asTriggerWheel[0][triggerWheelTime & TRIGGER_WHEEL_MASK];
+		for (psCurr = *ppsSlot; psCurr; psCurr = psNext)
+		{
+			psNext = psCurr->psNext;
+			aTriggerWheelCount[0]--;
+			apsDueTriggers.push_back(psCurr);
+		}
+		*ppsSlot = nullptr;
+
+		// Skip the ticks with nothing to fire or cascade
+		for (level = 0; level < TRIGGER_WHEEL_LEVELS && aTriggerWheelCount[level] == 0; level++) {}
+		if (level == 0)
+		{
+			triggerWheelTime++;
+		}
+		else if (level == TRIGGER_WHEEL_LEVELS)
+		{
+			triggerWheelTime = currTime + 1;
+		}
+		else
+		{
+			UDWORD nextCascade = (triggerWheelTime | ((1u << (level * TRIGGER_WHEEL_BITS)) - 1)) + 1;
+			triggerWheelTime = std::min(nextCascade, currTime + 1);
+		}
+	}
+
+	// The order a single list sorted by time, with new triggers inserted before older ones due at the same time, would give
+	std::sort(apsDueTriggers.begin(), apsDueTriggers.end(), [](ACTIVE_TRIGGER const *a, ACTIVE_TRIGGER const *b) {
+		return a->testTime != b->testTime ? a->testTime < b->testTime : a->sequence > b->sequence;
+	});
+}
+
+// Calls func for all the timed triggers still waiting to fire, in no particular order
+template <typename Func>
+static void eventForEachTimedList(Func func)
+{
+	func(&psOverdueTriggers, (UDWORD *)nullptr);
+	for (int level = 0; level < TRIGGER_WHEEL_LEVELS; level++)
+	{
+		for (int slot = 0; slot < TRIGGER_WHEEL_SLOTS; slot++)
+		{
+			func(&asTriggerWheel[level][slot], &aTriggerWheelCount[level]);
+		}
+	}
+}
+
+// Get the timed triggers, in the order they will fire
+std::vector<ACTIVE_TRIGGER *> eventGetTimedTriggers()
+{
+	std::vector<ACTIVE_TRIGGER *> apsTriggers;
+
+	eventForEachTimedList([&](ACTIVE_TRIGGER **ppsList, UDWORD *) {
+		for (ACTIVE_TRIGGER *psCurr = *ppsList; psCurr; psCurr = psCurr->psNext)
+		{
+			apsTriggers.push_back(psCurr);
+		}
+	});
+	std::sort(apsTriggers.begin(), apsTriggers.end(), [](ACTIVE_TRIGGER const *a, ACTIVE_TRIGGER const *b) {
+		return a->testTime != b->testTime ? a->testTime < b->testTime : a->sequence > b->sequence;
+	});
+	return apsTriggers;
+}
+
+// Get the callback triggers, in the order of their types, then the order they fire
+std::vector<ACTIVE_TRIGGER *> eventGetCallbackTriggers()
+{
+	std::vector<ACTIVE_TRIGGER *> apsTriggers;
+
+	for (ACTIVE_TRIGGER *psCallbacks : apsCallbackTriggers)
+	{
+		for (ACTIVE_TRIGGER *psCurr = psCallbacks; psCurr; psCurr = psCurr->psNext)
+		{
+			apsTriggers.push_back(psCurr);
+		}
+	}
+	return apsTriggers;
+}
+
+// Find any timed or callback trigger
+static ACTIVE_TRIGGER *eventFindAnyTrigger()
+{
+	ACTIVE_TRIGGER *psFound = nullptr;
+
+	eventForEachTimedList([&](ACTIVE_TRIGGER **ppsList, UDWORD *) {
+		psFound = psFound ? psFound : *ppsList;
+	});
+	for (ACTIVE_TRIGGER *psCallbacks : apsCallbackTriggers)
+	{
+		psFound = psFound ? psFound : psCallbacks;
+	}
+	return psFound;
 }
 
 //resets the event timer - updateTime
 void eventTimeReset(UDWORD initTime)
 {
 	updateTime = initTime;
+
+	// Put the timed triggers back into the wheel, relative to the new time
+	std::vector<ACTIVE_TRIGGER *> apsTriggers = eventGetTimedTriggers();
+	eventForEachTimedList([](ACTIVE_TRIGGER **ppsList, UDWORD *pCount) {
+		*ppsList = nullptr;
+		if (pCount)
+		{
+			*pCount = 0;
+		}
+	});
+	triggerWheelTime = initTime;
+	for (ACTIVE_TRIGGER *psTrigger : apsTriggers)
+	{
+		eventWheelInsert(psTrigger);
+	}
+}
+
+// Print the number of triggers, and the number fired and time spent running since the context was created, for each context
+void eventDumpStats()
+{
+	UDWORD	numContexts = 0, numTimed = 0, numCallbacks = 0;
+
+	for (SCRIPT_CONTEXT *psCont = psContList; psCont; psCont = psCont->psNext)
+	{
+		numContexts++;
+	}
+	std::vector<ACTIVE_TRIGGER *> apsTimed = eventGetTimedTriggers(), apsCallbacks = eventGetCallbackTriggers();
+	debug(LOG_INFO, "Script triggers: %u contexts, %u timed (%u in wheel level 0, %u level 1, %u level 2, %u level 3), %u callback",
+	      numContexts, (unsigned)apsTimed.size(), aTriggerWheelCount[0], aTriggerWheelCount[1], aTriggerWheelCount[2], aTriggerWheelCount[3], (unsigned)apsCallbacks.size());
+
+	for (SCRIPT_CONTEXT *psCont = psContList; psCont; psCont = psCont->psNext)
+	{
+		numTimed = std::count_if(apsTimed.begin(), apsTimed.end(), [psCont](ACTIVE_TRIGGER const *psTrigger) { return psTrigger->psContext == psCont; });
+		numCallbacks = std::count_if(apsCallbacks.begin(), apsCallbacks.end(), [psCont](ACTIVE_TRIGGER const *psTrigger) { return psTrigger->psContext == psCont; });
+		debug(LOG_INFO, "  context %p (%d events, first %s): %u timed, %u callback triggers, %u fired, %.3f ms",
+		      (void *)psCont, psCont->psCode->numEvents, psCont->psCode->numEvents > 0 ? eventGetEventID(psCont->psCode, 0) : "none",
+		      numTimed, numCallbacks, psCont->firedCount, psCont->runTime / 1000.0);
+	}
+}
+
+// Run some script code, adding the time it takes to the context's statistics
+static bool eventRunScript(SCRIPT_CONTEXT *psContext, INTERP_RUNTYPE runType, UDWORD index, UDWORD offset)
+{
+	auto start = std::chrono::steady_clock::now();
+	bool ret = interpRunScript(psContext, runType, index, offset);
+	psContext->runTime += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+	return ret;
 }
 
 /* Initialise the event system */
 bool eventInitialise()
 {
-	psTrigList = nullptr;
-	psCallbackList = nullptr;
+	psOverdueTriggers = nullptr;
+	memset(asTriggerWheel, 0, sizeof(asTriggerWheel));
+	memset(aTriggerWheelCount, 0, sizeof(aTriggerWheelCount));
+	triggerWheelTime = 0;
+	apsCallbackTriggers.clear();
 	psContList = nullptr;
 	eventTraceLevel = 0;
 	asCreateFuncs = nullptr;
@@ -131,32 +378,21 @@ void eventReset(void)
 {
 	SDWORD			count = 0;
 
-	// Free any active triggers and their context's
-	while (psTrigList)
+	if (debugPartEnabled(LOG_SCRIPT))
 	{
-		ACTIVE_TRIGGER	*psCurr = psTrigList;
-
-		psTrigList = psTrigList->psNext;
-		if (!psCurr->psContext->release)
-		{
-			count += 1;
-		}
-		eventRemoveContext(psCurr->psContext);
-		free(psCurr);
+		eventDumpStats();
 	}
-	// Free any active callback triggers and their context's
-	while (psCallbackList)
-	{
-		ACTIVE_TRIGGER	*psCurr = psCallbackList;
 
-		psCallbackList = psCallbackList->psNext;
+	// Free any active triggers and their context's
+	while (ACTIVE_TRIGGER *psCurr = eventFindAnyTrigger())
+	{
 		if (!psCurr->psContext->release)
 		{
 			count += 1;
 		}
-		eventRemoveContext(psCurr->psContext);
-		free(psCurr);
+		eventRemoveContext(psCurr->psContext);  // frees psCurr as well
 	}
+	triggerWheelTime = 0;
 	// Now free any contexts that are left
 	while (psContList)
 	{
@@ -517,63 +753,56 @@ bool eventRunContext(SCRIPT_CONTEXT *psContext, UDWORD time)
 	return true;
 }
 
-// Remove an object from the event system
-void eventRemoveContext(SCRIPT_CONTEXT *psContext)
+// Free all the triggers in a list belonging to a context
+static void eventRemoveContextTriggers(ACTIVE_TRIGGER **ppsList, SCRIPT_CONTEXT *psContext, UDWORD *pCount)
 {
-	ACTIVE_TRIGGER *psCurr, *psPrev, *psNext;
-	VAL_CHUNK		*psCChunk, *psNChunk;
-	SCRIPT_CONTEXT	*psCCont, *psPCont = nullptr;
-	SDWORD			i, chunkStart;
-	INTERP_VAL		*psVal;
+	ACTIVE_TRIGGER **ppsCurr = ppsList;
 
-	// Get rid of all it's triggers
-	while (psTrigList && psTrigList->psContext == psContext)
-	{
-		psNext = psTrigList->psNext;
-		eventFreeTrigger(psTrigList);
-		psTrigList = psNext;
-	}
-
-	for (psPrev = nullptr, psCurr = psTrigList; psCurr; psCurr = psNext)
+	while (*ppsCurr)
 	{
-		psNext = psCurr->psNext;
+		ACTIVE_TRIGGER *psCurr = *ppsCurr;
 		if (psCurr->psContext == psContext)
 		{
-			eventFreeTrigger(psCurr);
-			if (psPrev)
+			*ppsCurr = psCurr->psNext;
+			if (pCount)
 			{
-				psPrev->psNext = psNext;
+				*pCount -= 1;
 			}
+			eventFreeTrigger(psCurr);
 		}
 		else
 		{
-			psPrev = psCurr;
+			ppsCurr = &psCurr->psNext;
 		}
 	}
-	// Get rid of all it's callback triggers
-	while (psCallbackList && psCallbackList->psContext == psContext)
-	{
-		psNext = psCallbackList->psNext;
-		eventFreeTrigger(psCallbackList);
-		psCallbackList = psNext;
-	}
+}
+
+// Remove an object from the event system
+void eventRemoveContext(SCRIPT_CONTEXT *psContext)
+{
+	VAL_CHUNK		*psCChunk, *psNChunk;
+	SCRIPT_CONTEXT	*psCCont, *psPCont = nullptr;
+	SDWORD			i, chunkStart;
+	INTERP_VAL		*psVal;
 
-	for (psPrev = nullptr, psCurr = psCallbackList; psCurr; psCurr = psNext)
+	// Get rid of all it's triggers
+	eventForEachTimedList([psContext](ACTIVE_TRIGGER **ppsList, UDWORD *pCount) {
+		eventRemoveContextTriggers(ppsList, psContext, pCount);
+	});
+	for (size_t i = nextDueTrigger; i < apsDueTriggers.size(); i++)
 	{
-		psNext = psCurr->psNext;
-		if (psCurr->psContext == psContext)
+		ACTIVE_TRIGGER *psCurr = apsDueTriggers[i];
+		if (psCurr && psCurr->psContext == psContext)
 		{
+			apsDueTriggers[i] = nullptr;
 			eventFreeTrigger(psCurr);
-			if (psPrev)
-			{
-				psPrev->psNext = psNext;
-			}
-		}
-		else
-		{
-			psPrev = psCurr;
 		}
 	}
+	// Get rid of all it's callback triggers
+	for (ACTIVE_TRIGGER *&psCallbacks : apsCallbackTriggers)
+	{
+		eventRemoveContextTriggers(&psCallbacks, psContext, nullptr);
+	}
 
 	// Call the release function for all the values
 	if (asReleaseFuncs != nullptr)
@@ -698,56 +927,25 @@ bool eventSetContextVar(SCRIPT_CONTEXT *psContext, UDWORD index, INTERP_VAL *dat
 	return true;
 }
 
-// Add a trigger to the list in order
+// Add a trigger to the wheel or callback list
 static void eventAddTrigger(ACTIVE_TRIGGER *psTrigger)
 {
-	UDWORD	testTime = psTrigger->testTime;
+	psTrigger->sequence = triggerSequence++;
 
 	if (psTrigger->type >= TR_CALLBACKSTART)
 	{
-		// Add this to the callback trigger list
-		if (psCallbackList == nullptr)
-		{
-			psTrigger->psNext = nullptr;
-			psCallbackList = psTrigger;
-		}
-		else if (psTrigger->type <= psCallbackList->type)
+		// Add this to the front of the list for its callback type
+		size_t index = psTrigger->type - TR_CALLBACKSTART;
+		if (index >= apsCallbackTriggers.size())
 		{
-			psTrigger->psNext = psCallbackList;
-			psCallbackList = psTrigger;
+			apsCallbackTriggers.resize(index + 1, nullptr);
 		}
-		else
-		{
-			ACTIVE_TRIGGER *psCurr, *psPrev = nullptr;
-
-			for (psCurr = psCallbackList; psCurr && psCurr->type < psTrigger->type; psCurr = psCurr->psNext)
-			{
-				psPrev = psCurr;
-			}
-			psTrigger->psNext = psPrev->psNext;
-			psPrev->psNext =  psTrigger;
-		}
-	}
-	else if (psTrigList == nullptr)
-	{
-		psTrigger->psNext = nullptr;
-		psTrigList = psTrigger;
-	}
-	else if (testTime <= psTrigList->testTime)
-	{
-		psTrigger->psNext = psTrigList;
-		psTrigList = psTrigger;
+		psTrigger->psNext = apsCallbackTriggers[index];
+		apsCallbackTriggers[index] = psTrigger;
 	}
 	else
 	{
-		ACTIVE_TRIGGER *psCurr, *psPrev = nullptr;
-
-		for (psCurr = psTrigList; psCurr && psCurr->testTime < testTime; psCurr = psCurr->psNext)
-		{
-			psPrev = psCurr;
-		}
-		psTrigger->psNext = psPrev->psNext;
-		psPrev->psNext =  psTrigger;
+		eventWheelInsert(psTrigger);
 	}
 }
 
@@ -888,78 +1086,74 @@ void eventFireCallbackTrigger(TRIGGER_TYPE callback)
 
 	//this can be called from eventProcessTriggers and so will wipe out all the current added ones
 	//psAddedTriggers = NULL;
-	for (psCurr = psCallbackList; psCurr && psCurr->type <= (int)callback; psCurr = psNext)
+	size_t index = callback - TR_CALLBACKSTART;
+	ACTIVE_TRIGGER **ppsCallbacks = callback >= TR_CALLBACKSTART && index < apsCallbackTriggers.size() ? &apsCallbackTriggers[index] : nullptr;
+	for (psCurr = ppsCallbacks ? *ppsCallbacks : nullptr; psCurr; psCurr = psNext)
 	{
 		psNext = psCurr->psNext;
-		if (psCurr->type == (int)callback)
+		// see if the callback should be fired
+		fired = false;
+		if (psCurr->type != TR_PAUSE)
 		{
-			// see if the callback should be fired
-			fired = false;
-			if (psCurr->type != TR_PAUSE)
+			ASSERT(psCurr->trigger >= 0 && psCurr->trigger < psCurr->psContext->psCode->numTriggers, "Invalid trigger number");
+			psTrigDat = psCurr->psContext->psCode->psTriggerData + psCurr->trigger;
+		}
+		else
+		{
+			psTrigDat = nullptr;
+		}
+		if (psTrigDat && psTrigDat->code)
+		{
+			if (!eventRunScript(psCurr->psContext, IRT_TRIGGER, psCurr->trigger, 0))
 			{
-				ASSERT(psCurr->trigger >= 0 && psCurr->trigger < psCurr->psContext->psCode->numTriggers, "Invalid trigger number");
-				psTrigDat = psCurr->psContext->psCode->psTriggerData + psCurr->trigger;
+				ASSERT(false, "Trigger %s: code failed", eventGetTriggerID(psCurr->psContext->psCode, psCurr->trigger));
+				psPrev = psCurr;
+				continue;
 			}
-			else
+			if (!stackPopParams(1, VAL_BOOL, &fired))
 			{
-				psTrigDat = nullptr;
+				ASSERT(false, "Trigger %s: code failed", eventGetTriggerID(psCurr->psContext->psCode, psCurr->trigger));
+				psPrev = psCurr;
+				continue;
 			}
-			if (psTrigDat && psTrigDat->code)
+		}
+		else
+		{
+			fired = true;
+		}
+
+		// run the event
+		if (fired)
+		{
+			DB_TRIGINF(psCurr, 1);
+			DB_TRACE(" fired", 1);
+
+			// remove the trigger from the list
+			if (psPrev == nullptr)
 			{
-				if (!interpRunScript(psCurr->psContext, IRT_TRIGGER, psCurr->trigger, 0))
-				{
-					ASSERT(false, "Trigger %s: code failed", eventGetTriggerID(psCurr->psContext->psCode, psCurr->trigger));
-					psPrev = psCurr;
-					continue;
-				}
-				if (!stackPopParams(1, VAL_BOOL, &fired))
-				{
-					ASSERT(false, "Trigger %s: code failed", eventGetTriggerID(psCurr->psContext->psCode, psCurr->trigger));
-					psPrev = psCurr;
-					continue;
-				}
+				*ppsCallbacks = psNext;
 			}
 			else
 			{
-				fired = true;
+				psPrev->psNext = psNext;
 			}
 
-			// run the event
-			if (fired)
+			psFiringTrigger = psCurr;
+			psCurr->psContext->firedCount += 1;
+			if (!eventRunScript(psCurr->psContext, IRT_EVENT, psCurr->event, psCurr->offset)) // this could set psCurr->deactivated
 			{
-				DB_TRIGINF(psCurr, 1);
-				DB_TRACE(" fired", 1);
-
-				// remove the trigger from the list
-				if (psPrev == nullptr)
-				{
-					psCallbackList = psCallbackList->psNext;
-				}
-				else
-				{
-					psPrev->psNext = psNext;
-				}
-
-				psFiringTrigger = psCurr;
-				if (!interpRunScript(psCurr->psContext, IRT_EVENT, psCurr->event, psCurr->offset)) // this could set psCurr->deactivated
-				{
-					ASSERT(false, "Event %s: code failed", eventGetEventID(psCurr->psContext->psCode, psCurr->event));
-				}
-				if (psCurr->deactivated)
-				{
-					// don't need to add the trigger again - just free it
-					eventFreeTrigger(psCurr);
-				}
-				else
-				{
-					// make sure the trigger goes back into the system
-					psCurr->psNext = psAddedTriggers;
-					psAddedTriggers = psCurr;
-				}
+				ASSERT(false, "Event %s: code failed", eventGetEventID(psCurr->psContext->psCode, psCurr->event));
+			}
+			if (psCurr->deactivated)
+			{
+				// don't need to add the trigger again - just free it
+				eventFreeTrigger(psCurr);
 			}
 			else
 			{
-				psPrev = psCurr;
+				// make sure the trigger goes back into the system
+				psCurr->psNext = psAddedTriggers;
+				psAddedTriggers = psCurr;
 			}
 		}
 		else
@@ -993,8 +1187,8 @@ static bool eventFireTrigger(ACTIVE_TRIGGER *psTrigger)
 	if (psTrigger->type == TR_CODE)
 	{
 		// Run the trigger
-		if (!interpRunScript(psTrigger->psContext,
-		                     IRT_TRIGGER, psTrigger->trigger, 0))
+		if (!eventRunScript(psTrigger->psContext,
+		                    IRT_TRIGGER, psTrigger->trigger, 0))
 		{
 			ASSERT(false, "Trigger %s: code failed", eventGetTriggerID(psTrigger->psContext->psCode, psTrigger->trigger));
 			return false;
@@ -1017,7 +1211,8 @@ static bool eventFireTrigger(ACTIVE_TRIGGER *psTrigger)
 	{
 		DB_TRIGINF(psTrigger, 1);
 		DB_TRACE(" fired", 1);
-		if (!interpRunScript(psTrigger->psContext, IRT_EVENT, psTrigger->event, psTrigger->offset))
+		psTrigger->psContext->firedCount += 1;
+		if (!eventRunScript(psTrigger->psContext, IRT_EVENT, psTrigger->event, psTrigger->offset))
 		{
 			ASSERT(false, "Event %s: code failed", eventGetEventID(psTrigger->psContext->psCode, psTrigger->event));
 			return false;
@@ -1043,10 +1238,14 @@ void eventProcessTriggers(UDWORD currTime)
 	// Process all the current triggers
 	psAddedTriggers = nullptr;
 	updateTime = currTime;
-	while (psTrigList && psTrigList->testTime <= currTime)
+	eventWheelTakeDue(currTime);
+	while (nextDueTrigger < apsDueTriggers.size())
 	{
-		psCurr = psTrigList;
-		psTrigList = psTrigList->psNext;
+		psCurr = apsDueTriggers[nextDueTrigger++];
+		if (psCurr == nullptr)
+		{
+			continue;  // freed along with its context
+		}
 
 		// Run the trigger
 		if (eventFireTrigger(psCurr))	// This might mark the trigger for deletion
@@ -1081,6 +1280,8 @@ void eventProcessTriggers(UDWORD currTime)
 			}
 		}
 	}
+	apsDueTriggers.clear();
+	nextDueTrigger = 0;
 
 	// Delete marked triggers now
 	eventPruneLists();
@@ -1096,7 +1297,7 @@ void eventProcessTriggers(UDWORD currTime)
 }
 
 // remove all marked triggers
-static void eventPruneList(ACTIVE_TRIGGER **ppsList)
+static void eventPruneList(ACTIVE_TRIGGER **ppsList, UDWORD *pCount)
 {
 	ACTIVE_TRIGGER	**ppsCurr = ppsList, *psTemp;
 
@@ -1107,6 +1308,10 @@ static void eventPruneList(ACTIVE_TRIGGER **ppsList)
 			psTemp = (*ppsCurr)->psNext;
 			free(*ppsCurr);
 			*ppsCurr = psTemp;
+			if (pCount)
+			{
+				*pCount -= 1;
+			}
 		}
 		else
 		{
@@ -1115,33 +1320,62 @@ static void eventPruneList(ACTIVE_TRIGGER **ppsList)
 	}
 }
 
-// Mark a trigger for removal from a list
-static void eventMarkTriggerInList(ACTIVE_TRIGGER **ppsList, SCRIPT_CONTEXT *psContext, SDWORD event, SDWORD *pTrigger)
+// Mark a trigger for removal
+static void eventMarkTrigger(ACTIVE_TRIGGER *psTrigger, SDWORD *pTrigger)
+{
+	if (psTrigger->type == TR_PAUSE)
+	{
+		// pause trigger, don't remove it,
+		// just note the type for when the pause finishes
+		psTrigger->trigger = (SWORD) * pTrigger;
+		*pTrigger = -1;
+	}
+	else
+	{
+		psTrigger->deactivated = true;
+		triggersMarked = true;
+	}
+}
+
+// Find the first trigger for an event in a list
+static ACTIVE_TRIGGER *eventFindTriggerInList(ACTIVE_TRIGGER *psList, SCRIPT_CONTEXT *psContext, SDWORD event)
+{
+	for (ACTIVE_TRIGGER *psCurr = psList; psCurr; psCurr = psCurr->psNext)
+	{
+		if (psCurr->event == event && psCurr->psContext == psContext)
+		{
+			return psCurr;
+		}
+	}
+	return nullptr;
+}
+
+// Mark the first timed trigger for an event, in the order they fire, for removal
+static void eventMarkTimedTrigger(SCRIPT_CONTEXT *psContext, SDWORD event, SDWORD *pTrigger)
 {
-	ACTIVE_TRIGGER	**ppsCurr;
+	ACTIVE_TRIGGER	*psFound = nullptr;
 
-	for (ppsCurr = ppsList;; ppsCurr = &(*ppsCurr)->psNext)
+	for (size_t i = nextDueTrigger; i < apsDueTriggers.size(); i++)
 	{
-		if (!(*ppsCurr))
+		if (apsDueTriggers[i] && apsDueTriggers[i]->event == event && apsDueTriggers[i]->psContext == psContext)
 		{
+			eventMarkTrigger(apsDueTriggers[i], pTrigger);
 			return;
 		}
-		else if ((*ppsCurr)->event == event &&
-		         (*ppsCurr)->psContext == psContext)
+	}
+	eventForEachTimedList([&](ACTIVE_TRIGGER **ppsList, UDWORD *) {
+		for (ACTIVE_TRIGGER *psCurr = *ppsList; psCurr; psCurr = psCurr->psNext)
 		{
-			break;
+			if (psCurr->event == event && psCurr->psContext == psContext &&
+			    (!psFound || psCurr->testTime < psFound->testTime || (psCurr->testTime == psFound->testTime && psCurr->sequence > psFound->sequence)))
+			{
+				psFound = psCurr;
+			}
 		}
-	}
-	if ((*ppsCurr)->type == TR_PAUSE)
-	{
-		// pause trigger, don't remove it,
-		// just note the type for when the pause finishes
-		(*ppsCurr)->trigger = (SWORD) * pTrigger;
-		*pTrigger = -1;
-	}
-	else
+	});
+	if (psFound)
 	{
-		(*ppsCurr)->deactivated = true;
+		eventMarkTrigger(psFound, pTrigger);
 	}
 }
 
@@ -1173,9 +1407,19 @@ bool eventSetTrigger(void)
 	else
 	{
 		// Mark the old trigger in the lists
-		eventMarkTriggerInList(&psTrigList, psContext, event, &trigger);
-		eventMarkTriggerInList(&psCallbackList, psContext, event, &trigger);
-		eventMarkTriggerInList(&psAddedTriggers, psContext, event, &trigger);
+		eventMarkTimedTrigger(psContext, event, &trigger);
+		for (ACTIVE_TRIGGER *psCallbacks : apsCallbackTriggers)
+		{
+			if (ACTIVE_TRIGGER *psFound = eventFindTriggerInList(psCallbacks, psContext, event))
+			{
+				eventMarkTrigger(psFound, &trigger);
+				break;
+			}
+		}
+		if (ACTIVE_TRIGGER *psFound = eventFindTriggerInList(psAddedTriggers, psContext, event))
+		{
+			eventMarkTrigger(psFound, &trigger);
+		}
 	}
 
 	// Create a new trigger if necessary
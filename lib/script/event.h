@@ -28,6 +28,8 @@
 
 #include "interpreter.h"
 
+#include <vector>
+
 /* The number of values in a context value chunk */
 #define CONTEXT_VALS 20
 
@@ -54,6 +56,8 @@ struct SCRIPT_CONTEXT
 	SDWORD			triggerCount;	// Number of currently active triggers
 	CONTEXT_RELEASE		release;		// Whether to release the context when there are no triggers
 	SWORD			id;
+	UDWORD			firedCount;		// Number of events run, for eventDumpStats()
+	uint64_t		runTime;		// Microseconds spent running triggers and events, for eventDumpStats()
 
 	SCRIPT_CONTEXT         *psNext;
 };
@@ -72,6 +76,7 @@ struct ACTIVE_TRIGGER
 	UWORD				event;
 	UWORD				offset;
 	int32_t				deactivated;	// Whether the trigger is marked for deletion
+	UDWORD				sequence;		// When the trigger was added, to keep the firing order of triggers due at the same time
 	ACTIVE_TRIGGER         *psNext;
 };
 
@@ -114,11 +119,14 @@ enum SCR_USER_TYPES
 	ST_MAXTYPE,									// maximum possible type - should always be last
 };
 
-// The list of currently active triggers
-extern ACTIVE_TRIGGER	*psTrigList;
+// The currently active timed triggers, in the order they fire
+extern std::vector<ACTIVE_TRIGGER *> eventGetTimedTriggers();
+
+// The callback triggers, by type and then in the order they fire
+extern std::vector<ACTIVE_TRIGGER *> eventGetCallbackTriggers();
 
-// The list of callback triggers
-extern ACTIVE_TRIGGER	*psCallbackList;
+// Print the trigger counts, and the events fired and time spent for each context
+extern void eventDumpStats();
 
 // The currently allocated contexts
 extern SCRIPT_CONTEXT	*psContList;
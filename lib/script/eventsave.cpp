@@ -276,11 +276,11 @@ static bool eventFindContext(SDWORD id, SCRIPT_CONTEXT **ppsContext)
 }
 
 // save a list of triggers
-static bool eventSaveTriggerList(ACTIVE_TRIGGER *psList, const WzString& tname, WzConfig &ini)
+static bool eventSaveTriggerList(const std::vector<ACTIVE_TRIGGER *> &apsList, const WzString& tname, WzConfig &ini)
 {
 	int numTriggers = 0, context = 0;
 
-	for (ACTIVE_TRIGGER *psCurr = psList; psCurr != nullptr; psCurr = psCurr->psNext)
+	for (ACTIVE_TRIGGER *psCurr : apsList)
 	{
 		if (!eventGetContextIndex(psCurr->psContext, &context))
 		{
@@ -338,7 +338,7 @@ static bool eventLoadTriggerList(WzConfig &ini, const WzString& tname)
 bool eventSaveState(const char *pFilename)
 {
 	WzConfig ini(WzString::fromUtf8(pFilename), WzConfig::ReadAndWrite);
-	if (!eventSaveContext(ini) || !eventSaveTriggerList(psTrigList, "trig", ini) || !eventSaveTriggerList(psCallbackList, "callback", ini))
+	if (!eventSaveContext(ini) || !eventSaveTriggerList(eventGetTimedTriggers(), "trig", ini) || !eventSaveTriggerList(eventGetCallbackTriggers(), "callback", ini))
 	{
 		return false;
 	}
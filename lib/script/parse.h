@@ -27,6 +27,8 @@
 
 #include "lib/framework/frame.h"
 #include <physfs.h>
+#include <string>
+#include <vector>
 
 class WzConfig;
 
@@ -312,6 +314,9 @@ void scr_error(const char *pMessage, ...);
 
 extern void scriptGetErrorData(int *pLine, char **ppText);
 
+/* The files pulled in through #include by the last compiled script */
+extern const std::vector<std::string> &scriptGetIncludedFiles();
+
 /* Look up a type symbol */
 extern bool scriptLookUpType(const char *pIdent, INTERP_TYPE *pType);
 
@@ -764,6 +764,9 @@ extern void scr_set_debug(int bdebug);
 extern int scr_lex_destroy(void);
 #endif
 
+/* The files included by the script being compiled */
+static std::vector<std::string> scr_included_files;
+
 /* Store for any string values */
 static char aText[TEXT_BUFFERS][YYLMAX];
 static UDWORD currText=0;
@@ -1149,6 +1152,8 @@ static void pushInclude(const char *pIncludePath)
 			pIncludePath, WZ_PHYSFS_getLastError() );
 	}
 
+	scr_included_files.push_back(pIncludePath);
+
 	/* Push current flex buffer */
 	include_stack[scr_include_stack_ptr] = YY_CURRENT_BUFFER;
 	scr_include_stack_ptr++;
@@ -3004,6 +3009,7 @@ void scriptSetInputFile(PHYSFS_file* fileHandle)
 
 	/* Reset include stack */
 	scr_include_stack_ptr = 0;
+	scr_included_files.clear();
 
 	/* Initialize include input files */
 	for(i = 0; i < MAX_SCR_INCLUDE_DEPTH; ++i)
@@ -3032,6 +3038,11 @@ void scriptSetInputFile(PHYSFS_file* fileHandle)
 	}
 }
 
+const std::vector<std::string> &scriptGetIncludedFiles()
+{
+	return scr_included_files;
+}
+
 void scriptGetErrorData(int *pLine, char **ppText)
 {
 	*pLine = scr_lineno;
@@ -0,0 +1,735 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2005-2019  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/**
+ * @file scriptcache.cpp
+ *
+ * File format, numbers big endian, strings as uint32_t length (0xffffffff for none) and the bytes:
+ *   "WZsc", uint32_t version, string stamp, 32 byte fingerprint of the script tables,
+ *   uint32_t include count, then for each include: string path, 32 byte sha256 of its contents,
+ *   uint32_t code length, then for each INTERP_VAL: uint32_t type, followed by
+ *     string: string, external function: uint8_t table, string name, get/set function: uint8_t table, string name,
+ *     other pointers: nothing (only null pointers are cached), anything else: uint32_t value,
+ *   uint16_t trigger count, trigger offsets (count + 1, none without triggers),
+ *     for each trigger: uint32_t type, uint16_t code, uint32_t time,
+ *   uint16_t event count, event offsets (count + 1), uint16_t event links,
+ *     for each event: uint32_t parameter count, uint32_t local count, uint32_t local types,
+ *   uint16_t global count, uint32_t global types,
+ *   uint16_t array count, uint32_t total array size,
+ *     for each array: uint32_t base, uint32_t type, uint8_t dimensions, uint8_t elements[VAR_MAX_DIMENSIONS],
+ *   uint8_t has variable names, then for each global: string name, uint32_t storage,
+ *   uint8_t has array names, then for each array: string name, uint8_t storage,
+ *   uint8_t has line info, uint16_t entry count, then for each entry: uint32_t offset, uint32_t line, string label.
+ */
+#include "lib/framework/frame.h"
+#include "lib/framework/crc.h"
+#include "lib/framework/file.h"
+#include "lib/framework/physfs_ext.h"
+#include "lib/framework/string_ext.h"
+#include "script.h"
+#include "scriptcache.h"
+
+#include <string.h>
+#include <algorithm>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+#define SCRIPT_CACHE_VERSION 1
+#define SCRIPT_CACHE_NO_STRING 0xffffffff
+
+extern char STRSTACK[MAXSTACKLEN][MAXSTRLEN];	// the string pool that compiled code points into
+extern UDWORD CURSTACKSTR;
+
+/* The table a function pointer in the code was found in */
+enum SCRIPT_CACHE_FUNC
+{
+	SCF_INSTINCT,
+	SCF_CALLBACK,
+	SCF_EXTERNAL_GET,
+	SCF_EXTERNAL_SET,
+	SCF_OBJVAR_GET,
+	SCF_OBJVAR_SET,
+};
+
+/* Hash everything from the script tables that the compiler bakes into the code */
+static Sha256 scriptTableFingerprint()
+{
+	std::string tables;
+	auto add = [&tables](const char *pIdent, std::initializer_list<int64_t> values) {
+		tables += pIdent ? pIdent : "";
+		for (int64_t value : values)
+		{
+			tables += ' ';
+			tables += std::to_string(value);
+		}
+		tables += '\n';
+	};
+
+	for (const FUNC_SYMBOL *psFunc = asScrInstinctTab; psFunc && psFunc->pFunc != nullptr; psFunc++)
+	{
+		add(psFunc->pIdent, {psFunc->type, psFunc->numParams});
+		for (unsigned i = 0; i < psFunc->numParams && i < INST_MAXPARAMS; i++)
+		{
+			add(nullptr, {psFunc->aParams[i]});
+		}
+	}
+	for (const CALLBACK_SYMBOL *psCallback = asScrCallbackTab; psCallback && psCallback->type != 0; psCallback++)
+	{
+		add(psCallback->pIdent, {psCallback->type, psCallback->numParams});
+	}
+	for (const VAR_SYMBOL *psVars : {asScrExternalTab, asScrObjectVarTab})
+	{
+		for (const VAR_SYMBOL *psVar = psVars; psVar && psVar->pIdent != nullptr; psVar++)
+		{
+			add(psVar->pIdent, {psVar->type, psVar->storage, psVar->objType, psVar->index, psVar->get != nullptr, psVar->set != nullptr});
+		}
+	}
+	for (const CONST_SYMBOL *psConst = asScrConstantTab; psConst && psConst->type != VAL_VOID; psConst++)
+	{
+		uint32_t floatBits;
+		memcpy(&floatBits, &psConst->fval, sizeof(floatBits));
+		add(psConst->pIdent, {psConst->type, psConst->bval, psConst->ival, floatBits, psConst->oval != nullptr});
+		add(psConst->sval, {});
+	}
+
+	return sha256Sum(tables.data(), tables.size());
+}
+
+static bool scriptHashFile(const char *pFileName, Sha256 *psSum)
+{
+	char *pData;
+	UDWORD size;
+
+	if (!PHYSFS_exists(pFileName) || !loadFile(pFileName, &pData, &size))
+	{
+		return false;
+	}
+	*psSum = sha256Sum(pData, size);
+	free(pData);
+	return true;
+}
+
+// Encoding
+
+namespace
+{
+struct Encoder
+{
+	std::string out;
+
+	void putUint8(uint8_t v)
+	{
+		out.push_back(char(v));
+	}
+
+	void putUint16(uint16_t v)
+	{
+		out.push_back(char(v >> 8));
+		out.push_back(char(v));
+	}
+
+	void putUint32(uint32_t v)
+	{
+		out.push_back(char(v >> 24));
+		out.push_back(char(v >> 16));
+		out.push_back(char(v >> 8));
+		out.push_back(char(v));
+	}
+
+	void putString(const char *pStr)
+	{
+		if (pStr == nullptr)
+		{
+			putUint32(SCRIPT_CACHE_NO_STRING);
+			return;
+		}
+		size_t length = strlen(pStr);
+		putUint32(length);
+		out.append(pStr, length);
+	}
+
+	void putSha256(const Sha256 &sum)
+	{
+		out.append((const char *)sum.bytes, Sha256::Bytes);
+	}
+
+	bool putFunc(SCRIPT_FUNC pFunc)
+	{
+		for (const FUNC_SYMBOL *psFunc = asScrInstinctTab; psFunc && psFunc->pFunc != nullptr; psFunc++)
+		{
+			if (psFunc->pFunc == pFunc)
+			{
+				putUint8(SCF_INSTINCT);
+				putString(psFunc->pIdent);
+				return true;
+			}
+		}
+		for (const CALLBACK_SYMBOL *psCallback = asScrCallbackTab; psCallback && psCallback->type != 0; psCallback++)
+		{
+			if (psCallback->pFunc == pFunc)
+			{
+				putUint8(SCF_CALLBACK);
+				putString(psCallback->pIdent);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool putVarFunc(SCRIPT_VARFUNC pFunc)
+	{
+		for (const VAR_SYMBOL *psVar = asScrExternalTab; psVar && psVar->pIdent != nullptr; psVar++)
+		{
+			if (psVar->get == pFunc || psVar->set == pFunc)
+			{
+				putUint8(psVar->get == pFunc ? SCF_EXTERNAL_GET : SCF_EXTERNAL_SET);
+				putString(psVar->pIdent);
+				return true;
+			}
+		}
+		for (const VAR_SYMBOL *psVar = asScrObjectVarTab; psVar && psVar->pIdent != nullptr; psVar++)
+		{
+			if (psVar->get == pFunc || psVar->set == pFunc)
+			{
+				putUint8(psVar->get == pFunc ? SCF_OBJVAR_GET : SCF_OBJVAR_SET);
+				putString(psVar->pIdent);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool putValue(const INTERP_VAL &val)
+	{
+		putUint32(val.type);
+		switch ((unsigned)val.type)
+		{
+		case VAL_STRING:
+			putString(val.v.sval);
+			return true;
+		case VAL_FUNC_EXTERN:
+			return putFunc(val.v.pFuncExtern);
+		case VAL_OBJ_GETSET:
+			return putVarFunc(val.v.pObjGetSet);
+		default:
+			if (scriptTypeIsPointer(val.type))
+			{
+				// Object constants point into the running game, only null can be stored
+				return val.v.oval == nullptr;
+			}
+			putUint32(val.v.ival);
+			return true;
+		}
+	}
+
+	bool putCode(const SCRIPT_CODE *psCode)
+	{
+		unsigned numVals = psCode->size / sizeof(INTERP_VAL);
+
+		putUint32(numVals);
+		for (unsigned i = 0; i < numVals; i++)
+		{
+			if (!putValue(psCode->pCode[i]))
+			{
+				debug(LOG_WZ, "Value %u of type %s cannot be cached", i, scriptTypeToString(psCode->pCode[i].type));
+				return false;
+			}
+		}
+
+		putUint16(psCode->numTriggers);
+		for (unsigned i = 0; psCode->pTriggerTab && i < psCode->numTriggers + 1u; i++)
+		{
+			putUint16(psCode->pTriggerTab[i]);
+		}
+		for (unsigned i = 0; i < psCode->numTriggers; i++)
+		{
+			putUint32(psCode->psTriggerData[i].type);
+			putUint16(psCode->psTriggerData[i].code);
+			putUint32(psCode->psTriggerData[i].time);
+		}
+
+		putUint16(psCode->numEvents);
+		for (unsigned i = 0; i < psCode->numEvents + 1u; i++)
+		{
+			putUint16(psCode->pEventTab[i]);
+		}
+		for (unsigned i = 0; i < psCode->numEvents; i++)
+		{
+			putUint16(psCode->pEventLinks[i]);
+		}
+		for (unsigned i = 0; i < psCode->numEvents; i++)
+		{
+			putUint32(psCode->numParams[i]);
+			putUint32(psCode->numLocalVars[i]);
+			for (unsigned j = 0; j < psCode->numLocalVars[i]; j++)
+			{
+				putUint32(psCode->ppsLocalVars[i][j]);
+			}
+		}
+
+		putUint16(psCode->numGlobals);
+		for (unsigned i = 0; i < psCode->numGlobals; i++)
+		{
+			putUint32(psCode->pGlobals[i]);
+		}
+
+		putUint16(psCode->numArrays);
+		putUint32(psCode->arraySize);
+		for (unsigned i = 0; i < psCode->numArrays; i++)
+		{
+			const ARRAY_DATA &array = psCode->psArrayInfo[i];
+			putUint32(array.base);
+			putUint32(array.type);
+			putUint8(array.dimensions);
+			for (unsigned dimension = 0; dimension < VAR_MAX_DIMENSIONS; dimension++)
+			{
+				putUint8(array.elements[dimension]);
+			}
+		}
+
+		putUint8(psCode->psVarDebug != nullptr);
+		for (unsigned i = 0; psCode->psVarDebug && i < psCode->numGlobals; i++)
+		{
+			putString(psCode->psVarDebug[i].pIdent);
+			putUint32(psCode->psVarDebug[i].storage);
+		}
+		putUint8(psCode->psArrayDebug != nullptr);
+		for (unsigned i = 0; psCode->psArrayDebug && i < psCode->numArrays; i++)
+		{
+			putString(psCode->psArrayDebug[i].pIdent);
+			putUint8(psCode->psArrayDebug[i].storage);
+		}
+		putUint8(psCode->psDebug != nullptr);
+		putUint16(psCode->psDebug ? psCode->debugEntries : 0);
+		for (unsigned i = 0; psCode->psDebug && i < psCode->debugEntries; i++)
+		{
+			putUint32(psCode->psDebug[i].offset);
+			putUint32(psCode->psDebug[i].line);
+			putString(psCode->psDebug[i].pLabel);
+		}
+		return true;
+	}
+};
+}
+
+bool scriptSaveCode(const SCRIPT_CODE *psCode, const char *pFileName, const char *pStamp)
+{
+	Encoder encoder;
+
+	encoder.out = "WZsc";
+	encoder.putUint32(SCRIPT_CACHE_VERSION);
+	encoder.putString(pStamp);
+	encoder.putSha256(scriptTableFingerprint());
+
+	std::vector<std::string> includes = scriptGetIncludedFiles();
+	std::sort(includes.begin(), includes.end());
+	includes.erase(std::unique(includes.begin(), includes.end()), includes.end());
+	encoder.putUint32(includes.size());
+	for (const std::string &include : includes)
+	{
+		Sha256 sum;
+		if (!scriptHashFile(include.c_str(), &sum))
+		{
+			return false;
+		}
+		encoder.putString(include.c_str());
+		encoder.putSha256(sum);
+	}
+
+	if (!encoder.putCode(psCode))
+	{
+		return false;
+	}
+	return saveFile(pFileName, encoder.out.data(), encoder.out.size());
+}
+
+// Decoding
+
+namespace
+{
+/// Reads the data front to back, failing instead of reading past the end.
+struct Decoder
+{
+	const uint8_t *pos;
+	const uint8_t *end;
+	bool ok = true;
+
+	size_t remaining() const
+	{
+		return end - pos;
+	}
+
+	bool need(size_t size)
+	{
+		if (remaining() < size)
+		{
+			ok = false;
+		}
+		return ok;
+	}
+
+	uint8_t getUint8()
+	{
+		if (!need(1))
+		{
+			return 0;
+		}
+		return *pos++;
+	}
+
+	uint16_t getUint16()
+	{
+		if (!need(2))
+		{
+			return 0;
+		}
+		uint16_t v = uint16_t(pos[0]) << 8 | pos[1];
+		pos += 2;
+		return v;
+	}
+
+	uint32_t getUint32()
+	{
+		if (!need(4))
+		{
+			return 0;
+		}
+		uint32_t v = uint32_t(pos[0]) << 24 | uint32_t(pos[1]) << 16 | uint32_t(pos[2]) << 8 | pos[3];
+		pos += 4;
+		return v;
+	}
+
+	/// Returns false for a string written as none.
+	bool getString(std::string &str)
+	{
+		uint32_t length = getUint32();
+		str.clear();
+		if (length == SCRIPT_CACHE_NO_STRING || !need(length))
+		{
+			return false;
+		}
+		str.assign((const char *)pos, length);
+		pos += length;
+		return true;
+	}
+
+	/// A malloc'ed copy of the string, or nullptr for none.
+	char *getStrdup()
+	{
+		std::string str;
+		return getString(str) ? strdup(str.c_str()) : nullptr;
+	}
+
+	Sha256 getSha256()
+	{
+		Sha256 sum;
+		sum.setZero();
+		if (need(Sha256::Bytes))
+		{
+			memcpy(sum.bytes, pos, Sha256::Bytes);
+			pos += Sha256::Bytes;
+		}
+		return sum;
+	}
+
+	bool getValue(INTERP_VAL &val)
+	{
+		std::string str;
+
+		val.type = (INTERP_TYPE)getUint32();
+		val.v.oval = nullptr;
+		switch ((unsigned)val.type)
+		{
+		case VAL_STRING:
+			if (!getString(str) || CURSTACKSTR + 1 >= MAXSTACKLEN)
+			{
+				return ok = false;
+			}
+			sstrcpy(STRSTACK[CURSTACKSTR], str.c_str());
+			val.v.sval = STRSTACK[CURSTACKSTR++];
+			return true;
+		case VAL_FUNC_EXTERN:
+			{
+				uint8_t table = getUint8();
+				getString(str);
+				if (table == SCF_INSTINCT)
+				{
+					for (const FUNC_SYMBOL *psFunc = asScrInstinctTab; psFunc && psFunc->pFunc != nullptr; psFunc++)
+					{
+						if (str == psFunc->pIdent)
+						{
+							val.v.pFuncExtern = psFunc->pFunc;
+						}
+					}
+				}
+				else if (table == SCF_CALLBACK)
+				{
+					for (const CALLBACK_SYMBOL *psCallback = asScrCallbackTab; psCallback && psCallback->type != 0; psCallback++)
+					{
+						if (str == psCallback->pIdent)
+						{
+							val.v.pFuncExtern = psCallback->pFunc;
+						}
+					}
+				}
+				return ok = ok && val.v.pFuncExtern != nullptr;
+			}
+		case VAL_OBJ_GETSET:
+			{
+				uint8_t table = getUint8();
+				getString(str);
+				const VAR_SYMBOL *psVars = table == SCF_EXTERNAL_GET || table == SCF_EXTERNAL_SET ? asScrExternalTab : asScrObjectVarTab;
+				for (const VAR_SYMBOL *psVar = psVars; psVar && psVar->pIdent != nullptr; psVar++)
+				{
+					if (str == psVar->pIdent)
+					{
+						val.v.pObjGetSet = table == SCF_EXTERNAL_GET || table == SCF_OBJVAR_GET ? psVar->get : psVar->set;
+					}
+				}
+				return ok = ok && val.v.pObjGetSet != nullptr;
+			}
+		default:
+			if (!scriptTypeIsPointer(val.type))
+			{
+				val.v.ival = getUint32();
+			}
+			return ok;
+		}
+	}
+
+	/// Checks that the file was written by this build, for the same script tables and includes.
+	bool checkHeader(const char *pStamp)
+	{
+		std::string stamp;
+		if (!need(4) || memcmp(pos, "WZsc", 4) != 0)
+		{
+			return ok = false;
+		}
+		pos += 4;
+		if (getUint32() != SCRIPT_CACHE_VERSION || !getString(stamp) || stamp != pStamp
+		    || getSha256() != scriptTableFingerprint())
+		{
+			return ok = false;
+		}
+
+		uint32_t numIncludes = getUint32();
+		for (uint32_t i = 0; ok && i < numIncludes; i++)
+		{
+			std::string include;
+			Sha256 sum;
+			getString(include);
+			Sha256 expected = getSha256();
+			if (!ok || !scriptHashFile(include.c_str(), &sum) || sum != expected)
+			{
+				debug(LOG_WZ, "Included file %s changed", include.c_str());
+				return ok = false;
+			}
+		}
+		return ok;
+	}
+
+	SCRIPT_CODE *getCode()
+	{
+		// Allocate with calloc and fill in counts only once their arrays exist, so scriptFreeCode() can clean up at any point
+		SCRIPT_CODE *psCode = (SCRIPT_CODE *)calloc(1, sizeof(SCRIPT_CODE));
+
+		uint32_t numVals = getUint32();
+		if (!ok || numVals > remaining() / 4)	// Each value takes at least four bytes.
+		{
+			free(psCode);
+			return nullptr;
+		}
+		psCode->pCode = (INTERP_VAL *)malloc(numVals * sizeof(INTERP_VAL));
+		psCode->size = numVals * sizeof(INTERP_VAL);
+		for (uint32_t i = 0; ok && i < numVals; i++)
+		{
+			getValue(psCode->pCode[i]);
+		}
+
+		UWORD numTriggers = getUint16();
+		if (ok && numTriggers > 0)
+		{
+			psCode->pTriggerTab = (UWORD *)malloc(sizeof(UWORD) * (numTriggers + 1));
+			psCode->psTriggerData = (TRIGGER_DATA *)malloc(sizeof(TRIGGER_DATA) * numTriggers);
+			for (unsigned i = 0; i < numTriggers + 1u; i++)
+			{
+				psCode->pTriggerTab[i] = getUint16();
+			}
+			for (unsigned i = 0; i < numTriggers; i++)
+			{
+				psCode->psTriggerData[i].type = (TRIGGER_TYPE)getUint32();
+				psCode->psTriggerData[i].code = getUint16();
+				psCode->psTriggerData[i].time = getUint32();
+			}
+			psCode->numTriggers = numTriggers;
+		}
+
+		UWORD numEvents = getUint16();
+		if (ok)
+		{
+			psCode->pEventTab = (UWORD *)malloc(sizeof(UWORD) * (numEvents + 1));
+			psCode->pEventLinks = (SWORD *)malloc(sizeof(SWORD) * numEvents);
+			psCode->ppsLocalVars = (INTERP_TYPE **)calloc(numEvents, sizeof(INTERP_TYPE *));
+			psCode->numLocalVars = (UDWORD *)calloc(numEvents, sizeof(UDWORD));
+			psCode->numParams = (UDWORD *)calloc(numEvents, sizeof(UDWORD));
+			psCode->numEvents = numEvents;
+			for (unsigned i = 0; i < numEvents + 1u; i++)
+			{
+				psCode->pEventTab[i] = getUint16();
+			}
+			for (unsigned i = 0; i < numEvents; i++)
+			{
+				psCode->pEventLinks[i] = (SWORD)getUint16();
+			}
+			for (unsigned i = 0; ok && i < numEvents; i++)
+			{
+				psCode->numParams[i] = getUint32();
+				uint32_t numLocals = getUint32();
+				if (!ok || numLocals > remaining() / 4)
+				{
+					ok = false;
+					break;
+				}
+				if (numLocals > 0)
+				{
+					psCode->ppsLocalVars[i] = (INTERP_TYPE *)malloc(sizeof(INTERP_TYPE) * numLocals);
+					psCode->numLocalVars[i] = numLocals;
+				}
+				for (unsigned j = 0; j < numLocals; j++)
+				{
+					psCode->ppsLocalVars[i][j] = (INTERP_TYPE)getUint32();
+				}
+			}
+		}
+
+		UWORD numGlobals = getUint16();
+		psCode->numGlobals = numGlobals;
+		if (ok && numGlobals > 0)
+		{
+			psCode->pGlobals = (INTERP_TYPE *)malloc(sizeof(INTERP_TYPE) * numGlobals);
+			for (unsigned i = 0; i < numGlobals; i++)
+			{
+				psCode->pGlobals[i] = (INTERP_TYPE)getUint32();
+			}
+		}
+
+		UWORD numArrays = getUint16();
+		psCode->numArrays = numArrays;
+		psCode->arraySize = getUint32();
+		if (ok && numArrays > 0)
+		{
+			psCode->psArrayInfo = (ARRAY_DATA *)malloc(sizeof(ARRAY_DATA) * numArrays);
+			for (unsigned i = 0; i < numArrays; i++)
+			{
+				ARRAY_DATA &array = psCode->psArrayInfo[i];
+				array.base = getUint32();
+				array.type = (INTERP_TYPE)getUint32();
+				array.dimensions = getUint8();
+				for (unsigned dimension = 0; dimension < VAR_MAX_DIMENSIONS; dimension++)
+				{
+					array.elements[dimension] = getUint8();
+				}
+			}
+		}
+
+		if (getUint8() && ok)
+		{
+			psCode->psVarDebug = (VAR_DEBUG *)calloc(numGlobals, sizeof(VAR_DEBUG));
+			for (unsigned i = 0; i < numGlobals; i++)
+			{
+				psCode->psVarDebug[i].pIdent = getStrdup();
+				psCode->psVarDebug[i].storage = (STORAGE_TYPE)getUint32();
+			}
+		}
+		if (getUint8() && ok)
+		{
+			psCode->psArrayDebug = (ARRAY_DEBUG *)calloc(numArrays, sizeof(ARRAY_DEBUG));
+			for (unsigned i = 0; i < numArrays; i++)
+			{
+				psCode->psArrayDebug[i].pIdent = getStrdup();
+				psCode->psArrayDebug[i].storage = getUint8();
+			}
+		}
+		bool hasDebug = getUint8();
+		UWORD debugEntries = getUint16();
+		if (hasDebug && ok)
+		{
+			psCode->psDebug = (SCRIPT_DEBUG *)calloc(debugEntries, sizeof(SCRIPT_DEBUG));
+			psCode->debugEntries = debugEntries;
+			for (unsigned i = 0; i < debugEntries; i++)
+			{
+				psCode->psDebug[i].offset = getUint32();
+				psCode->psDebug[i].line = getUint32();
+				psCode->psDebug[i].pLabel = getStrdup();
+			}
+		}
+
+		if (!ok || pos != end)
+		{
+			scriptFreeCode(psCode);
+			return nullptr;
+		}
+		return psCode;
+	}
+};
+}
+
+SCRIPT_CODE *scriptLoadCode(const char *pFileName, const char *pStamp)
+{
+	char *pData;
+	UDWORD size;
+	SCRIPT_CODE *psCode = nullptr;
+
+	if (!PHYSFS_exists(pFileName))
+	{
+		return nullptr;
+	}
+	// Only trust files we wrote ourselves, the code is run without any of the compiler's checks
+	const char *pRealDir = PHYSFS_getRealDir(pFileName);
+	const char *pWriteDir = PHYSFS_getWriteDir();
+	if (pRealDir == nullptr || pWriteDir == nullptr || strcmp(pRealDir, pWriteDir) != 0)
+	{
+		debug(LOG_WZ, "Ignoring compiled script %s from %s", pFileName, pRealDir ? pRealDir : "nowhere");
+		return nullptr;
+	}
+	if (!loadFile(pFileName, &pData, &size))
+	{
+		return nullptr;
+	}
+
+	Decoder decoder;
+	decoder.pos = (const uint8_t *)pData;
+	decoder.end = decoder.pos + size;
+	if (decoder.checkHeader(pStamp))
+	{
+		// Strings are added to the string pool as they are decoded, give them back if decoding fails
+		const UDWORD stringPoolTop = CURSTACKSTR;
+		psCode = decoder.getCode();
+		if (psCode == nullptr)
+		{
+			CURSTACKSTR = stringPoolTop;
+		}
+	}
+	if (psCode == nullptr)
+	{
+		debug(LOG_WZ, "Ignoring stale or broken compiled script %s", pFileName);
+	}
+	free(pData);
+	return psCode;
+}
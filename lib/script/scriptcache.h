@@ -0,0 +1,40 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2005-2019  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/** @file
+ *  On-disk cache of compiled scripts, so that the lexer and parser only run when a script changes.
+ *
+ *  Cache files are looked up by the caller, typically under a name derived from a hash of the script
+ *  source. Each file records the stamp it was written with, a fingerprint of the function, variable
+ *  and constant tables the script was compiled against, and the hashes of all files the script
+ *  included. A mismatch in any of them makes the cached copy unusable.
+ */
+
+#ifndef __INCLUDED_LIB_SCRIPT_SCRIPTCACHE_H__
+#define __INCLUDED_LIB_SCRIPT_SCRIPTCACHE_H__
+
+#include "interpreter.h"
+
+/// Loads a script written by scriptSaveCode(). Returns nullptr if the file is missing, broken or stale.
+SCRIPT_CODE *scriptLoadCode(const char *pFileName, const char *pStamp);
+
+/// Writes a script to the cache. Must be called right after scriptCompile() produced psCode, as the
+/// files it included are taken from the lexer. Scripts referring to in-game objects are not written.
+bool scriptSaveCode(const SCRIPT_CODE *psCode, const char *pFileName, const char *pStamp);
+
+#endif // __INCLUDED_LIB_SCRIPT_SCRIPTCACHE_H__
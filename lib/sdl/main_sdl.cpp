@@ -82,6 +82,9 @@ static SDL_GLContext WZglcontext = nullptr;
 
 // The screen that the game window is on.
 int screenIndex = 0;
+
+static bool headlessMode = false;  // No window, no OpenGL context.
+
 // The logical resolution of the game in the game's coordinate system (points).
 unsigned int screenWidth = 0;
 unsigned int screenHeight = 0;
@@ -297,6 +300,16 @@ int wzGetTicks()
 	return SDL_GetTicks();
 }
 
+void wzSetHeadless(bool headless)
+{
+	headlessMode = headless;
+}
+
+bool wzIsHeadless()
+{
+	return headlessMode;
+}
+
 void wzFatalDialog(const char *msg)
 {
 	SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "We have a problem!", msg, nullptr);
@@ -304,6 +317,10 @@ void wzFatalDialog(const char *msg)
 
 void wzScreenFlip()
 {
+	if (headlessMode)
+	{
+		return;
+	}
 	SDL_GL_SwapWindow(WZwindow);
 }
 
@@ -324,6 +341,10 @@ void wzToggleFullscreen()
 
 bool wzIsFullscreen()
 {
+	if (headlessMode)
+	{
+		return false;
+	}
 	assert(WZwindow != nullptr);
 	Uint32 flags = SDL_GetWindowFlags(WZwindow);
 	if ((flags & SDL_WINDOW_FULLSCREEN) || (flags & SDL_WINDOW_FULLSCREEN_DESKTOP))
@@ -335,6 +356,10 @@ bool wzIsFullscreen()
 
 bool wzIsMaximized()
 {
+	if (headlessMode)
+	{
+		return false;
+	}
 	assert(WZwindow != nullptr);
 	Uint32 flags = SDL_GetWindowFlags(WZwindow);
 	if (flags & SDL_WINDOW_MAXIMIZED)
@@ -413,6 +438,11 @@ void wzYieldCurrentThread()
 	SDL_Delay(40);
 }
 
+int wzGetCPUCount()
+{
+	return SDL_GetCPUCount();
+}
+
 WZ_MUTEX *wzMutexCreate()
 {
 	return (WZ_MUTEX *)SDL_CreateMutex();
@@ -1478,6 +1508,20 @@ void wzGetWindowResolution(int *screen, unsigned int *width, unsigned int *heigh
 		*screen = screenIndex;
 	}
 
+	if (headlessMode)
+	{
+		// No window, so pretend the window has the size of the (imaginary) screen.
+		if (width != nullptr)
+		{
+			*width = screenWidth;
+		}
+		if (height != nullptr)
+		{
+			*height = screenHeight;
+		}
+		return;
+	}
+
 	int currentWidth = 0, currentHeight = 0;
 	SDL_GetWindowSize(WZwindow, &currentWidth, &currentHeight);
 	assert(currentWidth >= 0);
@@ -1503,7 +1547,7 @@ bool wzMainScreenSetup(int antialiasing, bool fullscreen, bool vsync, bool highD
 	int height = pie_GetVideoBufferHeight();
 	int bitDepth = pie_GetVideoBufferDepth();
 
-	if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER) != 0)
+	if (SDL_Init((headlessMode ? SDL_INIT_EVENTS : SDL_INIT_VIDEO) | SDL_INIT_TIMER) != 0)
 	{
 		debug(LOG_ERROR, "Error: Could not initialise SDL (%s).", SDL_GetError());
 		return false;
@@ -1516,6 +1560,17 @@ bool wzMainScreenSetup(int antialiasing, bool fullscreen, bool vsync, bool highD
 		return false;
 	}
 
+	if (headlessMode)
+	{
+		// No window or OpenGL context. The user interface is still laid out for the configured resolution.
+		screenWidth = std::max(width, 640);
+		screenHeight = std::max(height, 480);
+		pie_SetVideoBufferWidth(screenWidth);
+		pie_SetVideoBufferHeight(screenHeight);
+		debug(LOG_WZ, "Running headless, without a window");
+		return true;
+	}
+
 #if defined(WZ_OS_MAC)
 	// on macOS, support maximizing to a fullscreen space (modern behavior)
 	if (SDL_SetHint(SDL_HINT_VIDEO_MAC_FULLSCREEN_SPACES, "1") == SDL_FALSE)
@@ -1901,6 +1956,18 @@ bool wzMainScreenSetup(int antialiasing, bool fullscreen, bool vsync, bool highD
 //
 void wzGetWindowToRendererScaleFactor(float *horizScaleFactor, float *vertScaleFactor)
 {
+	if (headlessMode)
+	{
+		if (horizScaleFactor != nullptr)
+		{
+			*horizScaleFactor = current_displayScaleFactor;
+		}
+		if (vertScaleFactor != nullptr)
+		{
+			*vertScaleFactor = current_displayScaleFactor;
+		}
+		return;
+	}
 	assert(WZwindow != nullptr);
 
 	// Obtain the window context's drawable size in pixels
@@ -1975,6 +2042,10 @@ void wzGetGameToRendererScaleFactor(float *horizScaleFactor, float *vertScaleFac
 
 void wzSetWindowIsResizable(bool resizable)
 {
+	if (headlessMode)
+	{
+		return;
+	}
 	assert(WZwindow != nullptr);
 	SDL_bool sdl_resizable = (resizable) ? SDL_TRUE : SDL_FALSE;
 	SDL_SetWindowResizable(WZwindow, sdl_resizable);
@@ -441,34 +441,38 @@ bool sound_QueueSamplePlaying(void)
 	return false;
 }
 
-/** Decodes an opened OggVorbis file into an OpenAL buffer
- *  \param psTrack pointer to object which will contain the final buffer
+/** Decodes an opened OggVorbis file into memory, may be called from any thread
  *  \param PHYSFS_fileHandle file handle given by PhysicsFS to the opened file
- *  \return on success the psTrack pointer, otherwise it will be free'd and a NULL pointer is returned instead
+ *  \return the decoded PCM data, or NULL on failure
  */
-static inline TRACK *sound_DecodeOggVorbisTrack(TRACK *psTrack, PHYSFS_file *PHYSFS_fileHandle)
+static soundDataBuffer *sound_DecodeOggVorbisFile(PHYSFS_file *PHYSFS_fileHandle)
 {
-	ALenum		format;
-	ALuint		buffer;
 	struct OggVorbisDecoderState *decoder;
 	soundDataBuffer	*soundBuffer;
 
-	if (!openal_initialized)
-	{
-		return nullptr;
-	}
-
 	decoder = sound_CreateOggVorbisDecoder(PHYSFS_fileHandle, true);
 	if (decoder == nullptr)
 	{
 		debug(LOG_WARNING, "Failed to open audio file for decoding");
-		free(psTrack);
 		return nullptr;
 	}
 
 	soundBuffer = sound_DecodeOggVorbis(decoder, 0);
 	sound_DestroyOggVorbisDecoder(decoder);
 
+	return soundBuffer;
+}
+
+/** Moves decoded PCM data into an OpenAL buffer
+ *  \param psTrack pointer to object which will contain the final buffer
+ *  \param soundBuffer the decoded data, which is free'd
+ *  \return on success the psTrack pointer, otherwise it will be free'd and a NULL pointer is returned instead
+ */
+static TRACK *sound_BufferTrack(TRACK *psTrack, soundDataBuffer *soundBuffer)
+{
+	ALenum		format;
+	ALuint		buffer;
+
 	if (soundBuffer == nullptr)
 	{
 		free(psTrack);
@@ -505,26 +509,13 @@ static inline TRACK *sound_DecodeOggVorbisTrack(TRACK *psTrack, PHYSFS_file *PHY
 	return psTrack;
 }
 
-//*
-// =======================================================================================================================
-// =======================================================================================================================
-//
-TRACK *sound_LoadTrackFromFile(const char *fileName)
+/** Allocates a track named after the resource being loaded */
+static TRACK *sound_ConstructTrack()
 {
 	TRACK *pTrack;
-	PHYSFS_file *fileHandle;
 	size_t filename_size;
 	char *track_name;
 
-	// Use PhysicsFS to open the file
-	fileHandle = PHYSFS_openRead(fileName);
-	debug(LOG_NEVER, "Reading...[directory: %s] %s", PHYSFS_getRealDir(fileName), fileName);
-	if (fileHandle == nullptr)
-	{
-		debug(LOG_ERROR, "sound_LoadTrackFromFile: PHYSFS_openRead(\"%s\") failed with error: %s\n", fileName, WZ_PHYSFS_getLastError());
-		return nullptr;
-	}
-
 	if (GetLastResourceFilename() == nullptr)
 	{
 		// This is a non fatal error.  We just can't find filename for some reason.
@@ -561,13 +552,63 @@ TRACK *sound_LoadTrackFromFile(const char *fileName)
 	}
 	pTrack->fileName = track_name;
 
-	// Now use sound_ReadTrackFromBuffer to decode the file's contents
-	pTrack = sound_DecodeOggVorbisTrack(pTrack, fileHandle);
+	return pTrack;
+}
+
+//*
+// =======================================================================================================================
+// =======================================================================================================================
+//
+TRACK *sound_LoadTrackFromFile(const char *fileName)
+{
+	PHYSFS_file *fileHandle;
+
+	// Use PhysicsFS to open the file
+	fileHandle = PHYSFS_openRead(fileName);
+	debug(LOG_NEVER, "Reading...[directory: %s] %s", PHYSFS_getRealDir(fileName), fileName);
+	if (fileHandle == nullptr)
+	{
+		debug(LOG_ERROR, "sound_LoadTrackFromFile: PHYSFS_openRead(\"%s\") failed with error: %s\n", fileName, WZ_PHYSFS_getLastError());
+		return nullptr;
+	}
+
+	if (!openal_initialized)
+	{
+		PHYSFS_close(fileHandle);
+		return nullptr;
+	}
+
+	TRACK *pTrack = sound_ConstructTrack();
+	pTrack = sound_BufferTrack(pTrack, sound_DecodeOggVorbisFile(fileHandle));
 
 	PHYSFS_close(fileHandle);
 	return pTrack;
 }
 
+soundDataBuffer *sound_DecodeTrackFile(const char *fileName)
+{
+	if (!openal_initialized)
+	{
+		return nullptr;
+	}
+
+	PHYSFS_file *fileHandle = PHYSFS_openRead(fileName);
+	if (fileHandle == nullptr)
+	{
+		return nullptr;  // Left for sound_LoadTrackFromFile to report.
+	}
+
+	soundDataBuffer *soundBuffer = sound_DecodeOggVorbisFile(fileHandle);
+
+	PHYSFS_close(fileHandle);
+	return soundBuffer;
+}
+
+TRACK *sound_LoadDecodedTrack(soundDataBuffer *soundBuffer)
+{
+	return sound_BufferTrack(sound_ConstructTrack(), soundBuffer);
+}
+
 void sound_FreeTrack(TRACK *psTrack)
 {
 	alDeleteBuffers(1, &psTrack->iBufferName);
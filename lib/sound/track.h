@@ -85,6 +85,8 @@ bool	sound_Init();
 bool	sound_Shutdown();
 
 TRACK 	*sound_LoadTrackFromFile(const char *fileName);
+struct soundDataBuffer *sound_DecodeTrackFile(const char *fileName);  ///< Thread safe, for sound_LoadDecodedTrack on the main thread.
+TRACK	*sound_LoadDecodedTrack(struct soundDataBuffer *soundBuffer);  ///< Takes ownership of soundBuffer.
 unsigned int sound_SetTrackVals(const char *fileName, bool loop, unsigned int volume, unsigned int audibleRadius);
 void	sound_ReleaseTrack(TRACK *psTrack);
 
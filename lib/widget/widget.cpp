@@ -24,6 +24,7 @@
 #include "lib/framework/frame.h"
 #include "lib/framework/string_ext.h"
 #include "lib/framework/utf.h"
+#include "lib/framework/wzapp.h"
 #include "lib/ivis_opengl/textdraw.h"
 #include "lib/ivis_opengl/pieblitfunc.h"
 #include "lib/ivis_opengl/piestate.h"
@@ -955,6 +956,12 @@ void widgDisplayScreen(W_SCREEN *psScreen)
 	sContext.my = mouseY();
 	psScreen->psForm->processCallbacksRecursive(&sContext);
 
+	if (wzIsHeadless())
+	{
+		deleteOldWidgets();
+		return;
+	}
+
 	// Display the widgets.
 	psScreen->psForm->displayRecursive(0, 0);
 
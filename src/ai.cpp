@@ -26,6 +26,8 @@
 
 #include "lib/framework/frame.h"
 
+#include <unordered_map>
+
 #include "action.h"
 #include "cmddroid.h"
 #include "combat.h"
@@ -36,6 +38,7 @@
 #include "projectile.h"
 #include "objmem.h"
 #include "order.h"
+#include "visibility.h"
 
 /* Weights used for target selection code,
  * target distance is used as 'common currency'
@@ -72,6 +75,20 @@
 #define	WEIGHT_CMD_RANK				(WEIGHT_DIST_TILE * 4)			//A single rank is as important as 4 tiles distance
 #define	WEIGHT_CMD_SAME_TARGET		WEIGHT_DIST_TILE				//Don't want this to be too high, since a commander can have many units assigned
 
+/// What targetAttackWeight() needs to know about a target, which does not change while it exists.
+struct TargetInfo
+{
+	BASE_OBJECT *psObj;
+	SDWORD targetTypeBonus;     ///< Sensors/ecm droids, non-military structures get lower priority
+	PROPULSION_TYPE propulsionType;
+	BODY_SIZE bodySize;
+	STRUCT_STRENGTH strength;
+};
+
+/// Possible targets around each region, by region and search radius, found at most once per tick.
+static std::unordered_map<uint64_t, std::vector<TargetInfo>> targetCandidates;
+static unsigned targetCandidatesResetCount = 0;
+
 uint8_t alliances[MAX_PLAYER_SLOTS][MAX_PLAYER_SLOTS];
 
 /// A bitfield of vision sharing in alliances, for quick manipulation of vision information
@@ -160,10 +177,120 @@ bool aiInitialise()
 /* Shutdown the AI system */
 bool aiShutdown()
 {
+	targetCandidates.clear();
 	return true;
 }
 
-/** Search the global list of sensors for a possible target for psObj. */
+static void targetInfoInit(TargetInfo &info, BASE_OBJECT *psTarget)
+{
+	info.psObj = psTarget;
+	info.targetTypeBonus = 0;
+	info.propulsionType = PROPULSION_TYPE_WHEELED;
+	info.bodySize = SIZE_LIGHT;
+	info.strength = STRENGTH_SOFT;
+
+	if (psTarget->type == OBJ_DROID)
+	{
+		DROID *targetDroid = (DROID *)psTarget;
+
+		/* See if this type of a droid should be prioritized */
+		switch (targetDroid->droidType)
+		{
+		case DROID_SENSOR:
+		case DROID_ECM:
+		case DROID_PERSON:
+		case DROID_TRANSPORTER:
+		case DROID_SUPERTRANSPORTER:
+		case DROID_DEFAULT:
+		case DROID_ANY:
+			break;
+
+		case DROID_CYBORG:
+		case DROID_WEAPON:
+		case DROID_CYBORG_SUPER:
+			info.targetTypeBonus = WEIGHT_WEAPON_DROIDS;
+			break;
+
+		case DROID_COMMAND:
+			info.targetTypeBonus = WEIGHT_COMMAND_DROIDS;
+			break;
+
+		case DROID_CONSTRUCT:
+		case DROID_REPAIR:
+		case DROID_CYBORG_CONSTRUCT:
+		case DROID_CYBORG_REPAIR:
+			info.targetTypeBonus = WEIGHT_SERVICE_DROIDS;
+			break;
+		}
+		info.propulsionType = (asPropulsionStats + targetDroid->asBits[COMP_PROPULSION])->propulsionType;
+		info.bodySize = (asBodyStats + targetDroid->asBits[COMP_BODY])->size;
+	}
+	else if (psTarget->type == OBJ_STRUCTURE)
+	{
+		STRUCTURE *targetStructure = (STRUCTURE *)psTarget;
+
+		/* See if this type of a structure should be prioritized */
+		switch (targetStructure->pStructureType->type)
+		{
+		case REF_DEFENSE:
+			info.targetTypeBonus = WEIGHT_WEAPON_STRUCT;
+			break;
+
+		case REF_RESOURCE_EXTRACTOR:
+			info.targetTypeBonus = WEIGHT_DERRICK_STRUCT;
+			break;
+
+		case REF_FACTORY:
+		case REF_CYBORG_FACTORY:
+		case REF_REPAIR_FACILITY:
+			info.targetTypeBonus = WEIGHT_MILITARY_STRUCT;
+			break;
+		default:
+			break;
+		}
+		info.strength = targetStructure->pStructureType->strength;
+	}
+}
+
+/// Finds the same objects as gridStartIterate(x, y, radius), in the same order, but attackers close to each other
+/// share a search of a slightly larger area, and the target info, during a tick.
+static std::vector<TargetInfo const *> const &aiTargetCandidates(int32_t x, int32_t y, int32_t radius)
+{
+	if (targetCandidatesResetCount != gridGetResetCount())
+	{
+		// Objects have moved, been added or removed.
+		targetCandidates.clear();
+		targetCandidatesResetCount = gridGetResetCount();
+	}
+
+	const int32_t tiles = (radius + TILE_UNITS - 1) / TILE_UNITS;  // Similar ranges share the search too.
+	const uint64_t key = (uint64_t)gridRegionKey(x, y) << 16 | (uint16_t)tiles;
+
+	auto it = targetCandidates.find(key);
+	if (it == targetCandidates.end())
+	{
+		GridList const &gridList = gridStartIterateRegion(x, y, tiles * TILE_UNITS);
+
+		it = targetCandidates.emplace(key, std::vector<TargetInfo>(gridList.size())).first;
+		for (size_t i = 0; i < gridList.size(); ++i)
+		{
+			targetInfoInit(it->second[i], gridList[i]);
+		}
+	}
+
+	static std::vector<TargetInfo const *> candidates;
+	candidates.clear();
+	for (TargetInfo const &info : it->second)
+	{
+		if (gridIsFoundByIterate(info.psObj, x, y, radius))
+		{
+			candidates.push_back(&info);
+		}
+	}
+	return candidates;
+}
+
+/** Search the allied sensors for a possible target for psObj. */
 static BASE_OBJECT *aiSearchSensorTargets(BASE_OBJECT *psObj, int weapon_slot, WEAPON_STATS *psWStats, TARGET_ORIGIN *targetOrigin)
 {
 	int		longRange = proj_GetLongRange(psWStats, psObj->player);
@@ -171,79 +298,87 @@ static BASE_OBJECT *aiSearchSensorTargets(BASE_OBJECT *psObj, int weapon_slot, W
 	bool		foundCB = false;
 	int		minDist = psWStats->upgrade[psObj->player].minRange * psWStats->upgrade[psObj->player].minRange;
 	BASE_OBJECT	*psTarget = nullptr;
+	unsigned	targetOrder = 0;
 
 	if (targetOrigin)
 	{
 		*targetOrigin = ORIGIN_UNKNOWN;
 	}
 
-	for (BASE_OBJECT *psSensor = apsSensorList[0]; psSensor; psSensor = psSensor->psNextFunc)
+	// Only allied sensors can tell us what to shoot at.
+	for (unsigned player = 0; player < MAX_PLAYERS; ++player)
 	{
-		BASE_OBJECT	*psTemp = nullptr;
-		bool		isCB = false;
-		bool		isRD = false;
-
-		if (!aiCheckAlliances(psSensor->player, psObj->player))
+		if (!aiCheckAlliances(player, psObj->player))
 		{
 			continue;
 		}
-		else if (psSensor->type == OBJ_DROID)
+		for (SensorRef const &sensor : visSensorsOfPlayer(player))
 		{
-			DROID		*psDroid = (DROID *)psSensor;
+			BASE_OBJECT	*psSensor = sensor.psObj;
+			BASE_OBJECT	*psTemp = nullptr;
+			bool		isCB = false;
+			bool		isRD = false;
 
-			ASSERT_OR_RETURN(nullptr, psDroid->droidType == DROID_SENSOR, "A non-sensor droid in a sensor list is non-sense");
-			// Skip non-observing droids.
-			if (psDroid->action != DACTION_OBSERVE)
+			if (psSensor->type == OBJ_DROID)
 			{
-				continue;
+				DROID		*psDroid = (DROID *)psSensor;
+
+				ASSERT_OR_RETURN(nullptr, psDroid->droidType == DROID_SENSOR, "A non-sensor droid in a sensor list is non-sense");
+				// Skip non-observing droids.
+				if (psDroid->action != DACTION_OBSERVE)
+				{
+					continue;
+				}
+				psTemp = psDroid->psActionTarget[0];
+				isCB = cbSensorDroid(psDroid);
+				isRD = objRadarDetector((BASE_OBJECT *)psDroid);
 			}
-			psTemp = psDroid->psActionTarget[0];
-			isCB = cbSensorDroid(psDroid);
-			isRD = objRadarDetector((BASE_OBJECT *)psDroid);
-		}
-		else if (psSensor->type == OBJ_STRUCTURE)
-		{
-			STRUCTURE	*psCStruct = (STRUCTURE *)psSensor;
+			else if (psSensor->type == OBJ_STRUCTURE)
+			{
+				STRUCTURE	*psCStruct = (STRUCTURE *)psSensor;
 
-			// skip incomplete structures
-			if (psCStruct->status != SS_BUILT)
+				// skip incomplete structures
+				if (psCStruct->status != SS_BUILT)
+				{
+					continue;
+				}
+				psTemp = psCStruct->psTarget[0];
+				isCB = structCBSensor(psCStruct);
+				isRD = objRadarDetector((BASE_OBJECT *)psCStruct);
+			}
+			if (!psTemp || psTemp->died || aiObjectIsProbablyDoomed(psTemp, false) || !validTarget(psObj, psTemp, 0) || aiCheckAlliances(psTemp->player, psObj->player))
 			{
 				continue;
 			}
-			psTemp = psCStruct->psTarget[0];
-			isCB = structCBSensor(psCStruct);
-			isRD = objRadarDetector((BASE_OBJECT *)psCStruct);
-		}
-		if (!psTemp || psTemp->died || aiObjectIsProbablyDoomed(psTemp, false) || !validTarget(psObj, psTemp, 0) || aiCheckAlliances(psTemp->player, psObj->player))
-		{
-			continue;
-		}
-		int distSq = objPosDiffSq(psTemp->pos, psObj->pos);
-		// Need to be in range, prefer closer targets or CB targets
-		if ((isCB > foundCB || (isCB == foundCB && distSq < tarDist)) && distSq > minDist)
-		{
-			if (aiObjHasRange(psObj, psTemp, weapon_slot) && visibleObject(psSensor, psTemp, false))
+			int distSq = objPosDiffSq(psTemp->pos, psObj->pos);
+			// Need to be in range, prefer closer targets or CB targets
+			// Ties go to the sensor first in apsSensorList, as when walking the whole list.
+			if ((isCB > foundCB || (isCB == foundCB && (distSq < tarDist || (distSq == tarDist && psTarget != nullptr && sensor.order < targetOrder)))) && distSq > minDist)
 			{
-				tarDist = distSq;
-				psTarget = psTemp;
-				if (targetOrigin)
-				{
-					*targetOrigin = ORIGIN_SENSOR;
-				}
-
-				if (isCB)
+				if (aiObjHasRange(psObj, psTemp, weapon_slot) && visibleObject(psSensor, psTemp, false))
 				{
+					tarDist = distSq;
+					psTarget = psTemp;
+					targetOrder = sensor.order;
 					if (targetOrigin)
 					{
-						*targetOrigin = ORIGIN_CB_SENSOR;
+						*targetOrigin = ORIGIN_SENSOR;
 					}
-					foundCB = true;  // got CB target, drop everything and shoot!
-				}
-				else if (isRD)
-				{
-					if (targetOrigin)
+
+					if (isCB)
+					{
+						if (targetOrigin)
+						{
+							*targetOrigin = ORIGIN_CB_SENSOR;
+						}
+						foundCB = true;  // got CB target, drop everything and shoot!
+					}
+					else if (isRD)
 					{
-						*targetOrigin = ORIGIN_RADAR_DETECTOR;
+						if (targetOrigin)
+						{
+							*targetOrigin = ORIGIN_RADAR_DETECTOR;
+						}
 					}
 				}
 			}
@@ -252,10 +387,10 @@ static BASE_OBJECT *aiSearchSensorTargets(BASE_OBJECT *psObj, int weapon_slot, W
 	return psTarget;
 }
 
-/* Calculates attack priority for a certain target */
-static SDWORD targetAttackWeight(BASE_OBJECT *psTarget, BASE_OBJECT *psAttacker, SDWORD weapon_slot)
+/* Calculates attack priority for a certain target, info is worked out if not given */
+static SDWORD targetAttackWeight(BASE_OBJECT *psTarget, BASE_OBJECT *psAttacker, SDWORD weapon_slot, TargetInfo const *info = nullptr)
 {
-	SDWORD			targetTypeBonus = 0, damageRatio = 0, attackWeight = 0, noTarget = -1;
+	SDWORD			damageRatio = 0, attackWeight = 0, noTarget = -1;
 	UDWORD			weaponSlot;
 	DROID			*targetDroid = nullptr, *psAttackerDroid = nullptr, *psGroupDroid, *psDroid;
 	STRUCTURE		*targetStructure = nullptr;
@@ -269,7 +404,13 @@ static SDWORD targetAttackWeight(BASE_OBJECT *psTarget, BASE_OBJECT *psAttacker,
 	}
 	ASSERT(psTarget != psAttacker, "targetAttackWeight: Wanted to evaluate the worth of attacking ourselves...");
 
-	targetTypeBonus = 0;			//Sensors/ecm droids, non-military structures get lower priority
+	TargetInfo localInfo;
+	if (info == nullptr)
+	{
+		targetInfoInit(localInfo, psTarget);
+		info = &localInfo;
+	}
+	ASSERT(info->psObj == psTarget, "Target info belongs to a different object");
 
 	/* Get attacker weapon effect */
 	if (psAttacker->type == OBJ_DROID)
@@ -372,43 +513,13 @@ static SDWORD targetAttackWeight(BASE_OBJECT *psTarget, BASE_OBJECT *psAttacker,
 		}
 		assert(targetDroid->originalBody != 0); // Assert later so we get the info from above
 
-		/* See if this type of a droid should be prioritized */
-		switch (targetDroid->droidType)
-		{
-		case DROID_SENSOR:
-		case DROID_ECM:
-		case DROID_PERSON:
-		case DROID_TRANSPORTER:
-		case DROID_SUPERTRANSPORTER:
-		case DROID_DEFAULT:
-		case DROID_ANY:
-			break;
-
-		case DROID_CYBORG:
-		case DROID_WEAPON:
-		case DROID_CYBORG_SUPER:
-			targetTypeBonus = WEIGHT_WEAPON_DROIDS;
-			break;
-
-		case DROID_COMMAND:
-			targetTypeBonus = WEIGHT_COMMAND_DROIDS;
-			break;
-
-		case DROID_CONSTRUCT:
-		case DROID_REPAIR:
-		case DROID_CYBORG_CONSTRUCT:
-		case DROID_CYBORG_REPAIR:
-			targetTypeBonus = WEIGHT_SERVICE_DROIDS;
-			break;
-		}
-
 		/* Now calculate the overall weight */
-		attackWeight = asWeaponModifier[weaponEffect][(asPropulsionStats + targetDroid->asBits[COMP_PROPULSION])->propulsionType] // Our weapon's effect against target
-		               + asWeaponModifierBody[weaponEffect][(asBodyStats + targetDroid->asBits[COMP_BODY])->size]
+		attackWeight = asWeaponModifier[weaponEffect][info->propulsionType] // Our weapon's effect against target
+		               + asWeaponModifierBody[weaponEffect][info->bodySize]
 		               + WEIGHT_DIST_TILE_DROID * objSensorRange(psAttacker) / TILE_UNITS
 		               - WEIGHT_DIST_TILE_DROID * dist / TILE_UNITS // farther droids are less attractive
 		               + WEIGHT_HEALTH_DROID * damageRatio / 100 // we prefer damaged droids
-		               + targetTypeBonus; // some droid types have higher priority
+		               + info->targetTypeBonus; // some droid types have higher priority
 
 		/* If attacking with EMP try to avoid targets that were already "EMPed" */
 		if (bEmpWeap &&
@@ -425,32 +536,12 @@ static SDWORD targetAttackWeight(BASE_OBJECT *psTarget, BASE_OBJECT *psAttacker,
 		/* Calculate damage this target suffered */
 		damageRatio = 100 - 100 * targetStructure->body / structureBody(targetStructure);
 
-		/* See if this type of a structure should be prioritized */
-		switch (targetStructure->pStructureType->type)
-		{
-		case REF_DEFENSE:
-			targetTypeBonus = WEIGHT_WEAPON_STRUCT;
-			break;
-
-		case REF_RESOURCE_EXTRACTOR:
-			targetTypeBonus = WEIGHT_DERRICK_STRUCT;
-			break;
-
-		case REF_FACTORY:
-		case REF_CYBORG_FACTORY:
-		case REF_REPAIR_FACILITY:
-			targetTypeBonus = WEIGHT_MILITARY_STRUCT;
-			break;
-		default:
-			break;
-		}
-
 		/* Now calculate the overall weight */
-		attackWeight = asStructStrengthModifier[weaponEffect][targetStructure->pStructureType->strength] // Our weapon's effect against target
+		attackWeight = asStructStrengthModifier[weaponEffect][info->strength] // Our weapon's effect against target
 		               + WEIGHT_DIST_TILE_STRUCT * objSensorRange(psAttacker) / TILE_UNITS
 		               - WEIGHT_DIST_TILE_STRUCT * dist / TILE_UNITS // farther structs are less attractive
 		               + WEIGHT_HEALTH_STRUCT * damageRatio / 100 // we prefer damaged structures
-		               + targetTypeBonus; // some structure types have higher priority
+		               + info->targetTypeBonus; // some structure types have higher priority
 
 		/* Go for unfinished structures only if nothing else found (same for non-visible structures) */
 		if (targetStructure->status != SS_BUILT)		//a decoy?
@@ -565,12 +656,11 @@ int aiBestNearestTarget(DROID *psDroid, BASE_OBJECT **ppsObj, int weapon_slot, i
 	// Range was previously 9*TILE_UNITS. Increasing this doesn't seem to help much, though. Not sure why.
 	int droidRange = std::min(aiDroidRange(psDroid, weapon_slot) + extraRange, objSensorRange(psDroid) + 6 * TILE_UNITS);
 
-	static GridList gridList;  // static to avoid allocations.
-	gridList = gridStartIterate(psDroid->pos.x, psDroid->pos.y, droidRange);
-	for (GridIterator gi = gridList.begin(); gi != gridList.end(); ++gi)
+	std::vector<TargetInfo const *> const &candidates = aiTargetCandidates(psDroid->pos.x, psDroid->pos.y, droidRange);
+	for (TargetInfo const *candidate : candidates)
 	{
 		BASE_OBJECT *friendlyObj = nullptr;
-		BASE_OBJECT *targetInQuestion = *gi;
+		BASE_OBJECT *targetInQuestion = candidate->psObj;
 
 		/* This is a friendly unit, check if we can reuse its target */
 		if (aiCheckAlliances(targetInQuestion->player, psDroid->player))
@@ -674,7 +764,7 @@ int aiBestNearestTarget(DROID *psDroid, BASE_OBJECT **ppsObj, int weapon_slot, i
 			/* Check if our weapon is most effective against this object */
 			if (psTarget != nullptr && psTarget == targetInQuestion)		//was assigned?
 			{
-				int newMod = targetAttackWeight(psTarget, (BASE_OBJECT *)psDroid, weapon_slot);
+				int newMod = targetAttackWeight(psTarget, (BASE_OBJECT *)psDroid, weapon_slot, friendlyObj == nullptr ? candidate : nullptr);
 
 				/* Remember this one if it's our best target so far */
 				if (newMod >= 0 && (newMod > bestMod || bestTarget == nullptr))
@@ -910,18 +1000,17 @@ bool aiChooseTarget(BASE_OBJECT *psObj, BASE_OBJECT **ppsTarget, int weapon_slot
 				srange = objSensorRange(psObj);
 			}
 
-			static GridList gridList;  // static to avoid allocations.
-			gridList = gridStartIterate(psObj->pos.x, psObj->pos.y, srange);
-			for (GridIterator gi = gridList.begin(); gi != gridList.end(); ++gi)
+			std::vector<TargetInfo const *> const &candidates = aiTargetCandidates(psObj->pos.x, psObj->pos.y, srange);
+			for (TargetInfo const *candidate : candidates)
 			{
-				BASE_OBJECT *psCurr = *gi;
+				BASE_OBJECT *psCurr = candidate->psObj;
 				/* Check that it is a valid target */
 				if (psCurr->type != OBJ_FEATURE && !psCurr->died
 				    && !aiCheckAlliances(psCurr->player, psObj->player)
 				    && validTarget(psObj, psCurr, weapon_slot) && psCurr->visible[psObj->player] == UBYTE_MAX
 				    && aiStructHasRange((STRUCTURE *)psObj, psCurr, weapon_slot))
 				{
-					int newTargetValue = targetAttackWeight(psCurr, psObj, weapon_slot);
+					int newTargetValue = targetAttackWeight(psCurr, psObj, weapon_slot, candidate);
 					// See if in sensor range and visible
 					int distSq = objPosDiffSq(psCurr->pos, psObj->pos);
 					if (newTargetValue < targetValue || (newTargetValue == targetValue && distSq >= tarDist))
@@ -35,14 +35,23 @@
  *    is continued until the new source is reached.  If the new source is  not reached,
  *    the droid is  on a  different island than the previous droid,  and pathfinding is
  *    restarted from the first step.
+ *  * Optionally, long routes without a cached Context are first planned on an abstract
+ *    graph of the entrances between 16x16 tile clusters (as in HPA*), and each step of
+ *    the abstract route is then refined with A*. The abstract graph is only recalculated
+ *    for clusters whose blocking tiles changed since it was last used.
  *  Up to 30 pathfinding maps from A* are cached, in a LRU list. The PathNode heap con-
  *  tains the  priority-heap-sorted  nodes which are to be explored.  The path back  is
  *  stored in the PathExploredTile 2D array of tiles.
+ *  Several path threads share the cache. Jobs take turns, in the order they were queued,
+ *  to pick their Context, and only search  in it once their turn has passed. A job has
+ *  to wait for an earlier job still searching in a Context it needs.
  */
 
 #ifndef WZ_TESTING
 #include "lib/framework/frame.h"
 
+#include "lib/framework/wzapp.h"
+
 #include "astar.h"
 #include "map.h"
 #endif
@@ -51,6 +60,9 @@
 #include <vector>
 #include <algorithm>
 #include <memory>
+#include <queue>
+#include <atomic>
+#include <unordered_map>
 
 #include "lib/netplay/netplay.h"
 
@@ -108,6 +120,43 @@ struct PathExploredTile
 	bool     visited;
 };
 
+/// Side length of the clusters used by the hierarchical pathfinding layer, in tiles.
+#define HPA_CLUSTER_SIZE 16
+
+/// Two adjacent nonblocking tiles on either side of a cluster border.
+struct PathEntrance
+{
+	PathCoord a, b;                 ///< a is in the cluster to the left/top, b in the cluster to the right/bottom.
+};
+
+/// Entrance tiles of a cluster, and the shortest distances between them when staying within the cluster.
+struct PathCluster
+{
+	std::vector<PathCoord> nodes;                 ///< Entrance tiles in this cluster.
+	std::vector<std::vector<PathCoord>> partners; ///< For each node, the adjacent entrance tiles in neighbouring clusters.
+	std::vector<unsigned> dist;                   ///< nodes.size()² matrix of distances, UINT32_MAX if not connected within the cluster.
+};
+
+/** Abstract graph of cluster entrances, used to plan long paths before refining them with A*.
+ *
+ *  Built from a PathBlockingMap, and updated from the previous hierarchy of the same type by only
+ *  recalculating the clusters whose blocking tiles changed. Never modified once shared with path threads.
+ */
+struct PathHierarchy
+{
+	int clusterIndex(PathCoord p) const
+	{
+		return p.x / HPA_CLUSTER_SIZE + p.y / HPA_CLUSTER_SIZE * clustersX;
+	}
+
+	int width = 0, height = 0;
+	int clustersX = 0, clustersY = 0;
+	std::vector<bool> map;                              ///< The blocking map this hierarchy was built from.
+	std::vector<std::vector<PathEntrance>> vBorders;    ///< Entrances between cluster (x, y) and (x + 1, y).
+	std::vector<std::vector<PathEntrance>> hBorders;    ///< Entrances between cluster (x, y) and (x, y + 1).
+	std::vector<PathCluster> clusters;
+};
+
 struct PathBlockingType
 {
 	uint32_t gameTime;
@@ -129,6 +178,7 @@ struct PathBlockingMap
 	PathBlockingType type;
 	std::vector<bool> map;
 	std::vector<bool> dangerMap;	// using threatBits
+	std::shared_ptr<PathHierarchy const> hierarchy;  ///< Only set if hierarchical pathfinding is enabled, and there is no danger map.
 };
 
 struct PathNonblockingArea
@@ -154,28 +204,28 @@ struct PathNonblockingArea
 	int16_t y2 = 0;
 };
 
+static inline bool fpathIsBlocked(PathBlockingMap const &blockingMap, PathNonblockingArea const &dstIgnore, int x, int y)
+{
+	if (dstIgnore.isNonblocking(x, y))
+	{
+		return false;  // The path is actually blocked here by a structure, but ignore it since it's where we want to go (or where we came from).
+	}
+	// Not sure whether the out-of-bounds check is needed, can only happen if pathfinding is started on a blocking tile (or off the map).
+	return x < 0 || y < 0 || x >= mapWidth || y >= mapHeight || blockingMap.map[x + y * mapWidth];
+}
+
 // Data structures used for pathfinding, can contain cached results.
 struct PathfindContext
 {
 	PathfindContext() : myGameTime(0), iteration(0), blockingMap(nullptr) {}
 	bool isBlocked(int x, int y) const
 	{
-		if (dstIgnore.isNonblocking(x, y))
-		{
-			return false;  // The path is actually blocked here by a structure, but ignore it since it's where we want to go (or where we came from).
-		}
-		// Not sure whether the out-of-bounds check is needed, can only happen if pathfinding is started on a blocking tile (or off the map).
-		return x < 0 || y < 0 || x >= mapWidth || y >= mapHeight || blockingMap->map[x + y * mapWidth];
+		return fpathIsBlocked(*blockingMap, dstIgnore, x, y);
 	}
 	bool isDangerous(int x, int y) const
 	{
 		return !blockingMap->dangerMap.empty() && blockingMap->dangerMap[x + y * mapWidth];
 	}
-	bool matches(std::shared_ptr<PathBlockingMap> &blockingMap_, PathCoord tileS_, PathNonblockingArea dstIgnore_) const
-	{
-		// Must check myGameTime == blockingMap_->type.gameTime, otherwise blockingMap could be a deleted pointer which coincidentally compares equal to the valid pointer blockingMap_.
-		return myGameTime == blockingMap_->type.gameTime && blockingMap == blockingMap_ && tileS == tileS_ && dstIgnore == dstIgnore_;
-	}
 	void assign(std::shared_ptr<PathBlockingMap> &blockingMap_, PathCoord tileS_, PathNonblockingArea dstIgnore_)
 	{
 		blockingMap = blockingMap_;
@@ -210,11 +260,66 @@ struct PathfindContext
 	PathNonblockingArea dstIgnore;      ///< Area of structure at destination which should be considered nonblocking.
 };
 
+/// A cached context, and what it will have been searching for once the job using it is done.
+struct PathContextSlot
+{
+	bool matches(std::shared_ptr<PathBlockingMap> &blockingMap_, PathCoord tileS_, PathNonblockingArea dstIgnore_) const
+	{
+		// Must check myGameTime == blockingMap_->type.gameTime, otherwise blockingMap could be a deleted pointer which coincidentally compares equal to the valid pointer blockingMap_.
+		return myGameTime == blockingMap_->type.gameTime && blockingMap == blockingMap_ && tileS == tileS_ && dstIgnore == dstIgnore_;
+	}
+
+	PathfindContext context;              ///< Only used by the job holding the turn, or by the job which set busy.
+	uint32_t        myGameTime = 0;
+	std::shared_ptr<PathBlockingMap> blockingMap;
+	PathCoord       tileS;
+	PathNonblockingArea dstIgnore;
+	bool            busy = false;         ///< A job which no longer holds the turn is still searching in context.
+};
+
 /// Last recently used list of contexts.
-static std::list<PathfindContext> fpathContexts;
+static std::list<PathContextSlot> fpathContexts;
+
+/// A finished route, which can be reused by droids going to the same destination from the same cluster, if they start on the route.
+struct PathRouteCacheEntry
+{
+	bool matches(PATHJOB const *psJob, int startCluster) const
+	{
+		// Must check gameTime, for the same reason as PathContextSlot::matches.
+		return myGameTime == psJob->blockingMap->type.gameTime && blockingMap == psJob->blockingMap && this->startCluster == startCluster
+		       && tileDest == PathCoord(map_coord(psJob->destX), map_coord(psJob->destY)) && dstIgnore == PathNonblockingArea(psJob->dstStructure);
+	}
+
+	uint32_t        myGameTime;
+	std::shared_ptr<PathBlockingMap> blockingMap;
+	int             startCluster;         ///< Cluster (of HPA_CLUSTER_SIZE tiles) containing the start of the route.
+	PathCoord       tileDest;
+	PathNonblockingArea dstIgnore;
+	bool            pending;              ///< The job which added the entry is still searching for the route.
+	ASR_RETVAL      retval;
+	std::vector<Vector2i> path;           ///< The route, which has a point on every tile it passes. Empty if none was found.
+};
+
+/// Recently finished routes, and routes still being searched for, last recently used first. Entries are added when a job takes its
+/// turn, so that which entries are in the list does not depend on when the jobs finish.
+static std::list<std::shared_ptr<PathRouteCacheEntry>> fpathRouteCache;
+/// Number of routes taken from fpathRouteCache or traced back through the explored region of a cached context, and of routes searched for.
+static std::atomic<unsigned> fpathRouteCacheHits(0), fpathRouteCacheMisses(0);
+
+/// Scratch context for refining hierarchical paths, only used by the job holding the turn.
+static PathfindContext fpathRefineContext;
+
+/// Protects the caches above, apart from the contexts themselves, and the turn.
+static wz::mutex fpathCacheMutex;
+/// Sequence number of the job whose turn it is to use the caches.
+static uint32_t fpathCacheTurn = 0;
+/// Semaphores of the path threads waiting in fpathCacheWait().
+static std::vector<WZ_SEMAPHORE *> fpathCacheWaiters;
 
 /// Lists of blocking maps from current tick.
 static std::vector<std::shared_ptr<PathBlockingMap>> fpathBlockingMaps;
+/// Latest hierarchy for each blocking type, kept between ticks so that only changed clusters need to be recalculated.
+static std::vector<std::pair<PathBlockingType, std::shared_ptr<PathHierarchy const>>> fpathHierarchies;
 /// Game time for all blocking maps in fpathBlockingMaps.
 static uint32_t fpathCurrentGameTime;
 
@@ -235,7 +340,13 @@ static const Vector2i aDirOffset[] =
 void fpathHardTableReset()
 {
 	fpathContexts.clear();
+	fpathRefineContext = PathfindContext();
+	fpathRouteCache.clear();
+	fpathCacheTurn = 0;
+	fpathRouteCacheHits = 0;
+	fpathRouteCacheMisses = 0;
 	fpathBlockingMaps.clear();
+	fpathHierarchies.clear();
 }
 
 /** Get the nearest entry in the open list
@@ -432,6 +543,39 @@ static PathCoord fpathAStarExplore(PathfindContext &context, PathCoord tileF)
 	return nearestCoord;
 }
 
+/// Appends the route from endCoord back to context.tileS to path, in world coordinates.
+static bool fpathAStarWalkBack(PathfindContext &context, PathCoord endCoord, std::vector<Vector2i> &path)
+{
+	size_t length = 0;
+	Vector2i newP(0, 0);
+	for (Vector2i p(world_coord(endCoord.x) + TILE_UNITS / 2, world_coord(endCoord.y) + TILE_UNITS / 2); true; p = newP)
+	{
+		ASSERT_OR_RETURN(false, worldOnMap(p.x, p.y), "Assigned XY coordinates (%d, %d) not on map!", (int)p.x, (int)p.y);
+		ASSERT_OR_RETURN(false, length++ < (unsigned)mapWidth * mapHeight, "Pathfinding got in a loop.");
+
+		path.push_back(p);
+
+		PathExploredTile &tile = context.map[map_coord(p.x) + map_coord(p.y) * mapWidth];
+		newP = p - Vector2i(tile.dx, tile.dy) * (TILE_UNITS / 64);
+		Vector2i mapP = map_coord(newP);
+		int xSide = newP.x - world_coord(mapP.x) > TILE_UNITS / 2 ? 1 : -1; // 1 if newP is on right-hand side of the tile, or -1 if newP is on the left-hand side of the tile.
+		int ySide = newP.y - world_coord(mapP.y) > TILE_UNITS / 2 ? 1 : -1; // 1 if newP is on bottom side of the tile, or -1 if newP is on the top side of the tile.
+		if (context.isBlocked(mapP.x + xSide, mapP.y))
+		{
+			newP.x = world_coord(mapP.x) + TILE_UNITS / 2; // Point too close to a blocking tile on left or right side, so move the point to the middle.
+		}
+		if (context.isBlocked(mapP.x, mapP.y + ySide))
+		{
+			newP.y = world_coord(mapP.y) + TILE_UNITS / 2; // Point too close to a blocking tile on rop or bottom side, so move the point to the middle.
+		}
+		if (map_coord(p) == Vector2i(context.tileS.x, context.tileS.y) || p == newP)
+		{
+			break;  // We stopped moving, because we reached the destination or the closest reachable tile to context.tileS. Give up now.
+		}
+	}
+	return true;
+}
+
 static void fpathInitContext(PathfindContext &context, std::shared_ptr<PathBlockingMap> &blockingMap, PathCoord tileS, PathCoord tileRealS, PathCoord tileF, PathNonblockingArea dstIgnore)
 {
 	context.assign(blockingMap, tileS, dstIgnore);
@@ -441,50 +585,520 @@ static void fpathInitContext(PathfindContext &context, std::shared_ptr<PathBlock
 	ASSERT(!context.nodes.empty(), "fpathNewNode failed to add node.");
 }
 
-ASR_RETVAL fpathAStarRoute(MOVE_CONTROL *psMove, PATHJOB *psJob)
+static inline bool fpathHierarchyBlocked(PathHierarchy const &h, int x, int y)
 {
-	ASR_RETVAL      retval = ASR_OK;
+	return x < 0 || y < 0 || x >= h.width || y >= h.height || h.map[x + y * h.width];
+}
 
-	bool            mustReverse = true;
+/// Index of a tile within its cluster.
+static inline int fpathClusterTile(PathCoord p)
+{
+	return p.x % HPA_CLUSTER_SIZE + p.y % HPA_CLUSTER_SIZE * HPA_CLUSTER_SIZE;
+}
+
+/// Calculates the shortest distances from start to all tiles of the cluster containing start, without leaving the cluster.
+static void fpathClusterDistances(PathHierarchy const &h, PathCoord start, PathNonblockingArea const &ignore, std::vector<unsigned> &dist)
+{
+	const int x0 = start.x - start.x % HPA_CLUSTER_SIZE, x1 = std::min(x0 + HPA_CLUSTER_SIZE, h.width);
+	const int y0 = start.y - start.y % HPA_CLUSTER_SIZE, y1 = std::min(y0 + HPA_CLUSTER_SIZE, h.height);
+	auto isBlocked = [&](int x, int y) {
+		if (ignore.isNonblocking(x, y))
+		{
+			return false;
+		}
+		return x < x0 || y < y0 || x >= x1 || y >= y1 || fpathHierarchyBlocked(h, x, y);
+	};
+
+	typedef std::pair<unsigned, int> Node;  // Distance, tile index within cluster.
+	std::priority_queue<Node, std::vector<Node>, std::greater<Node>> nodes;
+	dist.assign(HPA_CLUSTER_SIZE * HPA_CLUSTER_SIZE, UINT32_MAX);
+	dist[fpathClusterTile(start)] = 0;
+	nodes.push(Node(0, fpathClusterTile(start)));
+	while (!nodes.empty())
+	{
+		Node node = nodes.top();
+		nodes.pop();
+		if (node.first != dist[node.second])
+		{
+			continue;  // Already found a shorter way here.
+		}
+		const int px = x0 + node.second % HPA_CLUSTER_SIZE, py = y0 + node.second / HPA_CLUSTER_SIZE;
+		for (unsigned dir = 0; dir < ARRAY_SIZE(aDirOffset); ++dir)
+		{
+			const int x = px + aDirOffset[dir].x, y = py + aDirOffset[dir].y;
+			if (dir % 2 != 0 && !ignore.isNonblocking(px, py) && !ignore.isNonblocking(x, y))
+			{
+				// We cannot cut corners, same as fpathAStarExplore.
+				if (isBlocked(px + aDirOffset[(dir + 1) % 8].x, py + aDirOffset[(dir + 1) % 8].y) ||
+				    isBlocked(px + aDirOffset[(dir + 7) % 8].x, py + aDirOffset[(dir + 7) % 8].y))
+				{
+					continue;
+				}
+			}
+			if (isBlocked(x, y) || x < x0 || y < y0 || x >= x1 || y >= y1)
+			{
+				continue;
+			}
+			const unsigned newDist = node.first + (dir % 2 != 0 ? 198 : 140);
+			const int tile = (x - x0) + (y - y0) * HPA_CLUSTER_SIZE;
+			if (newDist < dist[tile])
+			{
+				dist[tile] = newDist;
+				nodes.push(Node(newDist, tile));
+			}
+		}
+	}
+}
+
+/// Finds the entrances on the border between cluster (cx, cy) and the cluster to the right (if vertical) or below it.
+static void fpathBuildBorder(PathHierarchy &h, int cx, int cy, bool vertical)
+{
+	std::vector<PathEntrance> &entrances = (vertical ? h.vBorders : h.hBorders)[cx + cy * h.clustersX];
+	entrances.clear();
+
+	const int begin = (vertical ? cy : cx) * HPA_CLUSTER_SIZE;
+	const int end = std::min(begin + HPA_CLUSTER_SIZE, vertical ? h.height : h.width);
+	auto entrance = [&](int i) {
+		PathEntrance e;
+		e.a = vertical ? PathCoord((cx + 1) * HPA_CLUSTER_SIZE - 1, i) : PathCoord(i, (cy + 1) * HPA_CLUSTER_SIZE - 1);
+		e.b = vertical ? PathCoord(e.a.x + 1, e.a.y) : PathCoord(e.a.x, e.a.y + 1);
+		return e;
+	};
+
+	// Each run of passable tile pairs gets an entrance in the middle, or one at each end if the run is long.
+	int runStart = -1;
+	for (int i = begin; i <= end; ++i)
+	{
+		if (i < end)
+		{
+			PathEntrance e = entrance(i);
+			if (!fpathHierarchyBlocked(h, e.a.x, e.a.y) && !fpathHierarchyBlocked(h, e.b.x, e.b.y))
+			{
+				if (runStart < 0)
+				{
+					runStart = i;
+				}
+				continue;
+			}
+		}
+		if (runStart < 0)
+		{
+			continue;
+		}
+		const int runEnd = i - 1;
+		if (runEnd - runStart < 6)
+		{
+			entrances.push_back(entrance((runStart + runEnd) / 2));
+		}
+		else
+		{
+			entrances.push_back(entrance(runStart));
+			entrances.push_back(entrance(runEnd));
+		}
+		runStart = -1;
+	}
+}
+
+/// Collects the entrance tiles of cluster (cx, cy) from its borders, and calculates the distances between them.
+static void fpathBuildCluster(PathHierarchy &h, int cx, int cy)
+{
+	PathCluster &cluster = h.clusters[cx + cy * h.clustersX];
+	cluster = PathCluster();
+
+	auto addNode = [&cluster](PathCoord node, PathCoord partner) {
+		size_t i = std::find(cluster.nodes.begin(), cluster.nodes.end(), node) - cluster.nodes.begin();
+		if (i == cluster.nodes.size())
+		{
+			cluster.nodes.push_back(node);
+			cluster.partners.emplace_back();
+		}
+		cluster.partners[i].push_back(partner);
+	};
+	if (cx > 0)
+	{
+		for (auto const &e : h.vBorders[(cx - 1) + cy * h.clustersX])
+		{
+			addNode(e.b, e.a);
+		}
+	}
+	if (cx < h.clustersX - 1)
+	{
+		for (auto const &e : h.vBorders[cx + cy * h.clustersX])
+		{
+			addNode(e.a, e.b);
+		}
+	}
+	if (cy > 0)
+	{
+		for (auto const &e : h.hBorders[cx + (cy - 1) * h.clustersX])
+		{
+			addNode(e.b, e.a);
+		}
+	}
+	if (cy < h.clustersY - 1)
+	{
+		for (auto const &e : h.hBorders[cx + cy * h.clustersX])
+		{
+			addNode(e.a, e.b);
+		}
+	}
+
+	const size_t n = cluster.nodes.size();
+	cluster.dist.assign(n * n, UINT32_MAX);
+	std::vector<unsigned> dist;
+	for (size_t i = 0; i < n; ++i)
+	{
+		fpathClusterDistances(h, cluster.nodes[i], PathNonblockingArea(), dist);
+		for (size_t j = 0; j < n; ++j)
+		{
+			cluster.dist[i * n + j] = dist[fpathClusterTile(cluster.nodes[j])];
+		}
+	}
+}
+
+/// Returns the hierarchy for the given blocking map, reusing the clusters of the previous hierarchy of the same type which did not change.
+static std::shared_ptr<PathHierarchy const> fpathUpdateHierarchy(PathBlockingType const &type, std::vector<bool> const &map)
+{
+	auto i = std::find_if(fpathHierarchies.begin(), fpathHierarchies.end(), [&](std::pair<PathBlockingType, std::shared_ptr<PathHierarchy const>> const &h) {
+		return fpathIsEquivalentBlocking(h.first.propulsion, h.first.owner, h.first.moveType, type.propulsion, type.owner, type.moveType);
+	});
+	std::shared_ptr<PathHierarchy const> old;
+	if (i != fpathHierarchies.end() && i->second->width == mapWidth && i->second->height == mapHeight)
+	{
+		old = i->second;
+		if (old->map == map)
+		{
+			return old;  // Nothing changed since last time.
+		}
+	}
+
+	std::shared_ptr<PathHierarchy> h = old != nullptr ? std::make_shared<PathHierarchy>(*old) : std::make_shared<PathHierarchy>();
+	h->width = mapWidth;
+	h->height = mapHeight;
+	h->clustersX = (mapWidth + HPA_CLUSTER_SIZE - 1) / HPA_CLUSTER_SIZE;
+	h->clustersY = (mapHeight + HPA_CLUSTER_SIZE - 1) / HPA_CLUSTER_SIZE;
+	h->map = map;
+	const int numClusters = h->clustersX * h->clustersY;
+
+	// Find which clusters contain tiles which changed.
+	std::vector<bool> dirty(numClusters, old == nullptr);
+	if (old != nullptr)
+	{
+		for (int y = 0; y < mapHeight; ++y)
+			for (int x = 0; x < mapWidth; ++x)
+			{
+				if (map[x + y * mapWidth] != old->map[x + y * mapWidth])
+				{
+					dirty[h->clusterIndex(PathCoord(x, y))] = true;
+				}
+			}
+	}
+	else
+	{
+		h->vBorders.resize(numClusters);
+		h->hBorders.resize(numClusters);
+		h->clusters.resize(numClusters);
+	}
+
+	// Recalculate the borders of changed clusters, and then all clusters next to those borders.
+	std::vector<bool> vDone(numClusters, false), hDone(numClusters, false), rebuild(numClusters, false);
+	auto border = [&](int cx, int cy, bool vertical) {
+		std::vector<bool> &done = vertical ? vDone : hDone;
+		if (cx < 0 || cy < 0 || (vertical && cx >= h->clustersX - 1) || (!vertical && cy >= h->clustersY - 1) || done[cx + cy * h->clustersX])
+		{
+			return;
+		}
+		done[cx + cy * h->clustersX] = true;
+		fpathBuildBorder(*h, cx, cy, vertical);
+		rebuild[cx + cy * h->clustersX] = true;
+		rebuild[(cx + vertical) + (cy + !vertical) * h->clustersX] = true;
+	};
+	for (int cy = 0; cy < h->clustersY; ++cy)
+		for (int cx = 0; cx < h->clustersX; ++cx)
+		{
+			if (dirty[cx + cy * h->clustersX])
+			{
+				border(cx - 1, cy, true);
+				border(cx, cy, true);
+				border(cx, cy - 1, false);
+				border(cx, cy, false);
+				rebuild[cx + cy * h->clustersX] = true;
+			}
+		}
+	for (int cy = 0; cy < h->clustersY; ++cy)
+		for (int cx = 0; cx < h->clustersX; ++cx)
+		{
+			if (rebuild[cx + cy * h->clustersX])
+			{
+				fpathBuildCluster(*h, cx, cy);
+			}
+		}
+
+	if (i != fpathHierarchies.end())
+	{
+		i->second = h;
+	}
+	else
+	{
+		fpathHierarchies.emplace_back(type, h);
+	}
+	return h;
+}
 
+/** Plans a route between the cluster entrances, and then refines each step with A*.
+ *
+ *  @return false if no route was found this way, in which case the normal A* should be used instead.
+ */
+static bool fpathHierarchicalRoute(PathHierarchy const &h, PATHJOB *psJob, std::vector<Vector2i> &path)
+{
 	const PathCoord tileOrig(map_coord(psJob->origX), map_coord(psJob->origY));
 	const PathCoord tileDest(map_coord(psJob->destX), map_coord(psJob->destY));
 	const PathNonblockingArea dstIgnore(psJob->dstStructure);
 
-	PathCoord endCoord;  // Either nearest coord (mustReverse = true) or orig (mustReverse = false).
+	if (h.width != mapWidth || h.height != mapHeight)
+	{
+		return false;
+	}
+
+	// Connect the start and destination to the entrances of their clusters.
+	std::vector<unsigned> origDist, destDist;
+	fpathClusterDistances(h, tileOrig, dstIgnore, origDist);
+	fpathClusterDistances(h, tileDest, dstIgnore, destDist);
+	const int destCluster = h.clusterIndex(tileDest);
 
-	std::list<PathfindContext>::iterator contextIterator = fpathContexts.begin();
-	for (contextIterator = fpathContexts.begin(); contextIterator != fpathContexts.end(); ++contextIterator)
+	struct AbstractNode
 	{
-		if (!contextIterator->matches(psJob->blockingMap, tileDest, dstIgnore))
+		unsigned dist;
+		int parent;
+		bool closed;
+	};
+	typedef std::pair<unsigned, int> OpenNode;  // Estimate, tile index.
+	std::unordered_map<int, AbstractNode> explored;
+	std::priority_queue<OpenNode, std::vector<OpenNode>, std::greater<OpenNode>> open;
+	const int origIndex = tileOrig.x + tileOrig.y * mapWidth;
+	const int destIndex = tileDest.x + tileDest.y * mapWidth;
+
+	auto visit = [&](int from, PathCoord to, unsigned dist) {
+		const int index = to.x + to.y * mapWidth;
+		auto it = explored.find(index);
+		if (it != explored.end() && (it->second.closed || it->second.dist <= dist))
+		{
+			return;
+		}
+		explored[index] = AbstractNode{dist, from, false};
+		open.push(OpenNode(dist + fpathGoodEstimate(to, tileDest), index));
+	};
+
+	explored[origIndex] = AbstractNode{0, -1, false};
+	open.push(OpenNode(fpathGoodEstimate(tileOrig, tileDest), origIndex));
+	bool found = false;
+	while (!open.empty())
+	{
+		const int index = open.top().second;
+		open.pop();
+		AbstractNode &node = explored[index];
+		if (node.closed)
 		{
-			// This context is not for the same droid type and same destination.
 			continue;
 		}
+		node.closed = true;
+		if (index == destIndex)
+		{
+			found = true;
+			break;
+		}
+		const unsigned dist = node.dist;
+		const PathCoord p(index % mapWidth, index / mapWidth);
+		const int clusterIndex = h.clusterIndex(p);
+		PathCluster const &cluster = h.clusters[clusterIndex];
+		const size_t n = cluster.nodes.size();
+		const size_t i = std::find(cluster.nodes.begin(), cluster.nodes.end(), p) - cluster.nodes.begin();
+
+		if (index == origIndex)
+		{
+			// The start need not be an entrance, so use the distances from it to the entrances of its cluster.
+			for (size_t j = 0; j < n; ++j)
+			{
+				if (j != i && origDist[fpathClusterTile(cluster.nodes[j])] != UINT32_MAX)
+				{
+					visit(index, cluster.nodes[j], dist + origDist[fpathClusterTile(cluster.nodes[j])]);
+				}
+			}
+		}
+		else
+		{
+			ASSERT_OR_RETURN(false, i < n, "Abstract path node (%d, %d) is not an entrance", p.x, p.y);
+			for (size_t j = 0; j < n; ++j)
+			{
+				if (j != i && cluster.dist[i * n + j] != UINT32_MAX)
+				{
+					visit(index, cluster.nodes[j], dist + cluster.dist[i * n + j]);
+				}
+			}
+		}
+		if (i < n)
+		{
+			// Entrances, including the start if it is one, lead straight into the next cluster.
+			for (PathCoord partner : cluster.partners[i])
+			{
+				visit(index, partner, dist + 140);
+			}
+		}
+		if (clusterIndex == destCluster && destDist[fpathClusterTile(p)] != UINT32_MAX)
+		{
+			visit(index, tileDest, dist + destDist[fpathClusterTile(p)]);
+		}
+	}
+	if (!found)
+	{
+		return false;  // Maybe the destination is only reachable via the structure at the destination, or not at all.
+	}
 
-		// We have tried going to tileDest before.
+	std::vector<PathCoord> waypoints;
+	for (int index = destIndex; index != -1; index = explored[index].parent)
+	{
+		waypoints.push_back(PathCoord(index % mapWidth, index / mapWidth));
+	}
+	std::reverse(waypoints.begin(), waypoints.end());
 
-		if (contextIterator->map[tileOrig.x + tileOrig.y * mapWidth].iteration == contextIterator->iteration
-		    && contextIterator->map[tileOrig.x + tileOrig.y * mapWidth].visited)
+	// Refine each step of the abstract path. Search backwards from the end of each step, so that walking back gives the step in the right order.
+	PathfindContext &context = fpathRefineContext;
+	path.clear();
+	for (size_t k = 0; k + 1 < waypoints.size(); ++k)
+	{
+		const PathCoord from = waypoints[k], to = waypoints[k + 1];
+		fpathInitContext(context, psJob->blockingMap, to, to, from, dstIgnore);
+		if (fpathAStarExplore(context, from) != from)
 		{
-			// Already know the path from orig to dest.
-			endCoord = tileOrig;
+			return false;
 		}
-		else
+		const size_t first = path.size();
+		if (!fpathAStarWalkBack(context, from, path))
 		{
-			// Need to find the path from orig to dest, continue previous exploration.
-			fpathAStarReestimate(*contextIterator, tileOrig);
-			endCoord = fpathAStarExplore(*contextIterator, tileOrig);
+			return false;
 		}
+		if (first != 0)
+		{
+			path.erase(path.begin() + first);  // Same tile as the end of the previous step.
+		}
+	}
+	return !path.empty();
+}
+
+/// Waits until another path thread changes the caches or hands on the turn. Call with fpathCacheMutex locked.
+static void fpathCacheWait(std::unique_lock<wz::mutex> &lock, WZ_SEMAPHORE *wakeUp)
+{
+	fpathCacheWaiters.push_back(wakeUp);
+	lock.unlock();
+	wzSemaphoreWait(wakeUp);
+	lock.lock();
+}
+
+/// Wakes up the path threads waiting in fpathCacheWait(). Call with fpathCacheMutex locked.
+static void fpathCacheChanged()
+{
+	for (WZ_SEMAPHORE *waiter : fpathCacheWaiters)
+	{
+		wzSemaphorePost(waiter);
+	}
+	fpathCacheWaiters.clear();
+}
+
+/// Lets the next job pick its context. Call with fpathCacheMutex locked.
+static void fpathCacheNextTurn()
+{
+	++fpathCacheTurn;
+	fpathCacheChanged();
+}
+
+/// Called with fpathCacheMutex locked, while holding the turn. Hands on the turn as soon as the rest of the search only
+/// touches a context no other job can use until this one is done with it, and returns with fpathCacheMutex locked again.
+/// Sets reused if a cached context had already explored the start, so the route only had to be traced back from there.
+static ASR_RETVAL fpathAStarRouteUncached(MOVE_CONTROL *psMove, PATHJOB *psJob, std::unique_lock<wz::mutex> &lock, WZ_SEMAPHORE *wakeUp, bool &reused)
+{
+	ASR_RETVAL      retval = ASR_OK;
+
+	bool            mustReverse = true;
+
+	const PathCoord tileOrig(map_coord(psJob->origX), map_coord(psJob->origY));
+	const PathCoord tileDest(map_coord(psJob->destX), map_coord(psJob->destY));
+	const PathNonblockingArea dstIgnore(psJob->dstStructure);
+
+	PathCoord endCoord;  // Either nearest coord (mustReverse = true) or orig (mustReverse = false).
 
-		if (endCoord != tileOrig)
+	// First look for a context which has already explored orig, so that the route only needs to be traced back from there.
+	// Only then continue exploring the contexts, in the hope of reaching orig.
+	std::list<PathContextSlot>::iterator contextIterator = fpathContexts.end();
+	for (int pass = 0; pass < 2 && contextIterator == fpathContexts.end(); ++pass)
+	{
+		for (contextIterator = fpathContexts.begin(); contextIterator != fpathContexts.end(); ++contextIterator)
 		{
-			// orig turned out to be on a different island than what this context was used for, so can't use this context data after all.
-			continue;
+			if (!contextIterator->matches(psJob->blockingMap, tileDest, dstIgnore))
+			{
+				// This context is not for the same droid type and same destination.
+				continue;
+			}
+
+			// We have tried going to tileDest before.
+			while (contextIterator->busy)
+			{
+				fpathCacheWait(lock, wakeUp);  // An earlier job is not done with it yet.
+			}
+			if (!contextIterator->matches(psJob->blockingMap, tileDest, dstIgnore))
+			{
+				continue;  // The earlier job failed, and dropped it.
+			}
+			PathfindContext &context = contextIterator->context;
+
+			if (context.map[tileOrig.x + tileOrig.y * mapWidth].iteration == context.iteration
+			    && context.map[tileOrig.x + tileOrig.y * mapWidth].visited)
+			{
+				// Already know the path from orig to dest.
+				endCoord = tileOrig;
+				reused = true;
+			}
+			else if (pass == 0)
+			{
+				continue;
+			}
+			else
+			{
+				// Need to find the path from orig to dest, continue previous exploration. No other job can use the context before our turn is over.
+				lock.unlock();
+				fpathAStarReestimate(context, tileOrig);
+				endCoord = fpathAStarExplore(context, tileOrig);
+				lock.lock();
+			}
+
+			if (endCoord != tileOrig)
+			{
+				// orig turned out to be on a different island than what this context was used for, so can't use this context data after all.
+				continue;
+			}
+
+			mustReverse = false;  // We have the path from the nearest reachable tile to dest, to orig.
+			break;  // Found the path! Don't search more contexts.
 		}
+	}
 
-		mustReverse = false;  // We have the path from the nearest reachable tile to dest, to orig.
-		break;  // Found the path! Don't search more contexts.
+	const int distance = std::max(abs(tileOrig.x - tileDest.x), abs(tileOrig.y - tileDest.y));
+	if (contextIterator == fpathContexts.end() && psJob->hierarchical && psJob->blockingMap->hierarchy != nullptr && distance >= 2 * HPA_CLUSTER_SIZE)
+	{
+		// Long route, with no cached context. Plan it on the cluster hierarchy, instead of exploring the whole map.
+		// Keeps the turn, since whether this works decides whether a context gets replaced.
+		std::vector<Vector2i> path;
+		lock.unlock();
+		const bool found = fpathHierarchicalRoute(*psJob->blockingMap->hierarchy, psJob, path);
+		lock.lock();
+		if (found)
+		{
+			fpathCacheNextTurn();
+			// Found exact path, so use exact coordinates for last point, no reason to lose precision
+			path.back() = Vector2i(psJob->destX, psJob->destY);
+			psMove->asPath = path;
+			psMove->destination = psMove->asPath.back();
+			return ASR_OK;
+		}
 	}
 
 	if (contextIterator == fpathContexts.end())
@@ -493,19 +1107,42 @@ ASR_RETVAL fpathAStarRoute(MOVE_CONTROL *psMove, PATHJOB *psJob)
 
 		if (fpathContexts.size() < 30)
 		{
-			fpathContexts.push_back(PathfindContext());
+			fpathContexts.push_back(PathContextSlot());
 		}
 		--contextIterator;
+		while (contextIterator->busy)
+		{
+			fpathCacheWait(lock, wakeUp);  // An earlier job is not done with the oldest context yet.
+		}
+
+		// Later jobs look for what the context will be searching for once we are done with it, see below.
+		contextIterator->myGameTime = psJob->blockingMap->type.gameTime;
+		contextIterator->blockingMap = psJob->blockingMap;
+		contextIterator->tileS = fpathIsBlocked(*psJob->blockingMap, dstIgnore, tileOrig.x, tileOrig.y) ? tileOrig : tileDest;
+		contextIterator->dstIgnore = dstIgnore;
+	}
 
+	// Move context to beginning of last recently used list.
+	if (contextIterator != fpathContexts.begin())  // Not sure whether or not the splice is a safe noop, if equal.
+	{
+		fpathContexts.splice(fpathContexts.begin(), fpathContexts, contextIterator);
+	}
+
+	// The rest only depends on this context, so let the next job go ahead.
+	contextIterator->busy = true;
+	fpathCacheNextTurn();
+	lock.unlock();
+
+	PathfindContext &context = contextIterator->context;
+	if (mustReverse)
+	{
 		// Init a new context, overwriting the oldest one if we are caching too many.
 		// We will be searching from orig to dest, since we don't know where the nearest reachable tile to dest is.
-		fpathInitContext(*contextIterator, psJob->blockingMap, tileOrig, tileOrig, tileDest, dstIgnore);
-		endCoord = fpathAStarExplore(*contextIterator, tileDest);
-		contextIterator->nearestCoord = endCoord;
+		fpathInitContext(context, psJob->blockingMap, tileOrig, tileOrig, tileDest, dstIgnore);
+		endCoord = fpathAStarExplore(context, tileDest);
+		context.nearestCoord = endCoord;
 	}
 
-	PathfindContext &context = *contextIterator;
-
 	// return the nearest route if no actual route was found
 	if (context.nearestCoord != tileDest)
 	{
@@ -513,91 +1150,166 @@ ASR_RETVAL fpathAStarRoute(MOVE_CONTROL *psMove, PATHJOB *psJob)
 	}
 
 	// Get route, in reverse order.
-	static std::vector<Vector2i> path;  // Declared static to save allocations.
-	path.clear();
-
-	Vector2i newP(0, 0);
-	for (Vector2i p(world_coord(endCoord.x) + TILE_UNITS / 2, world_coord(endCoord.y) + TILE_UNITS / 2); true; p = newP)
+	std::vector<Vector2i> path;  // Not static, since several path threads may be running.
+	if (!fpathAStarWalkBack(context, endCoord, path))
 	{
-		ASSERT_OR_RETURN(ASR_FAILED, worldOnMap(p.x, p.y), "Assigned XY coordinates (%d, %d) not on map!", (int)p.x, (int)p.y);
-		ASSERT_OR_RETURN(ASR_FAILED, path.size() < (unsigned)mapWidth * mapHeight, "Pathfinding got in a loop.");
-
-		path.push_back(p);
-
-		PathExploredTile &tile = context.map[map_coord(p.x) + map_coord(p.y) * mapWidth];
-		newP = p - Vector2i(tile.dx, tile.dy) * (TILE_UNITS / 64);
-		Vector2i mapP = map_coord(newP);
-		int xSide = newP.x - world_coord(mapP.x) > TILE_UNITS / 2 ? 1 : -1; // 1 if newP is on right-hand side of the tile, or -1 if newP is on the left-hand side of the tile.
-		int ySide = newP.y - world_coord(mapP.y) > TILE_UNITS / 2 ? 1 : -1; // 1 if newP is on bottom side of the tile, or -1 if newP is on the top side of the tile.
-		if (context.isBlocked(mapP.x + xSide, mapP.y))
+		retval = ASR_FAILED;
+	}
+	else
+	{
+		if (retval == ASR_OK)
 		{
-			newP.x = world_coord(mapP.x) + TILE_UNITS / 2; // Point too close to a blocking tile on left or right side, so move the point to the middle.
+			// Found exact path, so use exact coordinates for last point, no reason to lose precision
+			Vector2i v(psJob->destX, psJob->destY);
+			if (mustReverse)
+			{
+				path.front() = v;
+			}
+			else
+			{
+				path.back() = v;
+			}
 		}
-		if (context.isBlocked(mapP.x, mapP.y + ySide))
+
+		// Allocate memory
+		psMove->asPath.resize(path.size());
+
+		// get the route in the correct order
+		// If as I suspect this is to reverse the list, then it's my suspicion that
+		// we could route from destination to source as opposed to source to
+		// destination. We could then save the reversal. to risky to try now...Alex M
+		//
+		// The idea is impractical, because you can't guarentee that the target is
+		// reachable. As I see it, this is the reason why psNearest got introduced.
+		// -- Dennis L.
+		//
+		// If many droids are heading towards the same destination, then destination
+		// to source would be faster if reusing the information in nodeArray. --Cyp
+		if (mustReverse)
 		{
-			newP.y = world_coord(mapP.y) + TILE_UNITS / 2; // Point too close to a blocking tile on rop or bottom side, so move the point to the middle.
+			// Copy the list, in reverse.
+			std::copy(path.rbegin(), path.rend(), psMove->asPath.data());
+
+			if (!context.isBlocked(tileOrig.x, tileOrig.y))  // If blocked, searching from tileDest to tileOrig wouldn't find the tileOrig tile.
+			{
+				// Next time, search starting from nearest reachable tile to the destination.
+				fpathInitContext(context, psJob->blockingMap, tileDest, context.nearestCoord, tileOrig, dstIgnore);
+			}
 		}
-		if (map_coord(p) == Vector2i(context.tileS.x, context.tileS.y) || p == newP)
+		else
 		{
-			break;  // We stopped moving, because we reached the destination or the closest reachable tile to context.tileS. Give up now.
+			// Copy the list.
+			std::copy(path.begin(), path.end(), psMove->asPath.data());
 		}
+
+		psMove->destination = psMove->asPath[path.size() - 1];
 	}
-	if (retval == ASR_OK)
+
+	lock.lock();
+	if (retval == ASR_FAILED && mustReverse)
 	{
-		// Found exact path, so use exact coordinates for last point, no reason to lose precision
-		Vector2i v(psJob->destX, psJob->destY);
-		if (mustReverse)
+		contextIterator->blockingMap = nullptr;  // Not searching from where later jobs expect it to, so do not let them use it.
+	}
+	contextIterator->busy = false;
+	fpathCacheChanged();
+	return retval;
+}
+
+/// Returns the cluster containing the start of the job, used to find cached routes.
+static int fpathRouteCacheCluster(PATHJOB const *psJob)
+{
+	return map_coord(psJob->origX) / HPA_CLUSTER_SIZE + map_coord(psJob->origY) / HPA_CLUSTER_SIZE * ((mapWidth + HPA_CLUSTER_SIZE - 1) / HPA_CLUSTER_SIZE);
+}
+
+ASR_RETVAL fpathAStarRoute(MOVE_CONTROL *psMove, PATHJOB *psJob)
+{
+	const int startCluster = fpathRouteCacheCluster(psJob);
+	const Vector2i tileOrig(map_coord(psJob->origX), map_coord(psJob->origY));
+	WZ_SEMAPHORE *wakeUp = wzSemaphoreCreate(0);
+	std::unique_lock<wz::mutex> lock(fpathCacheMutex);
+
+	// Wait until the jobs queued before this one have picked their contexts.
+	while (fpathCacheTurn != psJob->sequence)
+	{
+		fpathCacheWait(lock, wakeUp);
+	}
+
+	for (auto i = fpathRouteCache.begin(); i != fpathRouteCache.end(); ++i)
+	{
+		PathRouteCacheEntry &entry = **i;
+		if (!entry.matches(psJob, startCluster))
 		{
-			path.front() = v;
+			continue;
 		}
-		else
+		while (entry.pending)
 		{
-			path.back() = v;
+			fpathCacheWait(lock, wakeUp);  // An earlier job is still searching for this route.
+		}
+		auto start = std::find_if(entry.path.begin(), entry.path.end(), [&](Vector2i const &p) { return map_coord(p) == tileOrig; });
+		if (start == entry.path.end())
+		{
+			continue;  // Not on this route, or there is no route.
 		}
-	}
 
-	// Allocate memory
-	psMove->asPath.resize(path.size());
+		// Another droid already went this way, follow the rest of its route.
+		psMove->asPath.assign(start, entry.path.end());
+		if (entry.retval == ASR_OK)
+		{
+			psMove->asPath.back() = Vector2i(psJob->destX, psJob->destY);  // Same tile, but maybe not the exact same point.
+		}
+		psMove->destination = psMove->asPath.back();
+		ASR_RETVAL retval = entry.retval;
+		fpathRouteCache.splice(fpathRouteCache.begin(), fpathRouteCache, i);  // Move to beginning of last recently used list.
+		++fpathRouteCacheHits;
+		fpathCacheNextTurn();
+		lock.unlock();
+		wzSemaphoreDestroy(wakeUp);
+		return retval;
+	}
 
-	// get the route in the correct order
-	// If as I suspect this is to reverse the list, then it's my suspicion that
-	// we could route from destination to source as opposed to source to
-	// destination. We could then save the reversal. to risky to try now...Alex M
-	//
-	// The idea is impractical, because you can't guarentee that the target is
-	// reachable. As I see it, this is the reason why psNearest got introduced.
-	// -- Dennis L.
-	//
-	// If many droids are heading towards the same destination, then destination
-	// to source would be faster if reusing the information in nodeArray. --Cyp
-	if (mustReverse)
+	// Remember the route, replacing the oldest one if we are caching too many. A job waiting for the oldest one keeps it alive.
+	std::shared_ptr<PathRouteCacheEntry> entry = std::make_shared<PathRouteCacheEntry>();
+	entry->myGameTime = psJob->blockingMap->type.gameTime;
+	entry->blockingMap = psJob->blockingMap;
+	entry->startCluster = startCluster;
+	entry->tileDest = PathCoord(map_coord(psJob->destX), map_coord(psJob->destY));
+	entry->dstIgnore = PathNonblockingArea(psJob->dstStructure);
+	entry->pending = true;
+	entry->retval = ASR_FAILED;
+	if (fpathRouteCache.size() >= 30)
 	{
-		// Copy the list, in reverse.
-		std::copy(path.rbegin(), path.rend(), psMove->asPath.data());
+		fpathRouteCache.pop_back();
+	}
+	fpathRouteCache.push_front(entry);
 
-		if (!context.isBlocked(tileOrig.x, tileOrig.y))  // If blocked, searching from tileDest to tileOrig wouldn't find the tileOrig tile.
-		{
-			// Next time, search starting from nearest reachable tile to the destination.
-			fpathInitContext(context, psJob->blockingMap, tileDest, context.nearestCoord, tileOrig, dstIgnore);
-		}
+	bool reused = false;
+	ASR_RETVAL retval = fpathAStarRouteUncached(psMove, psJob, lock, wakeUp, reused);
+	if (reused)
+	{
+		++fpathRouteCacheHits;
 	}
 	else
 	{
-		// Copy the list.
-		std::copy(path.begin(), path.end(), psMove->asPath.data());
+		++fpathRouteCacheMisses;
 	}
-
-	// Move context to beginning of last recently used list.
-	if (contextIterator != fpathContexts.begin())  // Not sure whether or not the splice is a safe noop, if equal.
+	if (retval != ASR_FAILED && !psMove->asPath.empty())
 	{
-		fpathContexts.splice(fpathContexts.begin(), fpathContexts, contextIterator);
+		entry->retval = retval;
+		entry->path = psMove->asPath;
 	}
-
-	psMove->destination = psMove->asPath[path.size() - 1];
-
+	entry->pending = false;
+	fpathCacheChanged();
+	lock.unlock();
+	wzSemaphoreDestroy(wakeUp);
 	return retval;
 }
 
+void fpathRouteCacheStats(unsigned *hits, unsigned *misses)
+{
+	*hits = fpathRouteCacheHits;
+	*misses = fpathRouteCacheMisses;
+}
+
 void fpathSetBlockingMap(PATHJOB *psJob)
 {
 	if (fpathCurrentGameTime != gameTime)
@@ -646,6 +1358,10 @@ void fpathSetBlockingMap(PATHJOB *psJob)
 					checksumDangerMap ^= dangerMap[x + y * mapWidth] * (factor = 3 * factor + 1);
 				}
 		}
+		if (fpathGetHierarchical() && blockMap->dangerMap.empty())
+		{
+			blockMap->hierarchy = fpathUpdateHierarchy(type, map);
+		}
 		syncDebug("blockingMap(%d,%d,%d,%d) = %08X %08X", gameTime, psJob->propulsion, psJob->owner, psJob->moveType, checksumMap, checksumDangerMap);
 
 		psJob->blockingMap = fpathBlockingMaps.back();
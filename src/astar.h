@@ -35,11 +35,23 @@ enum ASR_RETVAL
 };
 
 /** Use the A* algorithm to find a path
+ *
+ *  May be called from several path threads at once. Jobs use the shared caches in the order of psJob->sequence, and wait
+ *  for earlier jobs still using a cached context they need, so the resulting paths do not depend on the number of threads.
+ *  Every sequence number must be passed exactly once, or later jobs wait forever.
  *
  *  @ingroup pathfinding
  */
 ASR_RETVAL fpathAStarRoute(MOVE_CONTROL *psMove, PATHJOB *psJob);
 
+/** Get the number of routes which were, and were not, reused from earlier searches.
+ *
+ *  A route is reused if, in the same tick, a droid starts on a tile which the search of another droid going to the same destination
+ *  has already explored, so that the route can be traced back from there, or if it starts on a route found for another droid going
+ *  to the same destination from the same cluster. Counted since fpathHardTableReset().
+ */
+void fpathRouteCacheStats(unsigned *hits, unsigned *misses);
+
 /// Call from main thread.
 /// Sets psJob->blockingMap for later use by pathfinding thread, generating the required map if not already generated.
 void fpathSetBlockingMap(PATHJOB *psJob);
@@ -47,6 +59,7 @@ void fpathSetBlockingMap(PATHJOB *psJob);
 /** Clean up the path finding node table.
  *
  *  @note Call this on shutdown to prevent memory from leaking, or if loading/saving, to prevent stale data from being reused.
+ *  Must not be called while path threads are running jobs. The next job must have sequence 0.
  *
  *  @ingroup pathfinding
  */
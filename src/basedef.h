@@ -117,6 +117,7 @@ struct BASE_OBJECT : public SIMPLE_OBJECT
 	UBYTE               selected;                   ///< Whether the object is selected (might want this elsewhere)
 	UBYTE               visible[MAX_PLAYERS];       ///< Whether object is visible to specific player
 	UBYTE               seenThisTick[MAX_PLAYERS];  ///< Whether object has been seen this tick by the specific player.
+	UDWORD              gridIndex = UDWORD_MAX;     ///< Index of the object in the map grid point tree, set by gridReset().
 	UWORD               numWatchedTiles;            ///< Number of watched tiles, zero for features
 	UDWORD              lastEmission;               ///< When did it last puff out smoke?
 	WEAPON_SUBCLASS     lastHitWeapon;              ///< The weapon that last hit it
@@ -0,0 +1,137 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2005-2019  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/** @file
+ *  Fast-forward simulation benchmark.
+ *
+ *  Game time advances by one tick per game loop instead of following the wall clock, and the random seed is fixed,
+ *  so that a given skirmish setup always plays out the same way. The CRC of all syncDebug() output is printed at the
+ *  end, to check that an optimisation did not change the simulation.
+ */
+
+#include "lib/framework/frame.h"
+#include "lib/framework/crc.h"
+#include "lib/framework/wzapp.h"
+#include "lib/gamelib/gtime.h"
+#include "lib/netplay/netplay.h"
+
+#include "benchmark.h"
+#include "astar.h"
+
+#include <atomic>
+
+static unsigned benchmarkTicks = 0;    ///< Ticks to run, 0 if not benchmarking.
+static unsigned benchmarkTicksDone = 0;
+static uint32_t benchmarkCrc = 0;
+static std::chrono::steady_clock::time_point benchmarkWallStart;
+static std::chrono::steady_clock::time_point benchmarkTickStart;
+static std::chrono::steady_clock::duration benchmarkUpdateTime{0};
+static std::atomic<int64_t> benchmarkSectionTime[BENCH_MAX];  ///< In nanoseconds, written from several threads.
+
+static const char *const benchmarkSectionNames[BENCH_MAX] =
+{
+	"pathfinding",
+	"visibility",
+	"droids",
+	"structures",
+	"projectiles",
+	"scripts",
+};
+
+void benchmarkSetTicks(unsigned ticks)
+{
+	benchmarkTicks = ticks;
+	gameTimeSetFastForward(ticks != 0);
+}
+
+bool benchmarkEnabled()
+{
+	return benchmarkTicks != 0;
+}
+
+uint32_t benchmarkRandomSeed()
+{
+	return 0x2100;
+}
+
+void benchmarkAddTime(BENCHMARK_SECTION section, std::chrono::steady_clock::duration time)
+{
+	benchmarkSectionTime[section] += std::chrono::duration_cast<std::chrono::nanoseconds>(time).count();
+}
+
+void benchmarkTickBegin()
+{
+	if (!benchmarkEnabled())
+	{
+		return;
+	}
+	benchmarkTickStart = std::chrono::steady_clock::now();
+	if (benchmarkTicksDone == 0)
+	{
+		benchmarkWallStart = benchmarkTickStart;
+		for (auto &time : benchmarkSectionTime)
+		{
+			time = 0;  // Ignore path finding done while loading.
+		}
+	}
+}
+
+static double toMs(int64_t nanoseconds)
+{
+	return nanoseconds / 1000000.;
+}
+
+static void benchmarkReport()
+{
+	const int64_t wall = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - benchmarkWallStart).count();
+	const int64_t update = std::chrono::duration_cast<std::chrono::nanoseconds>(benchmarkUpdateTime).count();
+
+	fprintf(stdout, "Benchmark: %u ticks (%u ms game time) in %.1f ms, %.1f ticks/s\n", benchmarkTicksDone, benchmarkTicksDone * GAME_TICKS_PER_UPDATE, toMs(wall), benchmarkTicksDone / (toMs(wall) / 1000.));
+	fprintf(stdout, "  %-12s %10s %10s\n", "section", "total ms", "ms/tick");
+	fprintf(stdout, "  %-12s %10.1f %10.3f\n", "game update", toMs(update), toMs(update) / benchmarkTicksDone);
+	for (unsigned i = 0; i < BENCH_MAX; ++i)
+	{
+		const int64_t time = benchmarkSectionTime[i];
+		fprintf(stdout, "  %-12s %10.1f %10.3f\n", benchmarkSectionNames[i], toMs(time), toMs(time) / benchmarkTicksDone);
+	}
+	unsigned hits, misses;
+	fpathRouteCacheStats(&hits, &misses);
+	fprintf(stdout, "  path route cache: %u hits, %u misses\n", hits, misses);
+	fprintf(stdout, "  sync CRC: 0x%08X\n", benchmarkCrc);
+	fflush(stdout);
+	debug(LOG_INFO, "Benchmark finished: %u ticks, %.1f ms, sync CRC 0x%08X", benchmarkTicksDone, toMs(wall), benchmarkCrc);
+}
+
+void benchmarkTickEnd()
+{
+	if (!benchmarkEnabled() || benchmarkTicksDone >= benchmarkTicks)
+	{
+		return;
+	}
+	benchmarkUpdateTime += std::chrono::steady_clock::now() - benchmarkTickStart;
+
+	// Chain the CRCs of each tick's syncDebug() output, so that any difference in any tick shows up at the end.
+	const uint32_t tickCrc = syncDebugGetCrc();
+	benchmarkCrc = crcSum(benchmarkCrc, &tickCrc, sizeof(tickCrc));
+
+	if (++benchmarkTicksDone == benchmarkTicks)
+	{
+		benchmarkReport();
+		wzQuit();
+	}
+}
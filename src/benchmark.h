@@ -0,0 +1,82 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2005-2019  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/** @file
+ *  Fast-forward simulation benchmark, see --benchmark.
+ */
+
+#ifndef __INCLUDED_SRC_BENCHMARK_H__
+#define __INCLUDED_SRC_BENCHMARK_H__
+
+#include "lib/framework/types.h"
+
+#include <chrono>
+
+/// Parts of the game state update that are timed separately.
+enum BENCHMARK_SECTION
+{
+	BENCH_PATHFINDING,   ///< A* searches, measured on the path finding thread.
+	BENCH_VISIBILITY,    ///< processVisibility()
+	BENCH_DROIDS,        ///< droidUpdate() and missionDroidUpdate()
+	BENCH_STRUCTURES,    ///< structureUpdate()
+	BENCH_PROJECTILES,   ///< proj_UpdateAll()
+	BENCH_SCRIPTS,       ///< Script triggers and timers.
+	BENCH_MAX
+};
+
+/// Runs the game for the given number of ticks as fast as possible, then prints the timings and quits.
+void benchmarkSetTicks(unsigned ticks);
+bool benchmarkEnabled();
+/// Fixed seed for the synchronised random number generator, so that runs are reproducible.
+uint32_t benchmarkRandomSeed();
+
+/// Adds time spent in a section. Thread safe.
+void benchmarkAddTime(BENCHMARK_SECTION section, std::chrono::steady_clock::duration time);
+
+/// Call around each game state update.
+void benchmarkTickBegin();
+void benchmarkTickEnd();
+
+/// Adds the time until it goes out of scope to a section, if benchmarking.
+class BenchmarkTimer
+{
+public:
+	explicit BenchmarkTimer(BENCHMARK_SECTION section)
+		: section(section)
+		, running(benchmarkEnabled())
+	{
+		if (running)
+		{
+			start = std::chrono::steady_clock::now();
+		}
+	}
+	~BenchmarkTimer()
+	{
+		if (running)
+		{
+			benchmarkAddTime(section, std::chrono::steady_clock::now() - start);
+		}
+	}
+
+private:
+	BENCHMARK_SECTION section;
+	bool running;
+	std::chrono::steady_clock::time_point start;
+};
+
+#endif // __INCLUDED_SRC_BENCHMARK_H__
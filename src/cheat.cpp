@@ -83,6 +83,8 @@ static CHEAT_ENTRY cheatCodes[] =
 	{"power info", kf_PowerInfo},
 	{"reload me", kf_Reload},	// reload selected weapons immediately
 	{"desync me", kf_ForceDesync},
+	{"hpa path", kf_ToggleHierarchicalPathfinding}, // toggle hierarchical path-finding
+	{"vis check", kf_ToggleVisibilitySelfCheck}, // recheck parallel line of sight results
 	{"damage me", kf_DamageMe},
 	{"autogame on", kf_AutoGame},
 	{"autogame off", kf_AutoGame},
@@ -25,11 +25,14 @@
  */
 
 #include "lib/framework/frame.h"
+#include "lib/framework/wzapp.h"
 #include "lib/framework/opengl.h"
 #include "lib/ivis_opengl/screen.h"
 #include "lib/netplay/netplay.h"
 #include "lib/ivis_opengl/pieclip.h"
 
+#include "benchmark.h"
+#include "replay.h"
 #include "levels.h"
 #include "clparse.h"
 #include "display3d.h"
@@ -81,6 +84,7 @@ typedef struct _poptContext
 /// Enable automatic test games
 static bool wz_autogame = false;
 static std::string wz_saveandquit;
+static std::string wz_convertsave;
 static std::string wz_test;
 
 static void poptPrintHelp(poptContext ctx, FILE *output, bool show_all)
@@ -252,6 +256,10 @@ typedef enum
 	CLI_AUTOGAME,
 	CLI_SAVEANDQUIT,
 	CLI_SKIRMISH,
+	CLI_HEADLESS,
+	CLI_BENCHMARK,
+	CLI_REPLAY,
+	CLI_CONVERTSAVE,
 } CLI_OPTIONS;
 
 static const struct poptOption *getOptionsTable()
@@ -288,6 +296,10 @@ static const struct poptOption *getOptionsTable()
 		{ "autogame",   '\0', POPT_ARG_NONE,   nullptr, CLI_AUTOGAME,   N_("Run games automatically for testing"), nullptr, true },
 		{ "saveandquit", '\0', POPT_ARG_STRING, nullptr, CLI_SAVEANDQUIT, N_("Immediately save game and quit"), N_("save name"), true },
 		{ "skirmish",   '\0', POPT_ARG_STRING, nullptr, CLI_SKIRMISH,   N_("Start skirmish game with given settings file"), N_("test"), true },
+		{ "headless",   '\0', POPT_ARG_NONE,   nullptr, CLI_HEADLESS,   N_("Run without a window, graphics or sound"), nullptr, true },
+		{ "benchmark",  '\0', POPT_ARG_STRING, nullptr, CLI_BENCHMARK,  N_("Run a --skirmish game for the given number of ticks as fast as possible, print timings and quit"), N_("ticks"), true },
+		{ "replay",     '\0', POPT_ARG_STRING, nullptr, CLI_REPLAY,     N_("Play back a recorded game as fast as possible"), N_("replay file"), true },
+		{ "convertsave", '\0', POPT_ARG_STRING, nullptr, CLI_CONVERTSAVE, N_("Convert a savegame between JSON and binary, print sizes and timings of both, and quit"), N_("savegame"), true },
 		// Terminating entry
 		{ nullptr,         '\0', 0,               nullptr, 0,              nullptr,                                    nullptr, true },
 	};
@@ -656,9 +668,52 @@ bool ParseCommandLine(int argc, const char * const *argv)
 			}
 			wz_test = token;
 			break;
+
+		case CLI_HEADLESS:
+			wzSetHeadless(true);
+			war_setSoundEnabled(false);
+			break;
+
+		case CLI_BENCHMARK:
+			{
+				token = poptGetOptArg(poptCon);
+				char *end = nullptr;
+				unsigned long ticks = token != nullptr ? strtoul(token, &end, 10) : 0;
+				if (ticks == 0 || *end != '\0')
+				{
+					qFatal("Bad number of benchmark ticks");
+				}
+				benchmarkSetTicks(ticks);
+				wz_autogame = true;
+			}
+			break;
+
+		case CLI_REPLAY:
+			token = poptGetOptArg(poptCon);
+			if (token == nullptr)
+			{
+				qFatal("Missing replay file");
+			}
+			replaySetFilename(token);
+			hostlaunch = 3;
+			break;
+
+		case CLI_CONVERTSAVE:
+			token = poptGetOptArg(poptCon);
+			if (token == nullptr || !strchr(token, '/'))
+			{
+				qFatal("Bad savegame name (needs to be a full path)");
+			}
+			wz_convertsave = token;
+			break;
 		};
 	}
 
+	if (benchmarkEnabled() && wz_test.empty())
+	{
+		qFatal("--benchmark needs a game setup given with --skirmish");
+	}
+
 	return true;
 }
 
@@ -672,6 +727,11 @@ const std::string &saveandquit_enabled()
 	return wz_saveandquit;
 }
 
+const std::string &convertsave_enabled()
+{
+	return wz_convertsave;
+}
+
 const std::string &wz_skirmish_test()
 {
 	return wz_test;
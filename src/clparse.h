@@ -30,6 +30,7 @@ bool ParseCommandLineEarly(int argc, const char * const *argv);
 
 bool autogame_enabled();
 const std::string &saveandquit_enabled();
+const std::string &convertsave_enabled();
 const std::string &wz_skirmish_test();
 
 #endif // __INCLUDED_SRC_CLPARSE_H__
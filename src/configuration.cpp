@@ -121,6 +121,11 @@ bool loadConfig()
 	{
 		war_SetScrollEvent(ini.value("scrollEvent").toInt());
 	}
+	war_SetPathThreads(ini.value("pathThreads", 0).toInt());
+	war_SetHierarchicalPathfinding(ini.value("hierarchicalPathfinding", false).toBool());
+	war_SetVisibilityThreads(ini.value("visibilityThreads", 1).toInt());
+	war_SetRecordReplays(ini.value("recordReplays", false).toBool());
+	war_SetBinarySaves(ini.value("binarySaves", false).toBool());
 	rotateRadar = ini.value("rotateRadar", true).toBool();
 	radarRotationArrow = ini.value("radarRotationArrow", true).toBool();
 	hostQuitConfirmation = ini.value("hostQuitConfirmation", true).toBool();
@@ -245,6 +250,11 @@ bool saveConfig()
 	ini.setValue("cameraSpeed", war_GetCameraSpeed());	// camera speed
 	ini.setValue("radarJump", war_GetRadarJump());		// radar jump
 	ini.setValue("scrollEvent", war_GetScrollEvent());	// scroll event
+	ini.setValue("pathThreads", war_GetPathThreads());	// number of path-finding threads, 0 = automatic
+	ini.setValue("hierarchicalPathfinding", war_GetHierarchicalPathfinding());	// plan long routes on map clusters first
+	ini.setValue("visibilityThreads", war_GetVisibilityThreads());	// number of threads checking line of sight, 0 = automatic
+	ini.setValue("recordReplays", war_GetRecordReplays());	// write skirmish and multiplayer games to replay/
+	ini.setValue("binarySaves", war_GetBinarySaves());	// write savegames in the binary format instead of JSON
 	ini.setValue("cameraAccel", getCameraAccel());		// camera acceleration
 	ini.setValue("mouseflip", (SDWORD)(getInvertMouseStatus()));	// flipmouse
 	ini.setValue("nomousewarp", (SDWORD)getMouseWarp());		// mouse warp
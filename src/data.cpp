@@ -31,10 +31,12 @@
 #include "lib/framework/frameresource.h"
 #include "lib/framework/strres.h"
 #include "lib/framework/crc.h"
+#include "lib/framework/wzconfig.h"
 #include "lib/gamelib/parser.h"
 #include "lib/ivis_opengl/bitimage.h"
 #include "lib/ivis_opengl/png_util.h"
 #include "lib/script/script.h"
+#include "lib/script/scriptcache.h"
 #include "lib/sound/audio.h"
 
 #include "qtscript.h"
@@ -50,6 +52,7 @@
 #include "template.h"
 #include "text.h"
 #include "texture.h"
+#include "version.h"
 
 // whether a save game is currently being loaded
 static bool saveFlag = false;
@@ -499,12 +502,40 @@ static void dataSMSGRelease(void *pData)
 	delete pFilename;
 }
 
+/*!
+ * Decode an image on a worker thread, for dataImageLoad
+ */
+static void *dataImagePrepare(const char *fileName)
+{
+	iV_Image *psSprite = (iV_Image *)malloc(sizeof(iV_Image));
+	if (psSprite && !iV_loadImage_PNG(fileName, psSprite))
+	{
+		free(psSprite);
+		psSprite = nullptr;
+	}
+	return psSprite;
+}
+
+static void dataImageDiscard(void *pData)
+{
+	iV_Image *psSprite = (iV_Image *)pData;
+	free(psSprite->bmp);
+	free(psSprite);
+}
+
 /*!
  * Load an image from file
  */
 static bool dataImageLoad(const char *fileName, void **ppData)
 {
-	iV_Image *psSprite = (iV_Image *)malloc(sizeof(iV_Image));
+	iV_Image *psSprite = (iV_Image *)resTakePreparedData();
+	if (psSprite)
+	{
+		*ppData = psSprite;
+		return true;
+	}
+
+	psSprite = (iV_Image *)malloc(sizeof(iV_Image));
 	if (!psSprite)
 	{
 		return false;
@@ -537,9 +568,20 @@ static bool dataTERTILESLoad(const char *fileName, void **ppData)
 	return true;
 }
 
+static void *dataIMGPrepare(const char *fileName)
+{
+	return iV_PrepareImageFile(fileName);
+}
+
+static void dataIMGDiscard(void *pData)
+{
+	iV_DiscardPreparedImageFile((IMAGEFILE_PREPARED *)pData);
+}
+
 static bool dataIMGLoad(const char *fileName, void **ppData)
 {
-	*ppData = iV_LoadImageFile(fileName);
+	IMAGEFILE_PREPARED *prepared = (IMAGEFILE_PREPARED *)resTakePreparedData();
+	*ppData = prepared ? iV_FinishImageFile(prepared, fileName) : iV_LoadImageFile(fileName);
 	if (*ppData == nullptr)
 	{
 		return false;
@@ -568,18 +610,32 @@ static void dataImageRelease(void *pData)
 }
 
 
+/* Decode an audio file on a worker thread, for dataAudioLoad */
+static void *dataAudioPrepare(const char *fileName)
+{
+	return audio_Disabled() ? nullptr : sound_DecodeTrackFile(fileName);
+}
+
+static void dataAudioDiscard(void *pData)
+{
+	free(pData);
+}
+
 /* Load an audio file */
 static bool dataAudioLoad(const char *fileName, void **ppData)
 {
+	soundDataBuffer *decoded = (soundDataBuffer *)resTakePreparedData();
+
 	if (audio_Disabled() == true)
 	{
+		free(decoded);
 		*ppData = nullptr;
 		// No error occurred (sound is just disabled), so we return true
 		return true;
 	}
 
-	// Load the track from a file
-	*ppData = sound_LoadTrackFromFile(fileName);
+	// Load the track from a file, unless it was already decoded
+	*ppData = decoded ? sound_LoadDecodedTrack(decoded) : sound_LoadTrackFromFile(fileName);
 
 	return *ppData != nullptr;
 }
@@ -671,11 +727,27 @@ static bool dataScriptLoad(const char *fileName, void **ppData)
 
 	calcDataHash(pBuffer, fileSize, DATA_SCRIPT);
 
+	// compiled scripts are cached under the hash of their source
+	std::string cacheName = "cache/scripts/" + sha256Sum(pBuffer, fileSize).toString() + ".slc";
+
 	free(pBuffer);
 
-	PHYSFS_seek(fileHandle, 0);		//reset position
+	*psProg = scriptLoadCode(cacheName.c_str(), version_getVersionString());
+	if (*psProg)
+	{
+		debug(LOG_WZ, "Loaded compiled script from %s", cacheName.c_str());
+	}
+	else
+	{
+		PHYSFS_seek(fileHandle, 0);		//reset position
 
-	*psProg = scriptCompile(fileHandle, SCRIPTTYPE);
+		*psProg = scriptCompile(fileHandle, SCRIPTTYPE);
+
+		if (*psProg && !scriptSaveCode(*psProg, cacheName.c_str(), version_getVersionString()))
+		{
+			debug(LOG_WZ, "Compiled script %s not cached", fileName);
+		}
+	}
 
 	PHYSFS_close(fileHandle);
 
@@ -815,6 +887,50 @@ static const RES_TYPE_MIN_FILE FileResourceTypes[] =
 	{"RESCH", bufferRESCHLoad, dataRESCHRelease},                  //research stats files
 };
 
+/* Parse a stats file on a worker thread; WzConfig picks it up when the load function opens it */
+static void *dataJsonPrepare(const char *fileName)
+{
+	return wzConfigPrepare(fileName) ? strdup(fileName) : nullptr;
+}
+
+static void dataJsonDiscard(void *pData)
+{
+	wzConfigDiscardPrepared((const char *)pData);
+	free(pData);
+}
+
+struct RES_TYPE_MIN_PREPARE
+{
+	const char *aType;                      ///< points to the string defining the type, which must be in one of the lists above
+	RES_PREPARE prepare;                    ///< routine to read and decode the data on a worker thread
+	RES_FREE discard;                       ///< routine to free prepared data the load function did not take
+};
+
+static const RES_TYPE_MIN_PREPARE PrepareResourceTypes[] =
+{
+	{"SFEAT", dataJsonPrepare, dataJsonDiscard},
+	{"STEMPL", dataJsonPrepare, dataJsonDiscard},
+	{"SWEAPON", dataJsonPrepare, dataJsonDiscard},
+	{"SBRAIN", dataJsonPrepare, dataJsonDiscard},
+	{"SSENSOR", dataJsonPrepare, dataJsonDiscard},
+	{"SECM", dataJsonPrepare, dataJsonDiscard},
+	{"SREPAIR", dataJsonPrepare, dataJsonDiscard},
+	{"SCONSTR", dataJsonPrepare, dataJsonDiscard},
+	{"SPROP", dataJsonPrepare, dataJsonDiscard},
+	{"SPROPTYPES", dataJsonPrepare, dataJsonDiscard},
+	{"STERRTABLE", dataJsonPrepare, dataJsonDiscard},
+	{"SBODY", dataJsonPrepare, dataJsonDiscard},
+	{"SWEAPMOD", dataJsonPrepare, dataJsonDiscard},
+	{"SPROPSND", dataJsonPrepare, dataJsonDiscard},
+	{"RESEARCHMSG", dataJsonPrepare, dataJsonDiscard},
+	{"SSTRMOD", dataJsonPrepare, dataJsonDiscard},
+	{"SSTRUCT", dataJsonPrepare, dataJsonDiscard},
+	{"RESCH", dataJsonPrepare, dataJsonDiscard},
+	{"WAV", dataAudioPrepare, dataAudioDiscard},
+	{"IMGPAGE", dataImagePrepare, dataImageDiscard},
+	{"IMG", dataIMGPrepare, dataIMGDiscard},
+};
+
 /* Pass all the data loading functions to the framework library */
 bool dataInitLoadFuncs()
 {
@@ -853,5 +969,14 @@ bool dataInitLoadFuncs()
 		}
 	}
 
+	// iterate through prepare functions
+	for (const RES_TYPE_MIN_PREPARE &CurrentType : PrepareResourceTypes)
+	{
+		if (!resAddPrepare(CurrentType.aType, CurrentType.prepare, CurrentType.discard))
+		{
+			return false; // error whilst adding a prepare function
+		}
+	}
+
 	return true;
 }
@@ -71,6 +71,8 @@
 	#define GLM_ENABLE_EXPERIMENTAL
 #endif
 #include <glm/gtx/transform.hpp>
+#include <memory>
+#include <vector>
 
 #define	GRAVITON_GRAVITY	((float)-800)
 #define	EFFECT_X_FLIP		0x1
@@ -152,7 +154,18 @@
 #define SHOCKWAVE_SPEED	(GAME_TICKS_PER_SEC)
 #define	MAX_SHOCKWAVE_SIZE				500
 
-static std::list<EFFECT *> activeList;
+#define EFFECT_POOL_BLOCK				1024	// Effects are allocated this many at a time
+#define MAX_EFFECTS						16384	// Hard limit on the number of effects in the world
+#define EFFECT_CULL_START				(MAX_EFFECTS * 3 / 4)	// Above this, less important effects are increasingly dropped
+
+/* Effects are kept in blocks which are never moved, since the render buckets point at them */
+static std::vector<std::unique_ptr<EFFECT[]>> effectBlocks;
+static std::vector<EFFECT *> freeEffects;
+/* The effects in the world, by group, so that each group is updated in one go. The effects themselves stay whole
+ * structs, since each update and render function uses most of an effect's fields at once, and the render buckets
+ * point at them. */
+static std::vector<EFFECT *> activeEffects[EFFECT_FREED];
+static EFFECT_COUNTERS effectCounters;
 
 /* Tick counts for updates on a particular interval */
 static	UDWORD	lastUpdateStructures[EFFECT_STRUCTURE_DIVISION];
@@ -177,7 +190,22 @@ static bool updateDestruction(EFFECT *psEffect);
 static bool updateFire(EFFECT *psEffect);
 static bool updateSatLaser(EFFECT *psEffect);
 static bool updateFirework(EFFECT *psEffect);
-static bool updateEffect(EFFECT *psEffect);	// MASTER function
+
+typedef bool (*EFFECT_UPDATE_FUNC)(EFFECT *psEffect);
+/* Indexed by EFFECT_GROUP, return false if the effect should be deleted */
+static const EFFECT_UPDATE_FUNC effectUpdateFunctions[EFFECT_FREED] =
+{
+	updateExplosion,
+	updateConstruction,
+	updatePolySmoke,
+	updateGraviton,
+	updateWaypoint,
+	updateBlood,
+	updateDestruction,
+	updateSatLaser,
+	updateFire,
+	updateFirework,
+};
 
 // ----------------------------------------------------------------------------------------
 // ---- The render functions - every group type of effect has a distinct one
@@ -212,11 +240,68 @@ static UDWORD effectGetNumFrames(EFFECT *psEffect);
 
 void shutdownEffectsSystem()
 {
-	for (auto eff : activeList)
+	if (effectCounters.culled > 0)
 	{
-		delete eff;
+		debug(LOG_3D, "%u of %u effects were dropped to stay within %u effects", effectCounters.culled, effectCounters.spawned + effectCounters.culled, MAX_EFFECTS);
 	}
-	activeList.clear();
+	for (auto &effects : activeEffects)
+	{
+		effects.clear();
+	}
+	freeEffects.clear();
+	effectBlocks.clear();
+	effectCounters = EFFECT_COUNTERS();
+}
+
+EFFECT_COUNTERS effectGetCounters()
+{
+	return effectCounters;
+}
+
+/** Whether there is room for another effect of the group. Near the limit, effects which are only
+ *  decoration get dropped more and more often, so that the world does not suddenly stop smoking. */
+static bool effectHasRoom(EFFECT_GROUP group)
+{
+	const unsigned live = effectCounters.live;
+	if (live >= MAX_EFFECTS)
+	{
+		return false;
+	}
+	if (group == EFFECT_WAYPOINT || group == EFFECT_SAT_LASER || live < EFFECT_CULL_START)
+	{
+		return true;
+	}
+	return (unsigned)rand() % (MAX_EFFECTS - EFFECT_CULL_START) >= live - EFFECT_CULL_START;
+}
+
+/** Takes an effect from the pool and puts it into the world. There must be room for it. */
+static EFFECT *allocEffect(EFFECT_GROUP group)
+{
+	if (freeEffects.empty())
+	{
+		effectBlocks.emplace_back(new EFFECT[EFFECT_POOL_BLOCK]);
+		EFFECT *block = effectBlocks.back().get();
+		for (int i = EFFECT_POOL_BLOCK - 1; i >= 0; --i)
+		{
+			freeEffects.push_back(&block[i]);
+		}
+	}
+	EFFECT *psEffect = freeEffects.back();
+	freeEffects.pop_back();
+	*psEffect = EFFECT();
+	psEffect->group = group;
+	activeEffects[group].push_back(psEffect);
+	++effectCounters.live;
+	return psEffect;
+}
+
+/** Removes the effect at index i of its group, moving the last one of the group into its place. */
+static void freeEffect(std::vector<EFFECT *> &effects, size_t i)
+{
+	freeEffects.push_back(effects[i]);
+	effects[i] = effects.back();
+	effects.pop_back();
+	--effectCounters.live;
 }
 
 /*!
@@ -304,7 +389,15 @@ void addEffect(const Vector3i *pos, EFFECT_GROUP group, EFFECT_TYPE type, bool s
 	{
 		return;
 	}
-	EFFECT *psEffect = new EFFECT();
+	ASSERT_OR_RETURN(, group < EFFECT_FREED, "Weirdy group type for an effect");
+	if (!effectHasRoom(group))
+	{
+		SetEffectForPlayer(0);	// reset it, as if it had been added
+		++effectCounters.culled;
+		return;
+	}
+	EFFECT *psEffect = allocEffect(group);
+	++effectCounters.spawned;
 	/* Reset control bits */
 	psEffect->control = 0;
 
@@ -396,107 +489,44 @@ void addEffect(const Vector3i *pos, EFFECT_GROUP group, EFFECT_TYPE type, bool s
 	}
 
 	ASSERT(psEffect->imd != nullptr || group == EFFECT_DESTRUCTION || group == EFFECT_FIRE || group == EFFECT_SAT_LASER, "null effect imd");
-
-	activeList.push_back(psEffect);
 }
 
 
 /* Calls all the update functions for each different currently active effect */
 void processEffects(const glm::mat4 &viewMatrix)
 {
-	for (auto it = activeList.begin(); it != activeList.end(); )
+	for (int group = 0; group < EFFECT_FREED; ++group)
 	{
-		EFFECT *psEffect = *it;
+		std::vector<EFFECT *> &effects = activeEffects[group];
+		const EFFECT_UPDATE_FUNC update = effectUpdateFunctions[group];
+		// Only explosions carry on while paused.
+		const bool doUpdate = group == EFFECT_EXPLOSION || !gamePaused();
 
-		if (psEffect->birthTime <= graphicsTime)  // Don't process, if it doesn't exist yet
+		// Updates may add more effects to the end, which then get updated too.
+		for (size_t i = 0; i < effects.size(); )
 		{
-			if (!updateEffect(psEffect))
-			{
-				delete psEffect;
-				it = activeList.erase(it);
-				continue;
-			}
-			if (psEffect->group != EFFECT_FREED && clipXY(psEffect->position.x, psEffect->position.z))
+			EFFECT *psEffect = effects[i];
+
+			if (psEffect->birthTime <= graphicsTime)  // Don't process, if it doesn't exist yet
 			{
-				bucketAddTypeToList(RENDER_EFFECT, psEffect, viewMatrix);
+				if (doUpdate && !update(psEffect))
+				{
+					freeEffect(effects, i);
+					continue;
+				}
+				if (clipXY(psEffect->position.x, psEffect->position.z))
+				{
+					bucketAddTypeToList(RENDER_EFFECT, psEffect, viewMatrix);
+				}
 			}
+			++i;
 		}
-		++it;
 	}
 
 	/* Add any structure effects */
 	effectStructureUpdates();
 }
 
-/* The general update function for all effects - calls a specific one for each. Returns false if effect should be deleted. */
-static bool updateEffect(EFFECT *psEffect)
-{
-	/* What type of effect are we dealing with? */
-	switch (psEffect->group)
-	{
-	case EFFECT_EXPLOSION:
-		return updateExplosion(psEffect);
-	case EFFECT_WAYPOINT:
-		if (!gamePaused())
-		{
-			return updateWaypoint(psEffect);
-		}
-		return true;
-	case EFFECT_CONSTRUCTION:
-		if (!gamePaused())
-		{
-			return updateConstruction(psEffect);
-		}
-		return true;
-	case EFFECT_SMOKE:
-		if (!gamePaused())
-		{
-			return updatePolySmoke(psEffect);
-		}
-		return true;
-	case EFFECT_GRAVITON:
-		if (!gamePaused())
-		{
-			return updateGraviton(psEffect);
-		}
-		return true;
-	case EFFECT_BLOOD:
-		if (!gamePaused())
-		{
-			return updateBlood(psEffect);
-		}
-		return true;
-	case EFFECT_DESTRUCTION:
-		if (!gamePaused())
-		{
-			return updateDestruction(psEffect);
-		}
-		return true;
-	case EFFECT_FIRE:
-		if (!gamePaused())
-		{
-			return updateFire(psEffect);
-		}
-		return true;
-	case EFFECT_SAT_LASER:
-		if (!gamePaused())
-		{
-			return updateSatLaser(psEffect);
-		}
-		return true;
-	case EFFECT_FIREWORK:
-		if (!gamePaused())
-		{
-			return updateFirework(psEffect);
-		}
-		return true;
-	case EFFECT_FREED:
-		break;
-	}
-	debug(LOG_ERROR, "Weirdy class of effect passed to updateEffect");
-	abort();
-}
-
 // ----------------------------------------------------------------------------------------
 // ALL THE UPDATE FUNCTIONS
 // ----------------------------------------------------------------------------------------
@@ -2220,34 +2250,37 @@ bool writeFXData(const char *fileName)
 {
 	int i = 0;
 	WzConfig ini(WzString::fromUtf8(fileName), WzConfig::ReadAndWrite);
-	for (auto iter = activeList.cbegin(); iter != activeList.end(); ++iter, i++)
-	{
-		EFFECT *it = *iter;
-		ini.beginGroup("effect_" + WzString::number(i));
-		ini.setValue("control", it->control);
-		ini.setValue("group", it->group);
-		ini.setValue("type", it->type);
-		ini.setValue("frameNumber", it->frameNumber);
-		ini.setValue("size", it->size);
-		ini.setValue("baseScale", it->baseScale);
-		ini.setValue("specific", it->specific);
-		ini.setVector3f("position", it->position);
-		ini.setVector3f("velocity", it->velocity);
-		ini.setVector3i("rotation", it->rotation);
-		ini.setVector3i("spin", it->spin);
-		ini.setValue("birthTime", it->birthTime);
-		ini.setValue("lastFrame", it->lastFrame);
-		ini.setValue("frameDelay", it->frameDelay);
-		ini.setValue("lifeSpan", it->lifeSpan);
-		ini.setValue("radius", it->radius);
-
-		if (it->imd)
-		{
-			ini.setValue("imd_name", modelName(it->imd));
-		}
+	for (auto const &effects : activeEffects)
+	{
+		for (EFFECT const *it : effects)
+		{
+			ini.beginGroup("effect_" + WzString::number(i));
+			ini.setValue("control", it->control);
+			ini.setValue("group", it->group);
+			ini.setValue("type", it->type);
+			ini.setValue("frameNumber", it->frameNumber);
+			ini.setValue("size", it->size);
+			ini.setValue("baseScale", it->baseScale);
+			ini.setValue("specific", it->specific);
+			ini.setVector3f("position", it->position);
+			ini.setVector3f("velocity", it->velocity);
+			ini.setVector3i("rotation", it->rotation);
+			ini.setVector3i("spin", it->spin);
+			ini.setValue("birthTime", it->birthTime);
+			ini.setValue("lastFrame", it->lastFrame);
+			ini.setValue("frameDelay", it->frameDelay);
+			ini.setValue("lifeSpan", it->lifeSpan);
+			ini.setValue("radius", it->radius);
+
+			if (it->imd)
+			{
+				ini.setValue("imd_name", modelName(it->imd));
+			}
 
-		// Move on to reading the next effect
-		ini.endGroup();
+			// Move on to reading the next effect
+			ini.endGroup();
+			i++;
+		}
 	}
 
 	// Everything is just fine!
@@ -2266,10 +2299,15 @@ bool readFXData(const char *fileName)
 	for (int i = 0; i < list.size(); ++i)
 	{
 		ini.beginGroup(list[i]);
-		EFFECT *curEffect = new EFFECT();
+		const EFFECT_GROUP group = (EFFECT_GROUP)ini.value("group").toInt();
+		if (group < 0 || group >= EFFECT_FREED || effectCounters.live >= MAX_EFFECTS)
+		{
+			ini.endGroup();
+			continue;
+		}
+		EFFECT *curEffect = allocEffect(group);
 
 		curEffect->control      = ini.value("control").toInt();
-		curEffect->group        = (EFFECT_GROUP)ini.value("group").toInt();
 		curEffect->type         = (EFFECT_TYPE)ini.value("type").toInt();
 		curEffect->frameNumber  = ini.value("frameNumber").toInt();
 		curEffect->size         = ini.value("size").toInt();
@@ -2299,8 +2337,6 @@ bool readFXData(const char *fileName)
 
 		// Move on to reading the next effect
 		ini.endGroup();
-
-		activeList.push_back(curEffect);
 	}
 
 	/* Hopefully everything's just fine by now */
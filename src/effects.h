@@ -139,11 +139,17 @@ struct EFFECT
 	uint16_t          lifeSpan;    // what is it's life expectancy?
 	uint16_t          radius;      // Used for area effects
 	iIMDShape         *imd;        // pointer to the imd the effect uses.
-	EFFECT *prev, *next; // Previous and next element in linked list
 
 	EFFECT() : player(MAX_PLAYERS), control(0), group(EFFECT_FREED), type(EXPLOSION_TYPE_SMALL), frameNumber(0), size(0),
 	           baseScale(0), specific(0), position(0.f, 0.f, 0.f), velocity(0.f, 0.f, 0.f), rotation(0, 0, 0), spin(0, 0, 0), birthTime(0), lastFrame(0), frameDelay(0), lifeSpan(0), radius(0),
-	           imd(nullptr), prev(nullptr), next(nullptr) {}
+	           imd(nullptr) {}
+};
+
+struct EFFECT_COUNTERS
+{
+	unsigned live = 0;     ///< Effects currently in the world.
+	unsigned spawned = 0;  ///< Effects added since the effects system was started.
+	unsigned culled = 0;   ///< Effects not added, to stay within the effect limit.
 };
 
 /* Maximum number of effects in the world - need to investigate what this should be */
@@ -168,5 +174,6 @@ bool	writeFXData(const char *fileName);
 void	effectSetSize(UDWORD size);
 void	effectSetLandLightSpec(LAND_LIGHT_SPEC spec);
 void	SetEffectForPlayer(uint8_t player);
+EFFECT_COUNTERS effectGetCounters();
 
 #endif // __INCLUDED_SRC_EFFECTS_H__
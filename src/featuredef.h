@@ -69,6 +69,9 @@ struct FEATURE : public BASE_OBJECT
 	FEATURE(uint32_t id, FEATURE_STATS const *psStats);
 	~FEATURE();
 
+	static void *operator new(size_t size);                 ///< Allocated from a pool, see objmem.cpp.
+	static void operator delete(void *object, size_t size);
+
 	FEATURE_STATS const *psStats;
 
 	inline Vector2i size() const { return psStats->size(); }
@@ -37,12 +37,17 @@
 #include "map.h"
 #include "multiplay.h"
 #include "astar.h"
+#include "benchmark.h"
+#include "warzoneconfig.h"
 
 #include "fpath.h"
 
 // If the path finding system is shutdown or not
 static volatile bool fpathQuit = false;
 
+// Whether to plan long routes on the cluster hierarchy
+static bool fpathHierarchical = false;
+
 /* Beware: Enabling this will cause significant slow-down. */
 #undef DEBUG_MAP
 
@@ -56,21 +61,18 @@ struct PATHRESULT
 
 
 // threading stuff
-static WZ_THREAD        *fpathThread = nullptr;
+using packagedPathJob = wz::packaged_task<PATHRESULT()>;
+static std::vector<WZ_THREAD *> fpathThreads;
 static WZ_MUTEX         *fpathMutex = nullptr;
 static WZ_SEMAPHORE     *fpathSemaphore = nullptr;
-using packagedPathJob = wz::packaged_task<PATHRESULT()>;
 static std::list<packagedPathJob>    pathJobs;
 static std::unordered_map<uint32_t, wz::future<PATHRESULT>> pathResults;
-
-static bool             waitingForResult = false;
-static uint32_t         waitingForResultId;
-static WZ_SEMAPHORE     *waitingForResultSemaphore = nullptr;
+static uint32_t         pathJobSequence = 0;  ///< Sequence number for the next job, see fpathAStarRoute().
 
 static PATHRESULT fpathExecute(PATHJOB psJob);
 
 
-/** This runs in a separate thread */
+/** This runs in a separate thread, one of fpathThreads */
 static int fpathThreadFunc(void *)
 {
 	wzMutexLock(fpathMutex);
@@ -79,24 +81,19 @@ static int fpathThreadFunc(void *)
 	{
 		if (pathJobs.empty())
 		{
-			ASSERT(!waitingForResult, "Waiting for a result (id %u) that doesn't exist.", waitingForResultId);
 			wzMutexUnlock(fpathMutex);
 			wzSemaphoreWait(fpathSemaphore);  // Go to sleep until needed.
 			wzMutexLock(fpathMutex);
 			continue;
 		}
 
-		// Copy the first job from the queue.
+		// Copy the first job from the queue. Whichever thread is free takes the next job.
 		packagedPathJob job = std::move(pathJobs.front());
 		pathJobs.pop_front();
 
 		wzMutexUnlock(fpathMutex);
 		job();
 		wzMutexLock(fpathMutex);
-
-		waitingForResult = false;
-		objTrace(waitingForResultId, "These are the droids you are looking for.");
-		wzSemaphorePost(waitingForResultSemaphore);
 	}
 	wzMutexUnlock(fpathMutex);
 	return 0;
@@ -108,14 +105,25 @@ bool fpathInitialise()
 {
 	// The path system is up
 	fpathQuit = false;
+	fpathHierarchical = war_GetHierarchicalPathfinding();
 
-	if (!fpathThread)
+	if (fpathThreads.empty())
 	{
+		int numThreads = war_GetPathThreads();
+		if (numThreads <= 0)
+		{
+			numThreads = std::max(wzGetCPUCount() - 1, 1);  // Leave one core for the main thread.
+		}
+		debug(LOG_INFO, "Using %d path-finding threads.", numThreads);
+
 		fpathMutex = wzMutexCreate();
 		fpathSemaphore = wzSemaphoreCreate(0);
-		waitingForResultSemaphore = wzSemaphoreCreate(0);
-		fpathThread = wzThreadCreate(fpathThreadFunc, nullptr);
-		wzThreadStart(fpathThread);
+		for (int i = 0; i < numThreads; ++i)
+		{
+			WZ_THREAD *thread = wzThreadCreate(fpathThreadFunc, nullptr);
+			wzThreadStart(thread);
+			fpathThreads.push_back(thread);
+		}
 	}
 
 	return true;
@@ -124,20 +132,31 @@ bool fpathInitialise()
 
 void fpathShutdown()
 {
-	if (fpathThread)
+	if (!fpathThreads.empty())
 	{
-		// Signal the path finding thread to quit
+		unsigned hits, misses;
+		fpathRouteCacheStats(&hits, &misses);
+		debug(LOG_INFO, "Path route cache: %u hits, %u misses", hits, misses);
+
+		// Signal the path finding threads to quit
 		fpathQuit = true;
-		wzSemaphorePost(fpathSemaphore);  // Wake up thread.
+		for (size_t i = 0; i < fpathThreads.size(); ++i)
+		{
+			wzSemaphorePost(fpathSemaphore);  // Wake up threads.
+		}
 
-		wzThreadJoin(fpathThread);
-		fpathThread = nullptr;
+		for (WZ_THREAD *thread : fpathThreads)
+		{
+			wzThreadJoin(thread);
+		}
+		fpathThreads.clear();
+		pathJobs.clear();  // Jobs left over were never started, so the next job can be number 0 again.
+		pathResults.clear();
+		pathJobSequence = 0;
 		wzMutexDestroy(fpathMutex);
 		fpathMutex = nullptr;
 		wzSemaphoreDestroy(fpathSemaphore);
 		fpathSemaphore = nullptr;
-		wzSemaphoreDestroy(waitingForResultSemaphore);
-		waitingForResultSemaphore = nullptr;
 	}
 	fpathHardTableReset();
 }
@@ -153,6 +172,17 @@ void fpathUpdate()
 }
 
 
+void fpathSetHierarchical(bool enable)
+{
+	fpathHierarchical = enable;
+}
+
+bool fpathGetHierarchical()
+{
+	return fpathHierarchical && !(bMultiPlayer && NetPlay.bComms);
+}
+
+
 bool fpathIsEquivalentBlocking(PROPULSION_TYPE propulsion1, int player1, FPATH_MOVETYPE moveType1,
                                PROPULSION_TYPE propulsion2, int player2, FPATH_MOVETYPE moveType2)
 {
@@ -380,6 +410,7 @@ queuePathfinding:
 	job.moveType = moveType;
 	job.owner = owner;
 	job.acceptNearest = acceptNearest;
+	job.hierarchical = fpathGetHierarchical() && fpathCheck(Position(startX, startY, 0), Position(tX, tY, 0), propulsionType);
 	job.deleted = false;
 	fpathSetBlockingMap(&job);
 
@@ -388,6 +419,7 @@ queuePathfinding:
 	// job or result for each droid in the system at any time.
 	fpathRemoveDroidData(id);
 
+	job.sequence = pathJobSequence++;
 	packagedPathJob task([job]() { return fpathExecute(job); });
 	pathResults[id] = task.get_future();
 
@@ -397,12 +429,9 @@ queuePathfinding:
 	pathJobs.push_back(std::move(task));
 	wzMutexUnlock(fpathMutex);
 
-	if (isFirstJob)
-	{
-		wzSemaphorePost(fpathSemaphore);  // Wake up processing thread.
-	}
+	wzSemaphorePost(fpathSemaphore);  // Wake up a processing thread.
 
-	objTrace(id, "Queued up a path-finding request to (%d, %d), at least %d items earlier in queue", tX, tY, isFirstJob);
+	objTrace(id, "Queued up a path-finding request to (%d, %d), at least %d items earlier in queue", tX, tY, !isFirstJob);
 	syncDebug("fpathRoute(..., %d, %d, %d, %d, %d, %d, %d, %d, %d) = FPR_WAIT", id, startX, startY, tX, tY, propulsionType, droidType, moveType, owner);
 	return FPR_WAIT;	// wait while polling result queue
 }
@@ -455,6 +484,8 @@ FPATH_RETVAL fpathDroidRoute(DROID *psDroid, SDWORD tX, SDWORD tY, FPATH_MOVETYP
 // Run only from path thread
 PATHRESULT fpathExecute(PATHJOB job)
 {
+	BenchmarkTimer timer(BENCH_PATHFINDING);
+
 	PATHRESULT result;
 	result.droidID = job.droidID;
 	result.retval = FPR_FAILED;
@@ -539,10 +570,10 @@ void fpathTest(int x, int y, int x2, int y2)
 	(void)fpathJobQueueLength();
 
 	/* Check initial state */
-	assert(fpathThread != nullptr);
+	assert(!fpathThreads.empty());
 	assert(fpathMutex != nullptr);
 	assert(fpathSemaphore != nullptr);
-	assert(pathJobs.empty());
+	assert(fpathJobQueueLength() == 0);
 	assert(pathResults.empty());
 	fpathRemoveDroidData(0);	// should not crash
 
@@ -56,6 +56,8 @@ struct PATHJOB
 	int		owner;		///< Player owner
 	std::shared_ptr<PathBlockingMap> blockingMap;   ///< Map of blocking tiles.
 	bool		acceptNearest;
+	bool            hierarchical;   ///< Try planning the route on the cluster hierarchy first. Only set if the start and destination are on the same continent.
+	uint32_t        sequence;       ///< Number of jobs queued before this one, since fpathShutdown(). Decides the order in which jobs use the cached contexts.
 	bool            deleted;        ///< Droid was deleted, so throw away result when complete. Must still process this PATHJOB, since processing order can affect resulting paths (but can't affect the path length).
 };
 
@@ -76,6 +78,12 @@ void fpathShutdown();
 
 void fpathUpdate();
 
+/** Enable or disable planning long routes on a hierarchy of map clusters before refining them with A*.
+ *  Changes the resulting paths, so it is ignored in networked games.
+ */
+void fpathSetHierarchical(bool enable);
+bool fpathGetHierarchical();
+
 /** Find a route for a droid to a location.
  */
 FPATH_RETVAL fpathDroidRoute(DROID *psDroid, SDWORD targetX, SDWORD targetY, FPATH_MOVETYPE moveType);
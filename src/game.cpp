@@ -29,6 +29,8 @@
 #include "lib/framework/wzconfig.h"
 #include "lib/framework/file.h"
 #include "lib/framework/physfs_ext.h"
+#include "lib/framework/savewriter.h"
+#include "lib/framework/binaryjson.h"
 #include "lib/framework/strres.h"
 #include "lib/framework/opengl.h"
 
@@ -92,8 +94,10 @@
 #include "lib/ivis_opengl/screen.h"
 #include "keymap.h"
 #include <ctime>
+#include <chrono>
 #include "multimenu.h"
 #include "console.h"
+#include "visibility.h"
 
 
 void gameScreenSizeDidChange(unsigned int oldWidth, unsigned int oldHeight, unsigned int newWidth, unsigned int newHeight)
@@ -1836,6 +1840,9 @@ bool loadGame(const char *pGameToLoad, bool keepObjects, bool freeMem, bool User
 	UWORD           missionScrollMinX = 0, missionScrollMinY = 0,
 	                missionScrollMaxX = 0, missionScrollMaxY = 0;
 
+	// The game being loaded might still be being written.
+	saveWriterWait();
+
 	/* Stop the game clock */
 	gameTimeStop();
 
@@ -1877,6 +1884,7 @@ bool loadGame(const char *pGameToLoad, bool keepObjects, bool freeMem, bool User
 			apsExtractorLists[player] = nullptr;
 		}
 		apsOilList[0] = nullptr;
+		visSensorListChanged();
 		initFactoryNumFlag();
 	}
 
@@ -2647,6 +2655,33 @@ error:
 }
 // -----------------------------------------------------------------------------------------
 
+/// Counts calls to saveGame(), so that a failed save does not remove files a later save has started writing.
+static unsigned saveGameCount = 0;
+
+/// Reports how writing the savegame went, once the save writer is done with it.
+/// A savegame missing files cannot be loaded, so a partly written one is removed.
+static std::function<void (bool)> saveGameWritten(const char *aFileName)
+{
+	std::string name = aFileName;
+	unsigned count = saveGameCount;
+	return [name, count](bool ok)
+	{
+		if (ok)
+		{
+			debug(LOG_SAVE, "Savegame %s written", name.c_str());
+			return;
+		}
+		debug(LOG_ERROR, "Savegame %s could not be written completely", name.c_str());
+		addConsoleMessage(_("Saving the game failed!"), DEFAULT_JUSTIFY, SYSTEM_MESSAGE);
+		if (count == saveGameCount)
+		{
+			char saveName[PATH_MAX];
+			sstrcpy(saveName, name.c_str());
+			deleteSaveGame(saveName);
+		}
+	};
+}
+
 bool saveGame(const char *aFileName, GAME_TYPE saveType)
 {
 	UDWORD			fileExtension;
@@ -2656,6 +2691,7 @@ bool saveGame(const char *aFileName, GAME_TYPE saveType)
 	triggerEvent(TRIGGER_GAME_SAVING);
 
 	ASSERT_OR_RETURN(false, aFileName && strlen(aFileName) > 4, "Bad savegame filename");
+	saveGameCount++;
 	sstrcpy(CurrentFileName, aFileName);
 	debug(LOG_WZ, "saveGame: %s", CurrentFileName);
 
@@ -2663,6 +2699,9 @@ bool saveGame(const char *aFileName, GAME_TYPE saveType)
 	gameTimeStop();
 	sanityUpdate();
 
+	// Everything below is gathered now, then formatted and written by the save writer thread.
+	saveWriterBegin(war_GetBinarySaves());
+
 	/* Write the data to the file */
 	if (!writeGameFile(CurrentFileName, saveType))
 	{
@@ -2934,18 +2973,116 @@ bool saveGame(const char *aFileName, GAME_TYPE saveType)
 	// strip the last filename
 	CurrentFileName[fileExtension - 1] = '\0';
 
+	// Returns without waiting for the files, failing to write them is reported by saveGameWritten().
+	saveWriterEnd(saveGameWritten(aFileName));
+
 	/* Start the game clock */
 	triggerEvent(TRIGGER_GAME_SAVED);
 	gameTimeStart();
 	return true;
 
 error:
+	// What was gathered so far is not a usable savegame, have it removed once the writer is done with it.
+	{
+		std::function<void (bool)> written = saveGameWritten(aFileName);
+		saveWriterEnd([written](bool) { written(false); });
+	}
+
 	/* Start the game clock */
 	gameTimeStart();
 
 	return false;
 }
 
+// -----------------------------------------------------------------------------------------
+bool convertSaveGame(const char *saveName)
+{
+	std::string dir = saveName;
+	if (dir.size() > 4 && dir.compare(dir.size() - 4, 4, ".gam") == 0)
+	{
+		dir.resize(dir.size() - 4);
+	}
+	if (!WZ_PHYSFS_isDirectory(dir.c_str()))
+	{
+		debug(LOG_ERROR, "%s is not a savegame", saveName);
+		return false;
+	}
+
+	typedef std::chrono::steady_clock Clock;
+	auto ms = [](Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+	size_t totalJsonSize = 0, totalBinarySize = 0;
+	double totalTimes[4] = {0, 0, 0, 0};
+	bool ok = true;
+
+	fprintf(stdout, "%-20s %12s %12s %10s %10s %10s %10s\n", "file", "JSON bytes", "binary bytes", "JSON save", "bin save", "JSON load", "bin load");
+	char **files = PHYSFS_enumerateFiles(dir.c_str());
+	for (char **i = files; *i != nullptr; ++i)
+	{
+		std::string fileName = dir + "/" + *i;
+		char *data = nullptr;
+		UDWORD size = 0;
+		if (WZ_PHYSFS_isDirectory(fileName.c_str()) || !loadFile(fileName.c_str(), &data, &size))
+		{
+			continue;
+		}
+		const bool wasBinary = binaryJsonDetect(data, size);
+		nlohmann::json root;
+		if (wasBinary)
+		{
+			if (!binaryJsonDecode(data, size, root))
+			{
+				debug(LOG_ERROR, "%s is broken", fileName.c_str());
+				ok = false;
+			}
+		}
+		else
+		{
+			root = nlohmann::json::parse(data, data + size, nullptr, false);
+		}
+		free(data);
+		if (!root.is_object())
+		{
+			continue;  // Not one of the JSON files, such as game.map.
+		}
+
+		// Both forms are made the way WzConfig writes and reads them, to compare them fairly.
+		Clock::time_point start = Clock::now();
+		std::string text = root.dump(4) + "\n";
+		Clock::time_point textSaved = Clock::now();
+		std::string binary = binaryJsonEncode(root);
+		Clock::time_point binarySaved = Clock::now();
+		nlohmann::json textLoaded = nlohmann::json::parse(text);
+		Clock::time_point textLoadedTime = Clock::now();
+		nlohmann::json binaryLoaded;
+		binaryJsonDecode(binary.data(), binary.size(), binaryLoaded);
+		Clock::time_point binaryLoadedTime = Clock::now();
+
+		if (binaryLoaded != root)
+		{
+			debug(LOG_ERROR, "%s did not survive the binary form, leaving it alone", fileName.c_str());
+			ok = false;
+			continue;
+		}
+		const std::string &converted = wasBinary ? text : binary;
+		if (!saveFile(fileName.c_str(), converted.data(), converted.size()))
+		{
+			ok = false;
+		}
+
+		const double times[4] = {ms(textSaved - start), ms(binarySaved - textSaved), ms(textLoadedTime - binarySaved), ms(binaryLoadedTime - textLoadedTime)};
+		fprintf(stdout, "%-20s %12zu %12zu %10.2f %10.2f %10.2f %10.2f\n", *i, text.size(), binary.size(), times[0], times[1], times[2], times[3]);
+		totalJsonSize += text.size();
+		totalBinarySize += binary.size();
+		for (int t = 0; t < 4; ++t)
+		{
+			totalTimes[t] += times[t];
+		}
+	}
+	PHYSFS_freeList(files);
+	fprintf(stdout, "%-20s %12zu %12zu %10.2f %10.2f %10.2f %10.2f\n", "total", totalJsonSize, totalBinarySize, totalTimes[0], totalTimes[1], totalTimes[2], totalTimes[3]);
+	return ok;
+}
+
 // -----------------------------------------------------------------------------------------
 static bool writeMapFile(const char *fileName)
 {
@@ -5020,7 +5157,7 @@ bool loadSaveStructure(char *pFileData, UDWORD filesize)
 		}
 		// The original code here didn't work and so the scriptwriters worked round it by using the module ID - so making it work now will screw up
 		// the scripts -so in ALL CASES overwrite the ID!
-		psStructure->id = psSaveStructure->id > 0 ? psSaveStructure->id : 0xFEDBCA98; // hack to remove struct id zero
+		setBaseObjId(psStructure, psSaveStructure->id > 0 ? psSaveStructure->id : 0xFEDBCA98); // hack to remove struct id zero
 		psStructure->periodicalDamage = psSaveStructure->periodicalDamage;
 		periodicalDamageTime = psSaveStructure->periodicalDamageStart;
 		psStructure->periodicalDamageStart = periodicalDamageTime;
@@ -5142,7 +5279,7 @@ static bool loadSaveStructure2(const char *pFileName, STRUCTURE **ppList)
 		}
 		if (id > 0)
 		{
-			psStructure->id = id;	// force correct ID
+			setBaseObjId(psStructure, id);	// force correct ID
 		}
 
 		// common BASE_OBJECT info
@@ -5346,7 +5483,7 @@ bool writeGameInfo(const char *pFileName)
 	ini.setValue("openGL_GLEW_version", opengl.GLEWversion);
 	ini.setValue("openGL_GLSL_version", opengl.GLSLversion);
 	// NOTE: deprecated for GL 3+. Needed this to check what extensions some chipsets support for the openGL hacks
-	std::string extensions = (const char *) glGetString(GL_EXTENSIONS);
+	std::string extensions = wzIsHeadless() ? "" : (const char *) glGetString(GL_EXTENSIONS);
 	ini.setValue("GL_EXTENSIONS", extensions.data());
 	ini.endGroup();
 	return true;
@@ -121,6 +121,8 @@ bool loadScriptState(char *pFileName);
 bool loadTerrainTypeMap(char *pFileData, UDWORD filesize);
 
 bool saveGame(const char *aFileName, GAME_TYPE saveType);
+/// Rewrites the JSON files of a savegame in binary form, or the other way round, printing how long each takes to save and load in either form.
+bool convertSaveGame(const char *saveName);
 
 // Get the campaign number for loadGameInit game
 UDWORD getCampaign(const char *fileName);
@@ -1019,6 +1019,7 @@ bool stageOneShutDown()
 
 	scrShutDown();
 	gridShutDown();
+	visShutdown();
 
 	debug(LOG_TEXTURE, "== stageOneShutDown ==");
 	modelShutdown();
@@ -74,6 +74,8 @@
 #include "mapgrid.h"
 #include "order.h"
 #include "selection.h"
+#include "fpath.h"
+#include "visibility.h"
 #include "difficulty.h"
 #include "scriptcb.h"		/* for console callback */
 #include "scriptfuncs.h"
@@ -187,6 +189,30 @@ void kf_ForceDesync()
 	syncDebug("Oh no!!! I went out of sync!!!");
 }
 
+void kf_ToggleVisibilitySelfCheck()
+{
+	visSetSelfCheck(!visGetSelfCheck());
+	console("Visibility self-check %s%s", visGetSelfCheck() ? "enabled" : "disabled", visIsParallel() ? "" : " (but visibility is not parallel)");
+}
+
+void kf_ToggleHierarchicalPathfinding()
+{
+	if (runningMultiplayer())
+	{
+		CONPRINTF("%s", _("Cannot change the path-finding method in a network game"));
+		return;
+	}
+	fpathSetHierarchical(!fpathGetHierarchical());
+	if (fpathGetHierarchical())
+	{
+		CONPRINTF("%s", _("Hierarchical path-finding enabled"));
+	}
+	else
+	{
+		CONPRINTF("%s", _("Hierarchical path-finding disabled"));
+	}
+}
+
 void	kf_PowerInfo()
 {
 	int i;
@@ -638,8 +664,11 @@ void kf_ToggleOrders()	// Displays orders & action of currently selected unit.
 /* Writes out the frame rate */
 void	kf_FrameRate()
 {
-	CONPRINTF("FPS %d; PIEs %d; polys %d",
-	                          frameRate(), loopPieCount, loopPolyCount);
+	CONPRINTF("FPS %d; PIEs %d; polys %d; draw calls %d; state changes %d",
+	                          frameRate(), loopPieCount, loopPolyCount, loopDrawCallCount, loopStateChangeCount);
+	CONPRINTF("Terrain: sectors %d; triangles %d", loopTerrainSectorCount, loopTerrainTriangleCount);
+	const EFFECT_COUNTERS effects = effectGetCounters();
+	CONPRINTF("Effects: live %u; spawned %u; dropped %u", effects.live, effects.spawned, effects.culled);
 	if (runningMultiplayer())
 	{
 		CONPRINTF("NETWORK:  Bytes: s-%d r-%d  Uncompressed Bytes: s-%d r-%d  Packets: s-%d r-%d",
@@ -256,6 +256,8 @@ void kf_ToggleRadarAllyEnemy();          //enemy/ally color toggle
 void kf_TileInfo();
 
 void kf_NoAssert();
+void kf_ToggleHierarchicalPathfinding();
+void kf_ToggleVisibilitySelfCheck();
 
 void kf_RevealMapAtPos();
 
@@ -43,6 +43,7 @@
 #include "lib/netplay/netplay.h"
 
 #include "loop.h"
+#include "benchmark.h"
 #include "objects.h"
 #include "display.h"
 #include "map.h"
@@ -51,6 +52,7 @@
 #include "miscimd.h"
 #include "effects.h"
 #include "radar.h"
+#include "terrain.h"
 #include "projectile.h"
 #include "console.h"
 #include "power.h"
@@ -102,6 +104,10 @@ static void fireWaitingCallbacks();
  */
 unsigned int loopPieCount;
 unsigned int loopPolyCount;
+unsigned int loopDrawCallCount;
+unsigned int loopStateChangeCount;
+unsigned int loopTerrainSectorCount;
+unsigned int loopTerrainTriangleCount;
 
 /*
  * local variables
@@ -133,6 +139,46 @@ LOOP_MISSION_STATE		loopMissionState = LMS_NORMAL;
 // this is set by scrStartMission to say what type of new level is to be started
 LEVEL_TYPE nextMissionType = LDS_NONE;
 
+/// Advance loopMissionState, returns GAMECODE_CONTINUE unless the game loop has to stop.
+static GAMECODE updateMissionState()
+{
+	switch (loopMissionState)
+	{
+	case LMS_CLEAROBJECTS:
+		missionDestroyObjects();
+		setScriptPause(true);
+		loopMissionState = LMS_SETUPMISSION;
+		break;
+
+	case LMS_NORMAL:
+		// default
+		break;
+	case LMS_SETUPMISSION:
+		setScriptPause(false);
+		if (!setUpMission(nextMissionType))
+		{
+			return GAMECODE_QUITGAME;
+		}
+		break;
+	case LMS_SAVECONTINUE:
+		// just wait for this to be changed when the new mission starts
+		break;
+	case LMS_NEWLEVEL:
+		//nextMissionType = MISSION_NONE;
+		nextMissionType = LDS_NONE;
+		return GAMECODE_NEWLEVEL;
+		break;
+	case LMS_LOADGAME:
+		return GAMECODE_LOADGAME;
+		break;
+	default:
+		ASSERT(false, "unknown loopMissionState");
+		break;
+	}
+
+	return GAMECODE_CONTINUE;
+}
+
 static GAMECODE renderLoop()
 {
 	if (bMultiPlayer && !NetPlay.isHostAlive && NetPlay.bComms && !NetPlay.isHost)
@@ -340,6 +386,8 @@ static GAMECODE renderLoop()
 	wzSetCursor(cursor);
 
 	pie_GetResetCounts(&loopPieCount, &loopPolyCount);
+	pie_GetResetDrawCounts(&loopDrawCallCount, &loopStateChangeCount);
+	terrainGetResetCounts(&loopTerrainSectorCount, &loopTerrainTriangleCount);
 
 	if (!quitting)
 	{
@@ -352,38 +400,10 @@ static GAMECODE renderLoop()
 	}
 
 	// deal with the mission state
-	switch (loopMissionState)
+	GAMECODE missionCode = updateMissionState();
+	if (missionCode != GAMECODE_CONTINUE)
 	{
-	case LMS_CLEAROBJECTS:
-		missionDestroyObjects();
-		setScriptPause(true);
-		loopMissionState = LMS_SETUPMISSION;
-		break;
-
-	case LMS_NORMAL:
-		// default
-		break;
-	case LMS_SETUPMISSION:
-		setScriptPause(false);
-		if (!setUpMission(nextMissionType))
-		{
-			return GAMECODE_QUITGAME;
-		}
-		break;
-	case LMS_SAVECONTINUE:
-		// just wait for this to be changed when the new mission starts
-		break;
-	case LMS_NEWLEVEL:
-		//nextMissionType = MISSION_NONE;
-		nextMissionType = LDS_NONE;
-		return GAMECODE_NEWLEVEL;
-		break;
-	case LMS_LOADGAME:
-		return GAMECODE_LOADGAME;
-		break;
-	default:
-		ASSERT(false, "unknown loopMissionState");
-		break;
+		return missionCode;
 	}
 
 	int clearMode = 0;
@@ -544,6 +564,8 @@ static void gameStateUpdate()
 
 	if (!paused && !scriptPaused())
 	{
+		BenchmarkTimer timer(BENCH_SCRIPTS);
+
 		/* Update the event system */
 		if (!bInTutorial)
 		{
@@ -566,7 +588,10 @@ static void gameStateUpdate()
 	gridReset();
 
 	// Check which objects are visible.
-	processVisibility();
+	{
+		BenchmarkTimer timer(BENCH_VISIBILITY);
+		processVisibility();
+	}
 
 	// Update the map.
 	mapUpdate();
@@ -584,22 +609,26 @@ static void gameStateUpdate()
 		//update the current power available for a player
 		updatePlayerPower(i);
 
-		DROID *psNext;
-		for (DROID *psCurr = apsDroidLists[i]; psCurr != nullptr; psCurr = psNext)
 		{
-			// Copy the next pointer - not 100% sure if the droid could get destroyed but this covers us anyway
-			psNext = psCurr->psNext;
-			droidUpdate(psCurr);
-		}
+			BenchmarkTimer timer(BENCH_DROIDS);
+			DROID *psNext;
+			for (DROID *psCurr = apsDroidLists[i]; psCurr != nullptr; psCurr = psNext)
+			{
+				// Copy the next pointer - not 100% sure if the droid could get destroyed but this covers us anyway
+				psNext = psCurr->psNext;
+				droidUpdate(psCurr);
+			}
 
-		for (DROID *psCurr = mission.apsDroidLists[i]; psCurr != nullptr; psCurr = psNext)
-		{
-			/* Copy the next pointer - not 100% sure if the droid could
-			get destroyed but this covers us anyway */
-			psNext = psCurr->psNext;
-			missionDroidUpdate(psCurr);
+			for (DROID *psCurr = mission.apsDroidLists[i]; psCurr != nullptr; psCurr = psNext)
+			{
+				/* Copy the next pointer - not 100% sure if the droid could
+				get destroyed but this covers us anyway */
+				psNext = psCurr->psNext;
+				missionDroidUpdate(psCurr);
+			}
 		}
 
+		BenchmarkTimer timer(BENCH_STRUCTURES);
 		// FIXME: These for-loops are code duplicationo
 		STRUCTURE *psNBuilding;
 		for (STRUCTURE *psCBuilding = apsStructLists[i]; psCBuilding != nullptr; psCBuilding = psNBuilding)
@@ -618,7 +647,10 @@ static void gameStateUpdate()
 
 	missionTimerUpdate();
 
-	proj_UpdateAll();
+	{
+		BenchmarkTimer timer(BENCH_PROJECTILES);
+		proj_UpdateAll();
+	}
 
 	FEATURE *psNFeat;
 	for (FEATURE *psCFeat = apsFeatureLists[0]; psCFeat; psCFeat = psNFeat)
@@ -646,6 +678,20 @@ static void gameStateUpdate()
 	}
 }
 
+/// Stands in for renderLoop() when running headless, there is nothing to draw and no user input to handle.
+static GAMECODE headlessLoop()
+{
+	if (bMultiPlayer && !gameUpdatePaused())
+	{
+		multiPlayerLoop();
+	}
+	if (!consolePaused())
+	{
+		updateConsoleMessages();
+	}
+	return updateMissionState();
+}
+
 /* The main game loop */
 GAMECODE gameLoop()
 {
@@ -659,6 +705,10 @@ GAMECODE gameLoop()
 	// Shouldn't this be when initialising the game, rather than randomly called between ticks?
 	countUpdate(false); // kick off with correct counts
 
+	const bool headless = wzIsHeadless();
+	const unsigned loopStart = wzGetTicks();
+	bool ticked = false;
+
 	while (true)
 	{
 		// Receive NET_BLAH messages.
@@ -666,7 +716,7 @@ GAMECODE gameLoop()
 		recvMessage();
 
 		// Update gameTime and graphicsTime, and corresponding deltas. Note that gameTime and graphicsTime pause, if we aren't getting our GAME_GAME_TIME messages.
-		gameTimeUpdate(renderBudget > 0 || previousUpdateWasRender);
+		gameTimeUpdate(headless || renderBudget > 0 || previousUpdateWasRender);
 
 		if (deltaGameTime == 0)
 		{
@@ -676,9 +726,11 @@ GAMECODE gameLoop()
 		ASSERT(!paused && !gameUpdatePaused(), "Nonsensical pause values.");
 
 		unsigned before = wzGetTicks();
+		benchmarkTickBegin();
 		syncDebug("Begin game state update, gameTime = %d", gameTime);
 		gameStateUpdate();
 		syncDebug("End game state update, gameTime = %d", gameTime);
+		benchmarkTickEnd();
 		unsigned after = wzGetTicks();
 
 		renderBudget -= (after - before) * renderFraction.n;
@@ -686,6 +738,12 @@ GAMECODE gameLoop()
 		previousUpdateWasRender = false;
 
 		ASSERT(deltaGraphicsTime == 0, "Shouldn't update graphics and game state at once.");
+		ticked = true;
+
+		if (headless && after - loopStart >= 100)
+		{
+			break;  // Catch up over several calls, so that messages and the mission state still get looked at.
+		}
 	}
 
 	if (realTime - lastFlushTime >= 400u)
@@ -694,6 +752,15 @@ GAMECODE gameLoop()
 		NETflush();  // Make sure that we aren't waiting too long to send data.
 	}
 
+	if (headless)
+	{
+		if (!ticked)
+		{
+			wzDelay(1);  // Nothing to do until the next tick is due, don't spin.
+		}
+		return headlessLoop();
+	}
+
 	unsigned before = wzGetTicks();
 	GAMECODE renderReturn = renderLoop();
 	unsigned after = wzGetTicks();
@@ -55,6 +55,10 @@ extern LEVEL_TYPE nextMissionType;
 
 extern unsigned int loopPieCount;
 extern unsigned int loopPolyCount;
+extern unsigned int loopDrawCallCount;
+extern unsigned int loopStateChangeCount;
+extern unsigned int loopTerrainSectorCount;
+extern unsigned int loopTerrainTriangleCount;
 
 GAMECODE gameLoop();
 void videoLoop();
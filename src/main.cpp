@@ -1151,6 +1151,8 @@ int realmain(int argc, char *argv[])
 
 	/*** Initialize directory structure ***/
 
+	PHYSFS_mkdir("cache/scripts");	// compiled campaign scripts, see dataScriptLoad()
+
 	PHYSFS_mkdir("challenges");	// custom challenges
 
 	PHYSFS_mkdir("logs");		// netplay, mingw crash reports & WZ logs
@@ -1168,6 +1170,8 @@ int realmain(int argc, char *argv[])
 
 	PHYSFS_mkdir("music");	// custom music overriding default music and music mods
 
+	PHYSFS_mkdir("replay");	// recorded games, see --replay
+
 	make_dir(SaveGamePath, "savegames", nullptr); 	// save games
 	PHYSFS_mkdir("savegames/campaign");		// campaign save games
 	PHYSFS_mkdir("savegames/skirmish");		// skirmish save games
@@ -1232,6 +1236,11 @@ int realmain(int argc, char *argv[])
 	// Find out where to find the data
 	scanDataDirs();
 
+	if (!convertsave_enabled().empty())
+	{
+		return convertSaveGame(convertsave_enabled().c_str()) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
 	// Now we check the mods to see if they exist or not (specified on the command line)
 	// FIX ME: I know this is a bit hackish, but better than nothing for now?
 	{
@@ -1336,7 +1345,7 @@ int realmain(int argc, char *argv[])
 	{
 		return EXIT_FAILURE;
 	}
-	if (!pie_LoadShaders())
+	if (!wzIsHeadless() && !pie_LoadShaders())
 	{
 		return EXIT_FAILURE;
 	}
@@ -1390,7 +1399,10 @@ int realmain(int argc, char *argv[])
 #endif
 	debug(LOG_MAIN, "Entering main loop");
 	wzMainEventLoop();
-	saveConfig();
+	if (!wzIsHeadless())
+	{
+		saveConfig();  // headless runs force settings (sound, resolution) that should not stick
+	}
 	systemShutdown();
 #ifdef WZ_OS_WIN	// clean up the memory allocated for the command line conversion
 	for (int i = 0; i < argc; i++)
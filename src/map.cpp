@@ -24,10 +24,15 @@
  *
  */
 #include <time.h>
+#include <algorithm>
+#include <atomic>
+#include <unordered_map>
+#include <vector>
 
 #include "lib/framework/frame.h"
 #include "lib/framework/endian_hack.h"
 #include "lib/framework/file.h"
+#include "lib/framework/math_ext.h"
 #include "lib/framework/physfs_ext.h"
 #include "lib/ivis_opengl/tex.h"
 #include "lib/netplay/netplay.h"  // For syncDebug
@@ -53,18 +58,66 @@
 
 #define GAME_TICKS_FOR_DANGER (GAME_TICKS_PER_SEC * 2)
 
-static WZ_THREAD *dangerThread = nullptr;
-static WZ_SEMAPHORE *dangerSemaphore = nullptr;
-static WZ_SEMAPHORE *dangerDoneSemaphore = nullptr;
 struct floodtile
 {
 	uint8_t x;
 	uint8_t y;
 };
-static struct floodtile *floodbucket = nullptr;
-static int bucketcounter;
+
+/// Danger map of one player, worked on by the danger threads while the game goes on.
+struct DangerMap
+{
+	std::vector<uint8_t> aux;               ///< Shadow copy of the aux map, the threat and danger bits are copied back at the next update.
+	std::vector<uint8_t> input;             ///< Threat and passability of each tile, as used by the last flood fill.
+	std::vector<bool> read;                 ///< Tiles whose input the last flood fill looked at.
+	std::vector<floodtile> bucket;          ///< Open list of the flood fill.
+	Vector2i start = Vector2i(-1, -1);      ///< Tile the last flood fill started from.
+	uint32_t enemies = 0;                   ///< Bit mask of players whose objects threaten us.
+};
+
+/// A weapon or sensor, with the tiles it watched when the danger maps were started.
+struct ThreatSource
+{
+	uint32_t visibleTo;                     ///< Bit mask of players who know about it.
+	uint8_t player;
+	bool ground, air;
+	unsigned firstTile, numTiles;           ///< Range in threatTiles.
+};
+
+/// Danger maps of all players, with the snapshot of the game they are made from.
+struct DangerFill
+{
+	DangerMap maps[MAX_PLAYERS];
+	std::vector<ThreatSource> threatSources;
+	std::vector<TILEPOS> threatTiles;
+	std::vector<uint8_t> blockMap;          ///< Copy of psBlockMap[AUX_MAP].
+	int numPlayers = 0;
+	std::atomic<int> nextPlayer;
+	WZ_SEMAPHORE *doneSemaphore = nullptr;
+	bool pending = false;                   ///< Whether the threads are working on it.
+};
+
+// All players' danger maps are updated at the same time on a pool of threads. The results are copied to the aux maps
+// two updates later, at the same game time on all clients, so that they stay synchronised. Two sets of danger maps are
+// used in turn, so the main thread can start the next set while the threads are still working on the last one.
+static std::vector<WZ_THREAD *> dangerThreads;
+static WZ_SEMAPHORE *dangerSemaphore = nullptr;
+static bool dangerThreadsQuit = false;
+static std::atomic<unsigned> dangerWakeCount;  ///< Number of times the threads were woken up, tells them which set to work on.
+static DangerFill dangerFills[2];
+static int dangerNextFill = 0;                 ///< The set which is due at the next update, and is then started again.
 static UDWORD lastDangerUpdate = 0;
-static int lastDangerPlayer = -1;
+
+static void dangerShutdown();
+
+/// A tile which was set on fire, in the map which was current at the time.
+struct FireExpiry
+{
+	MAPTILE *tiles;
+	int index;
+};
+/// Burning tiles, by the (uint16_t)(gameTime / GAME_TICKS_PER_UPDATE) at which they should be checked for being extinguished.
+static std::unordered_map<uint16_t, std::vector<FireExpiry>> fireExpiryBuckets;
 
 //scroll min and max values
 SDWORD		scrollMinX, scrollMaxX, scrollMinY, scrollMaxY;
@@ -878,7 +931,6 @@ bool mapLoad(char *filename, bool preview)
 	/* Allocate aux maps */
 	psBlockMap[AUX_MAP] = (uint8_t *)malloc(mapWidth * mapHeight * sizeof(*psBlockMap[0]));
 	psBlockMap[AUX_ASTARMAP] = (uint8_t *)malloc(mapWidth * mapHeight * sizeof(*psBlockMap[0]));
-	psBlockMap[AUX_DANGERMAP] = (uint8_t *)malloc(mapWidth * mapHeight * sizeof(*psBlockMap[0]));
 	for (x = 0; x < MAX_PLAYERS + AUX_MAX; x++)
 	{
 		psAuxMap[x] = (uint8_t *)malloc(mapWidth * mapHeight * sizeof(*psAuxMap[0]));
@@ -1018,17 +1070,12 @@ bool mapShutdown()
 {
 	int x;
 
-	if (dangerThread)
+	dangerShutdown();
+
+	for (auto &bucket : fireExpiryBuckets)
 	{
-		wzSemaphoreWait(dangerDoneSemaphore);
-		lastDangerPlayer = -1;
-		wzSemaphorePost(dangerSemaphore);
-		wzThreadJoin(dangerThread);
-		wzSemaphoreDestroy(dangerSemaphore);
-		wzSemaphoreDestroy(dangerDoneSemaphore);
-		dangerThread = nullptr;
-		dangerSemaphore = nullptr;
-		dangerDoneSemaphore = nullptr;
+		auto &entries = bucket.second;
+		entries.erase(std::remove_if(entries.begin(), entries.end(), [](FireExpiry const &e) { return e.tiles == psMapTiles; }), entries.end());
 	}
 
 	free(psMapTiles);
@@ -1040,9 +1087,6 @@ bool mapShutdown()
 	psBlockMap[AUX_MAP] = nullptr;
 	free(psBlockMap[AUX_ASTARMAP]);
 	psBlockMap[AUX_ASTARMAP] = nullptr;
-	free(psBlockMap[AUX_DANGERMAP]);
-	free(floodbucket);
-	psBlockMap[AUX_DANGERMAP] = nullptr;
 	for (x = 0; x < MAX_PLAYERS + AUX_MAX; x++)
 	{
 		free(psAuxMap[x]);
@@ -1050,7 +1094,6 @@ bool mapShutdown()
 	}
 
 	map = nullptr;
-	floodbucket = nullptr;
 	psGroundTypes = nullptr;
 	mapDecals = nullptr;
 	psMapTiles = nullptr;
@@ -1524,49 +1567,27 @@ void getTileMaxMin(int x, int y, int *pMax, int *pMin)
 /* This will save out the visibility data */
 bool writeVisibilityData(const char *fileName)
 {
-	unsigned int i;
-	VIS_SAVEHEADER fileHeader;
-
-	PHYSFS_file *fileHandle = openSaveFile(fileName);
-	if (!fileHandle)
-	{
-		return false;
-	}
+	const int planes = (game.maxPlayers + 7) / 8;
+	std::vector<char> data;
+	data.reserve(8 + planes * mapWidth * mapHeight);
 
-	fileHeader.aFileType[0] = 'v';
-	fileHeader.aFileType[1] = 'i';
-	fileHeader.aFileType[2] = 's';
-	fileHeader.aFileType[3] = 'd';
-
-	fileHeader.version = CURRENT_VERSION_NUM;
-
-	// Write out the current file header
-	if (WZ_PHYSFS_writeBytes(fileHandle, fileHeader.aFileType, sizeof(fileHeader.aFileType)) != sizeof(fileHeader.aFileType)
-	    || !PHYSFS_writeUBE32(fileHandle, fileHeader.version))
+	// Header: "visd" and the version, big endian.
+	data.insert(data.end(), {'v', 'i', 's', 'd'});
+	for (int shift = 24; shift >= 0; shift -= 8)
 	{
-		debug(LOG_ERROR, "writeVisibilityData: could not write header to %s; PHYSFS error: %s", fileName, WZ_PHYSFS_getLastError());
-		PHYSFS_close(fileHandle);
-		return false;
+		data.push_back((char)(CURRENT_VERSION_NUM >> shift));
 	}
 
-	int planes = (game.maxPlayers + 7) / 8;
-
 	for (unsigned plane = 0; plane < planes; ++plane)
 	{
-		for (i = 0; i < mapWidth * mapHeight; ++i)
+		for (unsigned i = 0; i < mapWidth * mapHeight; ++i)
 		{
-			if (!PHYSFS_writeUBE8(fileHandle, psMapTiles[i].tileExploredBits >> (plane * 8)))
-			{
-				debug(LOG_ERROR, "writeVisibilityData: could not write to %s; PHYSFS error: %s", fileName, WZ_PHYSFS_getLastError());
-				PHYSFS_close(fileHandle);
-				return false;
-			}
+			data.push_back((char)(psMapTiles[i].tileExploredBits >> (plane * 8)));
 		}
 	}
 
-	// Everything is just fine!
-	PHYSFS_close(fileHandle);
-	return true;
+	// In one go, instead of a byte at a time.
+	return saveFile(fileName, data.data(), data.size());
 }
 
 // -----------------------------------------------------------------------------------
@@ -1761,6 +1782,7 @@ void tileSetFire(int32_t x, int32_t y, uint32_t duration)
 	// Burn, tile, burn!
 	tile->tileInfoBits |= BITS_ON_FIRE;
 	tile->fireEndTime = fireEndTime;
+	fireExpiryBuckets[fireEndTime].push_back(FireExpiry{psMapTiles, posX + posY * mapWidth});
 
 	syncDebug("Fire tile{%d, %d} dur%u end%d", posX, posY, duration, fireEndTime);
 }
@@ -1777,28 +1799,66 @@ bool fireOnLocation(unsigned int x, unsigned int y)
 }
 
 // This function runs in a separate thread!
-static int dangerFloodFill(int player)
+static void threatUpdate(DangerFill const &fill, DangerMap &dm, int player)
 {
-	int i;
+	for (ThreatSource const &source : fill.threatSources)
+	{
+		if (!(dm.enemies & (1 << source.player)) || !(source.visibleTo & (1 << player)))
+		{
+			continue;
+		}
+		const uint8_t bits = (source.ground ? AUXBITS_THREAT : 0) | (source.air ? AUXBITS_AATHREAT : 0);
+		for (unsigned i = source.firstTile; i < source.firstTile + source.numTiles; i++)
+		{
+			dm.aux[fill.threatTiles[i].x + fill.threatTiles[i].y * mapWidth] |= bits;
+		}
+	}
+}
+
+// This function runs in a separate thread!
+static void dangerFloodFill(DangerFill const &fill, DangerMap &dm, int player)
+{
+	uint8_t *auxMap = dm.aux.data();
+	const uint8_t *blockMap = fill.blockMap.data();
+	floodtile *floodbucket = dm.bucket.data();
+	int bucketcounter = 0;
 	Vector2i pos = getPlayerStartPosition(player);
 	Vector2i npos(0, 0);
 	uint8_t aux, block;
-	int x, y;
+	int i;
 	bool start = true;	// hack to disregard the blocking status of any building exactly on the starting position
 
-	// Set our danger bits
-	for (y = 0; y < mapHeight; y++)
+	pos.x = map_coord(pos.x);
+	pos.y = map_coord(pos.y);
+
+	// If none of the tiles the last flood fill looked at changed, it would do exactly the same again, no matter
+	// what happened in the rest of the map.
+	bool changed = pos != dm.start;
+	for (i = 0; i < mapWidth * mapHeight; i++)
 	{
-		for (x = 0; x < mapWidth; x++)
+		const uint8_t input = (auxMap[i] & (AUXBITS_THREAT | AUXBITS_NONPASSABLE)) | (blockMap[i] & FEATURE_BLOCKED);
+		if (input != dm.input[i])
 		{
-			auxSet(x, y, MAX_PLAYERS + AUX_DANGERMAP, AUXBITS_DANGER);
-			auxClear(x, y, MAX_PLAYERS + AUX_DANGERMAP, AUXBITS_TEMPORARY);
+			dm.input[i] = input;
+			changed = changed || dm.read[i];
 		}
 	}
+	if (!changed)
+	{
+		return;
+	}
+	dm.start = pos;
+	std::fill(dm.read.begin(), dm.read.end(), false);
+	if (tileOnMap(pos.x, pos.y))
+	{
+		dm.read[pos.x + pos.y * mapWidth] = true;
+	}
 
-	pos.x = map_coord(pos.x);
-	pos.y = map_coord(pos.y);
-	bucketcounter = 0;
+	// Set our danger bits
+	for (i = 0; i < mapWidth * mapHeight; i++)
+	{
+		auxMap[i] = (auxMap[i] | AUXBITS_DANGER) & ~AUXBITS_TEMPORARY;
+	}
 
 	do
 	{
@@ -1811,8 +1871,9 @@ static int dangerFloodFill(int player)
 			{
 				continue;
 			}
-			aux = auxTile(npos.x, npos.y, MAX_PLAYERS + AUX_DANGERMAP);
-			block = blockTile(pos.x, pos.y, AUX_DANGERMAP);
+			aux = auxMap[npos.x + npos.y * mapWidth];
+			block = blockMap[pos.x + pos.y * mapWidth];
+			dm.read[npos.x + npos.y * mapWidth] = true;
 			if (!(aux & AUXBITS_TEMPORARY) && !(aux & AUXBITS_THREAT) && (aux & AUXBITS_DANGER))
 			{
 				// Note that we do not consider water to be a blocker here. This may or may not be a feature...
@@ -1828,14 +1889,17 @@ static int dangerFloodFill(int player)
 				}
 				else
 				{
-					auxClear(npos.x, npos.y, MAX_PLAYERS + AUX_DANGERMAP, AUXBITS_DANGER);
+					auxMap[npos.x + npos.y * mapWidth] &= ~AUXBITS_DANGER;
 				}
-				auxSet(npos.x, npos.y, MAX_PLAYERS + AUX_DANGERMAP, AUXBITS_TEMPORARY); // make sure we do not process it more than once
+				auxMap[npos.x + npos.y * mapWidth] |= AUXBITS_TEMPORARY; // make sure we do not process it more than once
 			}
 		}
 
 		// Clear danger
-		auxClear(pos.x, pos.y, MAX_PLAYERS + AUX_DANGERMAP, AUXBITS_DANGER);
+		if (tileOnMap(pos.x, pos.y))
+		{
+			auxMap[pos.x + pos.y * mapWidth] &= ~AUXBITS_DANGER;
+		}
 
 		// Pop the last open node off the bucket list for the next iteration
 		if (bucketcounter)
@@ -1846,69 +1910,73 @@ static int dangerFloodFill(int player)
 		}
 	}
 	while (bucketcounter);
-	return 0;
+}
+
+// This function runs in a separate thread!
+static void dangerCompute(DangerFill &fill, int player)
+{
+	threatUpdate(fill, fill.maps[player], player);
+	dangerFloodFill(fill, fill.maps[player], player);
 }
 
 // This function runs in a separate thread!
 static int dangerThreadFunc(WZ_DECL_UNUSED void *data)
 {
-	while (lastDangerPlayer != -1)
+	while (true)
 	{
-		dangerFloodFill(lastDangerPlayer);	// Do the actual work
-		wzSemaphorePost(dangerDoneSemaphore);   // Signal that we are done
 		wzSemaphoreWait(dangerSemaphore);	// Go to sleep until needed.
+		if (dangerThreadsQuit)
+		{
+			break;
+		}
+		// Each set is started by waking up every thread once, in order.
+		DangerFill &fill = dangerFills[dangerWakeCount++ / dangerThreads.size() % ARRAY_SIZE(dangerFills)];
+		for (int player = fill.nextPlayer++; player < fill.numPlayers; player = fill.nextPlayer++)
+		{
+			dangerCompute(fill, player);	// Do the actual work
+		}
+		wzSemaphorePost(fill.doneSemaphore);   // Signal that we are done
 	}
 	return 0;
 }
 
-static inline void threatUpdateTarget(int player, BASE_OBJECT *psObj, bool ground, bool air)
+static void addThreatSource(DangerFill &fill, BASE_OBJECT *psObj, UBYTE mode)
 {
-	int i;
-
-	if (psObj->visible[player] || psObj->born == 2)
+	ThreatSource source;
+	source.visibleTo = 0;
+	for (int i = 0; i < MAX_PLAYERS; i++)
 	{
-		for (i = 0; i < psObj->numWatchedTiles; i++)
+		if (psObj->visible[i] || psObj->born == 2)
 		{
-			const TILEPOS pos = psObj->watchedTiles[i];
-
-			if (ground)
-			{
-				auxSet(pos.x, pos.y, MAX_PLAYERS + AUX_DANGERMAP, AUXBITS_THREAT);	// set ground threat for this tile
-			}
-			if (air)
-			{
-				auxSet(pos.x, pos.y, MAX_PLAYERS + AUX_DANGERMAP, AUXBITS_AATHREAT);	// set air threat for this tile
-			}
+			source.visibleTo |= 1 << i;
 		}
 	}
+	if (source.visibleTo == 0 || psObj->numWatchedTiles == 0)
+	{
+		return;
+	}
+	source.player = psObj->player;
+	source.ground = mode & SHOOT_ON_GROUND;
+	source.air = mode & SHOOT_IN_AIR;
+	source.firstTile = fill.threatTiles.size();
+	source.numTiles = psObj->numWatchedTiles;
+	fill.threatTiles.insert(fill.threatTiles.end(), psObj->watchedTiles, psObj->watchedTiles + psObj->numWatchedTiles);
+	fill.threatSources.push_back(source);
 }
 
-static void threatUpdate(int player)
+/// Takes a snapshot of everything the danger threads need, so that the game can go on while they work.
+static void dangerPrepare(DangerFill &fill, int numPlayers)
 {
-	int i, weapon, x, y;
+	int i, weapon;
 
-	// Step 1: Clear our threat bits
-	for (y = 0; y < mapHeight; y++)
-	{
-		for (x = 0; x < mapWidth; x++)
-		{
-			auxClear(x, y, MAX_PLAYERS + AUX_DANGERMAP, AUXBITS_THREAT | AUXBITS_AATHREAT);
-		}
-	}
+	fill.blockMap.assign(psBlockMap[AUX_MAP], psBlockMap[AUX_MAP] + mapWidth * mapHeight);
 
-	// Step 2: Set threat bits
+	// Weapons and sensors of all players, looked at once instead of once per enemy player
+	fill.threatSources.clear();
+	fill.threatTiles.clear();
 	for (i = 0; i < MAX_PLAYERS; i++)
 	{
-		DROID *psDroid;
-		STRUCTURE *psStruct;
-
-		if (aiCheckAlliances(player, i))
-		{
-			// No need to iterate friendly objects
-			continue;
-		}
-
-		for (psDroid = apsDroidLists[i]; psDroid; psDroid = psDroid->psNext)
+		for (DROID *psDroid = apsDroidLists[i]; psDroid; psDroid = psDroid->psNext)
 		{
 			UBYTE mode = 0;
 
@@ -1927,11 +1995,11 @@ static void threatUpdate(int player)
 			}
 			if (mode > 0)
 			{
-				threatUpdateTarget(player, (BASE_OBJECT *)psDroid, mode & SHOOT_ON_GROUND, mode & SHOOT_IN_AIR);
+				addThreatSource(fill, psDroid, mode);
 			}
 		}
 
-		for (psStruct = apsStructLists[i]; psStruct; psStruct = psStruct->psNext)
+		for (STRUCTURE *psStruct = apsStructLists[i]; psStruct; psStruct = psStruct->psNext)
 		{
 			UBYTE mode = 0;
 
@@ -1945,72 +2013,228 @@ static void threatUpdate(int player)
 			}
 			if (mode > 0)
 			{
-				threatUpdateTarget(player, (BASE_OBJECT *)psStruct, mode & SHOOT_ON_GROUND, mode & SHOOT_IN_AIR);
+				addThreatSource(fill, psStruct, mode);
+			}
+		}
+	}
+
+	for (int player = 0; player < numPlayers; player++)
+	{
+		DangerMap &dm = fill.maps[player];
+
+		dm.enemies = 0;
+		for (i = 0; i < MAX_PLAYERS; i++)
+		{
+			if (!aiCheckAlliances(player, i))
+			{
+				dm.enemies |= 1 << i;
 			}
 		}
+
+		// Take the passability from the aux map, keep the danger bits from the last time, and clear the threat bits
+		const uint8_t keep = AUXBITS_DANGER | AUXBITS_TEMPORARY;
+		const uint8_t mask = keep | AUXBITS_THREAT | AUXBITS_AATHREAT;
+		for (i = 0; i < mapWidth * mapHeight; i++)
+		{
+			dm.aux[i] = (psAuxMap[player][i] & ~mask) | (dm.aux[i] & keep);
+		}
 	}
+	fill.numPlayers = numPlayers;
 }
 
-void mapInit()
+static void dangerStart(DangerFill &fill)
 {
-	int player;
+	fill.nextPlayer = 0;
+	if (dangerThreads.empty())
+	{
+		for (int player = 0; player < fill.numPlayers; player++)
+		{
+			dangerCompute(fill, player);
+		}
+		return;
+	}
+	fill.pending = true;
+	for (size_t i = 0; i < dangerThreads.size(); i++)
+	{
+		wzSemaphorePost(dangerSemaphore);
+	}
+}
+
+static void dangerWait(DangerFill &fill)
+{
+	if (!fill.pending)
+	{
+		return;
+	}
+	for (size_t i = 0; i < dangerThreads.size(); i++)
+	{
+		wzSemaphoreWait(fill.doneSemaphore);
+	}
+	fill.pending = false;
+}
+
+/// Copies the danger maps the threads made into the aux maps.
+static void dangerApply(DangerFill const &fill)
+{
+	const uint8_t mask = AUXBITS_THREAT | AUXBITS_AATHREAT | AUXBITS_DANGER;
+
+	for (int player = 0; player < fill.numPlayers; player++)
+	{
+		const uint8_t *cached = fill.maps[player].aux.data();
+		uint8_t *original = psAuxMap[player];
+
+		for (int i = 0; i < mapWidth * mapHeight; i++)
+		{
+			original[i] ^= (original[i] ^ cached[i]) & mask;
+		}
+	}
+}
 
-	free(floodbucket);
-	floodbucket = (struct floodtile *)malloc(mapWidth * mapHeight * sizeof(*floodbucket));
+static void dangerShutdown()
+{
+	for (DangerFill &fill : dangerFills)
+	{
+		dangerWait(fill);
+	}
+	if (!dangerThreads.empty())
+	{
+		dangerThreadsQuit = true;
+		for (size_t i = 0; i < dangerThreads.size(); i++)
+		{
+			wzSemaphorePost(dangerSemaphore);  // Wake up threads, so they can quit.
+		}
+		for (WZ_THREAD *thread : dangerThreads)
+		{
+			wzThreadJoin(thread);
+		}
+		dangerThreads.clear();
+		wzSemaphoreDestroy(dangerSemaphore);
+		dangerSemaphore = nullptr;
+	}
+	for (DangerFill &fill : dangerFills)
+	{
+		for (DangerMap &dm : fill.maps)
+		{
+			dm = DangerMap();
+		}
+		fill.threatSources.clear();
+		fill.threatTiles.clear();
+		fill.blockMap.clear();
+		fill.numPlayers = 0;
+		if (fill.doneSemaphore != nullptr)
+		{
+			wzSemaphoreDestroy(fill.doneSemaphore);
+			fill.doneSemaphore = nullptr;
+		}
+	}
+}
 
+void mapInit()
+{
 	lastDangerUpdate = 0;
-	lastDangerPlayer = -1;
 
-	// Start danger thread (not used for campaign for now - mission map swaps too icky)
-	ASSERT(dangerSemaphore == nullptr && dangerThread == nullptr, "Map data not cleaned up before starting!");
+	// Start danger threads (not used for campaign for now - mission map swaps too icky)
+	ASSERT(dangerSemaphore == nullptr && dangerThreads.empty(), "Map data not cleaned up before starting!");
 	if (game.type == SKIRMISH)
 	{
-		for (player = 0; player < MAX_PLAYERS; player++)
+		for (DangerFill &fill : dangerFills)
 		{
-			auxMapStore(player, AUX_DANGERMAP);
-			threatUpdate(player);
-			dangerFloodFill(player);
-			auxMapRestore(player, AUX_DANGERMAP, AUXBITS_DANGER | AUXBITS_THREAT | AUXBITS_AATHREAT);
+			for (DangerMap &dm : fill.maps)
+			{
+				dm.aux.assign(mapWidth * mapHeight, 0);
+				dm.input.assign(mapWidth * mapHeight, 0);
+				dm.read.assign(mapWidth * mapHeight, false);
+				dm.bucket.resize(mapWidth * mapHeight);
+				dm.start = Vector2i(-1, -1);
+			}
+			fill.doneSemaphore = wzSemaphoreCreate(0);
 		}
-		lastDangerPlayer = 0;
+		dangerNextFill = 0;
+		dangerPrepare(dangerFills[0], MAX_PLAYERS);
+		for (int player = 0; player < MAX_PLAYERS; player++)
+		{
+			dangerCompute(dangerFills[0], player);
+		}
+		dangerApply(dangerFills[0]);
+
+		const int numThreads = clip(wzGetCPUCount() - 1, 1, MAX_PLAYERS);
+		dangerThreadsQuit = false;
+		dangerWakeCount = 0;
 		dangerSemaphore = wzSemaphoreCreate(0);
-		dangerDoneSemaphore = wzSemaphoreCreate(0);
-		dangerThread = wzThreadCreate(dangerThreadFunc, nullptr);
-		wzThreadStart(dangerThread);
+		for (int i = 0; i < numThreads; i++)
+		{
+			WZ_THREAD *thread = wzThreadCreate(dangerThreadFunc, nullptr);
+			wzThreadStart(thread);
+			dangerThreads.push_back(thread);
+		}
+		debug(LOG_INFO, "Updating danger maps on %d threads", numThreads);
 	}
 }
 
 void mapUpdate()
 {
 	const uint16_t currentTime = gameTime / GAME_TICKS_PER_UPDATE;
-	int posX, posY;
 
-	for (posY = 0; posY < mapHeight; ++posY)
-		for (posX = 0; posX < mapWidth; ++posX)
+	auto bucket = fireExpiryBuckets.find(currentTime);
+	if (bucket != fireExpiryBuckets.end())
+	{
+		// Tiles from a map which isn't current (such as the home base map during an offworld mission)
+		// are left for when currentTime wraps around, which is when a scan of that map would find them.
+		std::vector<FireExpiry> later;
+		std::vector<int> indices;
+		for (auto const &e : bucket->second)
+		{
+			if (e.tiles == psMapTiles)
+			{
+				indices.push_back(e.index);
+			}
+			else
+			{
+				later.push_back(e);
+			}
+		}
+		// Process the tiles in the order they are in the map, for identical sync logs.
+		std::sort(indices.begin(), indices.end());
+		indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+		for (int index : indices)
 		{
-			MAPTILE *const tile = mapTile(posX, posY);
+			if (index >= mapWidth * mapHeight)
+			{
+				continue;
+			}
+			MAPTILE *const tile = &psMapTiles[index];
 
+			// The tile may have been set on fire again since, in which case it is also in a later bucket.
 			if ((tile->tileInfoBits & BITS_ON_FIRE) != 0 && tile->fireEndTime == currentTime)
 			{
 				// Extinguish, tile, extinguish!
 				tile->tileInfoBits &= ~BITS_ON_FIRE;
 
-				syncDebug("Extinguished tile{%d, %d}", posX, posY);
+				syncDebug("Extinguished tile{%d, %d}", index % mapWidth, index / mapWidth);
 			}
 		}
+		if (later.empty())
+		{
+			fireExpiryBuckets.erase(bucket);
+		}
+		else
+		{
+			bucket->second = std::move(later);
+		}
+	}
 
 	if (gameTime > lastDangerUpdate + GAME_TICKS_FOR_DANGER && game.type == SKIRMISH)
 	{
 		syncDebug("Do danger maps.");
 		lastDangerUpdate = gameTime;
 
-		// Lock if previous job not done yet
-		wzSemaphoreWait(dangerDoneSemaphore);
-
-		auxMapRestore(lastDangerPlayer, AUX_DANGERMAP, AUXBITS_THREAT | AUXBITS_AATHREAT | AUXBITS_DANGER);
-		lastDangerPlayer = (lastDangerPlayer + 1) % game.maxPlayers;
-		auxMapStore(lastDangerPlayer, AUX_DANGERMAP);
-		threatUpdate(lastDangerPlayer);
-		wzSemaphorePost(dangerSemaphore);
+		// The set started two intervals ago is due now. Only waits if the threads have not finished it yet, which took
+		// two whole intervals. The set started at the last interval is left running.
+		DangerFill &fill = dangerFills[dangerNextFill];
+		dangerNextFill = (dangerNextFill + 1) % ARRAY_SIZE(dangerFills);
+		dangerWait(fill);
+		dangerApply(fill);
+		dangerPrepare(fill, game.maxPlayers);
+		dangerStart(fill);
 	}
 }
@@ -35,6 +35,10 @@
 static PointTree *gridPointTree = nullptr;  // A quad-tree-like object.
 static PointTree::Filter *gridFiltersUnseen;
 static PointTree::Filter *gridFiltersDroidsByPlayer;
+static std::vector<Vector2i> gridPositions;  // Positions of the objects in the point tree, by gridIndex.
+static unsigned gridResetCount = 0;
+
+#define GRID_REGION_SHIFT 9  // Searches from within the same 4x4 tiles can share gridStartIterateRegion().
 
 // initialise the grid system
 bool gridInitialise()
@@ -50,9 +54,9 @@ bool gridInitialise()
 // reset the grid system
 void gridReset()
 {
-	gridPointTree->clear();
-
-	// Put all existing objects into the point tree.
+	// Update the positions of all existing objects in the point tree, and add any new ones. Objects which are gone are removed by sort().
+	// Objects are ordered by list traversal order when in exactly the same place, as the order of query results must not depend on pointer values.
+	uint32_t order = 0;
 	for (unsigned player = 0; player < MAX_PLAYERS; player++)
 	{
 		BASE_OBJECT *start[3] = {(BASE_OBJECT *)apsDroidLists[player], (BASE_OBJECT *)apsStructLists[player], (BASE_OBJECT *)apsFeatureLists[player]};
@@ -62,7 +66,14 @@ void gridReset()
 			{
 				if (!psObj->died)
 				{
-					gridPointTree->insert(psObj, psObj->pos.x, psObj->pos.y);
+					if (psObj->gridIndex < gridPointTree->size() && gridPointTree->pointData(psObj->gridIndex) == psObj)
+					{
+						gridPointTree->update(psObj->gridIndex, psObj->pos.x, psObj->pos.y, order++);
+					}
+					else
+					{
+						gridPointTree->insert(psObj, psObj->pos.x, psObj->pos.y, order++);
+					}
 					for (unsigned char &viewer : psObj->seenThisTick)
 					{
 						viewer = 0;
@@ -74,6 +85,15 @@ void gridReset()
 
 	gridPointTree->sort();
 
+	gridPositions.resize(gridPointTree->size());
+	for (unsigned i = 0; i < gridPointTree->size(); ++i)
+	{
+		BASE_OBJECT *psObj = static_cast<BASE_OBJECT *>(gridPointTree->pointData(i));
+		psObj->gridIndex = i;
+		gridPositions[i] = psObj->pos.xy();
+	}
+	++gridResetCount;
+
 	for (unsigned player = 0; player < MAX_PLAYERS; ++player)
 	{
 		gridFiltersUnseen[player].reset(*gridPointTree);
@@ -90,6 +110,12 @@ void gridShutDown()
 	gridFiltersUnseen = nullptr;
 	delete[] gridFiltersDroidsByPlayer;
 	gridFiltersDroidsByPlayer = nullptr;
+	gridPositions.clear();
+}
+
+unsigned gridGetResetCount()
+{
+	return gridResetCount;
 }
 
 static bool isInRadius(int32_t x, int32_t y, uint32_t radius)
@@ -171,6 +197,30 @@ GridList const &gridStartIterateArea(int32_t x, int32_t y, uint32_t x2, uint32_t
 	return gridStartIterateFilteredArea(x, y, x2, y2, ConditionTrue());
 }
 
+bool gridIsFoundByIterate(BASE_OBJECT *psObj, int32_t x, int32_t y, uint32_t radius)
+{
+	// The point tree finds objects by where they were at the last gridReset(), then the distance is checked where they are now.
+	Vector2i const &gridPos = gridPositions[psObj->gridIndex];
+	int32_t minX = x - radius, maxX = x + radius;
+	int32_t minY = y - radius, maxY = y + radius;
+	return gridPos.x >= minX && gridPos.x <= maxX && gridPos.y >= minY && gridPos.y <= maxY
+	       && isInRadius(psObj->pos.x - x, psObj->pos.y - y, radius);
+}
+
+uint32_t gridRegionKey(int32_t x, int32_t y)
+{
+	return (uint32_t)(uint16_t)(x >> GRID_REGION_SHIFT) << 16 | (uint16_t)(y >> GRID_REGION_SHIFT);
+}
+
+GridList const &gridStartIterateRegion(int32_t x, int32_t y, uint32_t radius)
+{
+	// Anything gridStartIterate() could find from anywhere in the region.
+	const int32_t half = (1 << (GRID_REGION_SHIFT - 1)) + radius;
+	const int32_t centreX = (x >> GRID_REGION_SHIFT << GRID_REGION_SHIFT) + (1 << (GRID_REGION_SHIFT - 1));
+	const int32_t centreY = (y >> GRID_REGION_SHIFT << GRID_REGION_SHIFT) + (1 << (GRID_REGION_SHIFT - 1));
+	return gridStartIterateArea(centreX - half, centreY - half, centreX + half, centreY + half);
+}
+
 struct ConditionDroidsByPlayer
 {
 	ConditionDroidsByPlayer(int32_t player_) : player(player_) {}
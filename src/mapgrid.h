@@ -43,6 +43,20 @@ GridList const &gridStartIterate(int32_t x, int32_t y, uint32_t radius);
 /// Find all objects within radius.
 GridList const &gridStartIterateArea(int32_t x, int32_t y, uint32_t x2, uint32_t y2);
 
+/// Whether gridStartIterate(x, y, radius) would find the object, which must have been found by a grid search since the last gridReset().
+/// Objects found by searching a larger area can be filtered with this, and are then in the same order as gridStartIterate() would give.
+bool gridIsFoundByIterate(BASE_OBJECT *psObj, int32_t x, int32_t y, uint32_t radius);
+
+/// Identifies the region containing (x, y). Searches from positions in the same region can share gridStartIterateRegion().
+uint32_t gridRegionKey(int32_t x, int32_t y);
+
+/// Find all objects gridStartIterate() could find with the given radius from anywhere in the region containing (x, y).
+/// Filter with gridIsFoundByIterate() to get what gridStartIterate() would find from a particular position, in the same order.
+GridList const &gridStartIterateRegion(int32_t x, int32_t y, uint32_t radius);
+
+/// Changes every time the objects are put into the grid by gridReset().
+unsigned gridGetResetCount();
+
 /// Find all objects within radius where object->type == OBJ_DROID && object->player == player.
 GridList const &gridStartIterateDroidsByPlayer(int32_t x, int32_t y, uint32_t radius, int player);
 
@@ -334,6 +334,7 @@ bool missionShutDown()
 		apsOilList[0] = mission.apsOilList[0];
 		mission.apsSensorList[0] = nullptr;
 		mission.apsOilList[0] = nullptr;
+		visSensorListChanged();
 
 		psMapTiles = mission.psMapTiles;
 		mapWidth = mission.mapWidth;
@@ -867,6 +868,7 @@ void restoreMissionData()
 	apsSensorList[0] = mission.apsSensorList[0];
 	apsOilList[0] = mission.apsOilList[0];
 	mission.apsSensorList[0] = nullptr;
+	visSensorListChanged();
 	//swap mission data over
 
 	psMapTiles = mission.psMapTiles;
@@ -1398,6 +1400,7 @@ void swapMissionPointers()
 	}
 	std::swap(apsSensorList[0], mission.apsSensorList[0]);
 	std::swap(apsOilList[0],    mission.apsOilList[0]);
+	visSensorListChanged();
 }
 
 void endMission()
@@ -56,6 +56,9 @@
 #include "lib/widget/widgint.h"
 #include "lib/widget/label.h"
 
+#include "benchmark.h"
+#include "replay.h"
+#include "lib/netplay/netreplay.h"
 #include "challenge.h"
 #include "main.h"
 #include "levels.h"
@@ -439,8 +442,9 @@ void loadMultiScripts()
 			NetPlay.players[i].ai = 0;  // For autogames.
 		}
 		// The i == selectedPlayer hack is to enable autogames
+		// When playing back a replay, everything the AIs did is already in the recorded game queues.
 		if (bMultiPlayer && game.type == SKIRMISH && (!NetPlay.players[i].allocated || i == selectedPlayer)
-		    && (NetPlay.players[i].ai >= 0 || hostlaunch == 2) && myResponsibility(i))
+		    && (NetPlay.players[i].ai >= 0 || hostlaunch == 2) && myResponsibility(i) && !NETisReplay())
 		{
 			if (PHYSFS_exists(ininame.toUtf8().c_str())) // challenge file may override AI
 			{
@@ -477,7 +481,7 @@ void loadMultiScripts()
 	}
 
 	// Load scavengers
-	if (game.scavengers && myResponsibility(scavengerPlayer()))
+	if (game.scavengers && myResponsibility(scavengerPlayer()) && !NETisReplay())
 	{
 		debug(LOG_SAVE, "Loading scavenger AI for player %d", scavengerPlayer());
 		loadPlayerScript("multiplay/script/scavfact.js", scavengerPlayer(), DIFFICULTY_EASY);
@@ -2727,6 +2731,14 @@ void addPlayerBox(bool players)
 static void SendFireUp()
 {
 	uint32_t randomSeed = rand();  // Pick a random random seed for the synchronised random number generator.
+	if (benchmarkEnabled())
+	{
+		randomSeed = benchmarkRandomSeed();
+	}
+	else if (NETisReplay())
+	{
+		randomSeed = replayRandomSeed();
+	}
 
 	NETbeginEncode(NETbroadcastQueue(), NET_FIREUP);
 	NETuint32_t(&randomSeed);
@@ -3492,7 +3504,10 @@ void startMultiplayerGame()
 		}
 
 		resetDataHash();	// need to reset it, since host's data has changed.
-		createLimitSet();
+		if (!NETisReplay())	// replays bring the limits of the recorded game
+		{
+			createLimitSet();
+		}
 		debug(LOG_NET, "sending our options to all clients");
 		sendOptions();
 		NEThaltJoining();							// stop new players entering.
@@ -4082,6 +4097,19 @@ bool startMultiOptions(bool bReenter)
 		}
 	}
 
+	if (hostlaunch == 3)
+	{
+		processMultiopWidgets(MULTIOP_HOST);
+		if (!replayLoad())
+		{
+			debug(LOG_ERROR, "Unable to play back the replay");
+			hostlaunch = 0;
+			return true;
+		}
+		replayApplySettings();
+		startMultiplayerGame();
+	}
+
 	return true;
 }
 
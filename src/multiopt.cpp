@@ -58,6 +58,7 @@
 #include "multilimit.h"
 #include "multigifts.h"
 #include "multiint.h"
+#include "replay.h"
 #include "multirecv.h"
 #include "scriptfuncs.h"
 #include "template.h"
@@ -466,6 +467,7 @@ bool multiGameInit()
 
 	gameInit();
 	msgStackReset();	//for multiplayer msgs, reset message stack
+	replayRecordStart();
 
 	return true;
 }
@@ -492,6 +494,8 @@ bool multiGameShutdown()
 	{
 		wzYieldCurrentThread();  // TODO Make a wzDelay() function?
 	}
+	replayShutdown();
+
 	// close game
 	NETclose();
 	NETremRedirects();
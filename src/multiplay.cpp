@@ -74,6 +74,7 @@
 #include "multiint.h"
 #include "keymap.h"
 #include "cheat.h"
+#include "replay.h"
 
 // ////////////////////////////////////////////////////////////////////////////
 // ////////////////////////////////////////////////////////////////////////////
@@ -292,6 +293,8 @@ bool multiPlayerLoop()
 		}
 	}
 
+	replayUpdate();
+
 	// if player has won then process the win effects...
 	if (testPlayerHasWon())
 	{
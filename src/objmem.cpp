@@ -24,6 +24,7 @@
  *
  */
 #include <string.h>
+#include <unordered_map>
 
 #include "lib/framework/frame.h"
 #include "objects.h"
@@ -45,6 +46,7 @@
 #include "combat.h"
 #include "visibility.h"
 #include "qtscript.h"
+#include "objpool.h"
 
 // the initial value for the object ID
 #define OBJ_ID_INIT 20000
@@ -69,6 +71,16 @@ FLAG_POSITION	*apsFlagPosLists[MAX_PLAYERS];
 /* The list of destroyed objects */
 BASE_OBJECT		*psDestroyedObj = nullptr;
 
+/* Memory for the objects themselves, reused when objects are freed */
+static ObjectPool droidPool("DROID", sizeof(DROID));
+static ObjectPool structurePool("STRUCTURE", sizeof(STRUCTURE));
+static ObjectPool featurePool("FEATURE", sizeof(FEATURE));
+static ObjectPool projectilePool("PROJECTILE", sizeof(PROJECTILE));
+
+/* Objects added to the object lists and not yet destroyed, by id, to avoid searching all the lists in getBaseObjFromId.
+ * Objects stay here when just moved between lists, and are removed when freed. */
+static std::unordered_map<UDWORD, BASE_OBJECT *> objIdMap;
+
 /* Forward function declarations */
 #ifdef DEBUG
 static void objListIntegCheck();
@@ -88,6 +100,50 @@ bool objmemInitialise()
 /* Release the object heaps */
 void objmemShutdown()
 {
+	droidPool.logStats();
+	structurePool.logStats();
+	featurePool.logStats();
+	projectilePool.logStats();
+}
+
+void *DROID::operator new(size_t size)
+{
+	return droidPool.allocate(size);
+}
+
+void DROID::operator delete(void *object, size_t size)
+{
+	droidPool.deallocate(object, size);
+}
+
+void *STRUCTURE::operator new(size_t size)
+{
+	return structurePool.allocate(size);
+}
+
+void STRUCTURE::operator delete(void *object, size_t size)
+{
+	structurePool.deallocate(object, size);
+}
+
+void *FEATURE::operator new(size_t size)
+{
+	return featurePool.allocate(size);
+}
+
+void FEATURE::operator delete(void *object, size_t size)
+{
+	featurePool.deallocate(object, size);
+}
+
+void *PROJECTILE::operator new(size_t size)
+{
+	return projectilePool.allocate(size);
+}
+
+void PROJECTILE::operator delete(void *object, size_t size)
+{
+	projectilePool.deallocate(object, size);
 }
 
 // Check that psVictim is not referred to by any other object in the game. We can dump out some extra data in debug builds that help track down sources of dangling pointer errors.
@@ -231,6 +287,30 @@ void objmemUpdate()
 	}
 }
 
+void objmemForgetObject(BASE_OBJECT *psObj)
+{
+	auto it = objIdMap.find(psObj->id);
+	if (it != objIdMap.end() && it->second == psObj)
+	{
+		objIdMap.erase(it);
+	}
+}
+
+void setBaseObjId(BASE_OBJECT *psObj, UDWORD id)
+{
+	auto it = objIdMap.find(psObj->id);
+	bool known = it != objIdMap.end() && it->second == psObj;
+	if (known)
+	{
+		objIdMap.erase(it);
+	}
+	psObj->id = id;
+	if (known)
+	{
+		objIdMap[id] = psObj;
+	}
+}
+
 uint32_t generateNewObjectId()
 {
 	// Generate even ID for unsynchronized objects. This is needed for debug objects, templates and other border lines cases that should preferably be removed one day.
@@ -256,6 +336,8 @@ static inline void addObjectToList(OBJECT *list[], OBJECT *object, int player)
 	// Prepend the object to the top of the list
 	object->psNext = list[player];
 	list[player] = object;
+
+	objIdMap[object->id] = object;
 }
 
 /* Add the object to its list
@@ -282,6 +364,8 @@ static inline void destroyObject(OBJECT *list[], OBJECT *object)
 	ASSERT_OR_RETURN(, object != nullptr, "Invalid pointer");
 	ASSERT(gameTime - deltaGameTime <= gameTime || gameTime == 2, "Expected %u <= %u, bad time", gameTime - deltaGameTime, gameTime);
 
+	objmemForgetObject(object);
+
 	// If the message to remove is the first one in the list then mark the next one as the first
 	if (list[object->player] == object)
 	{
@@ -427,6 +511,7 @@ void addDroid(DROID *psDroidToAdd, DROID *pList[MAX_PLAYERS])
 		if (psDroidToAdd->droidType == DROID_SENSOR)
 		{
 			addObjectToFuncList(apsSensorList, (BASE_OBJECT *)psDroidToAdd, 0);
+			visSensorListChanged();
 		}
 
 		// commanders have to get their group back if not already loaded
@@ -464,6 +549,7 @@ void killDroid(DROID *psDel)
 	if (psDel->droidType == DROID_SENSOR)
 	{
 		removeObjectFromFuncList(apsSensorList, (BASE_OBJECT *)psDel, 0);
+		visSensorListChanged();
 	}
 
 	destroyObject(apsDroidLists, psDel);
@@ -473,6 +559,7 @@ void killDroid(DROID *psDel)
 void freeAllDroids()
 {
 	releaseAllObjectsInList(apsDroidLists);
+	visSensorListChanged();
 }
 
 /*Remove a single Droid from a list*/
@@ -490,6 +577,7 @@ void removeDroid(DROID *psDroidToRemove, DROID *pList[MAX_PLAYERS])
 		if (psDroidToRemove->droidType == DROID_SENSOR)
 		{
 			removeObjectFromFuncList(apsSensorList, (BASE_OBJECT *)psDroidToRemove, 0);
+			visSensorListChanged();
 		}
 		psDroidToRemove->died = NOT_CURRENT_LIST;
 	}
@@ -524,6 +612,7 @@ void addStructure(STRUCTURE *psStructToAdd)
 	    && psStructToAdd->pStructureType->pSensor->location == LOC_TURRET)
 	{
 		addObjectToFuncList(apsSensorList, (BASE_OBJECT *)psStructToAdd, 0);
+		visSensorListChanged();
 	}
 	else if (psStructToAdd->pStructureType->type == REF_RESOURCE_EXTRACTOR)
 	{
@@ -545,6 +634,7 @@ void killStruct(STRUCTURE *psBuilding)
 	    && psBuilding->pStructureType->pSensor->location == LOC_TURRET)
 	{
 		removeObjectFromFuncList(apsSensorList, (BASE_OBJECT *)psBuilding, 0);
+		visSensorListChanged();
 	}
 	else if (psBuilding->pStructureType->type == REF_RESOURCE_EXTRACTOR)
 	{
@@ -595,6 +685,7 @@ void killStruct(STRUCTURE *psBuilding)
 void freeAllStructs()
 {
 	releaseAllObjectsInList(apsStructLists);
+	visSensorListChanged();
 }
 
 /*Remove a single Structure from a list*/
@@ -609,6 +700,7 @@ void removeStructureFromList(STRUCTURE *psStructToRemove, STRUCTURE *pList[MAX_P
 	    && psStructToRemove->pStructureType->pSensor->location == LOC_TURRET)
 	{
 		removeObjectFromFuncList(apsSensorList, (BASE_OBJECT *)psStructToRemove, 0);
+		visSensorListChanged();
 	}
 	else if (psStructToRemove->pStructureType->type == REF_RESOURCE_EXTRACTOR)
 	{
@@ -774,6 +866,12 @@ BASE_OBJECT *getBaseObjFromData(unsigned id, unsigned player, OBJECT_TYPE type)
 	BASE_OBJECT		*psObj;
 	DROID			*psTrans;
 
+	auto it = objIdMap.find(id);
+	if (it != objIdMap.end() && it->second->type == type && (type == OBJ_FEATURE || it->second->player == player))
+	{
+		return it->second;
+	}
+
 	for (int i = 0; i < 3; ++i)
 	{
 		psObj = nullptr;
@@ -838,6 +936,14 @@ BASE_OBJECT *getBaseObjFromId(UDWORD id)
 	BASE_OBJECT		*psObj;
 	DROID			*psTrans;
 
+	auto it = objIdMap.find(id);
+	if (it != objIdMap.end())
+	{
+		return it->second;
+	}
+
+	// Not found quickly, so search all the lists, in case it was never added to a list with addObjectToList.
+
 	for (i = 0; i < 7; ++i)
 	{
 		for (player = 0; player < MAX_PLAYERS; ++player)
@@ -895,6 +1001,7 @@ BASE_OBJECT *getBaseObjFromId(UDWORD id)
 			{
 				if (psObj->id == id)
 				{
+					objIdMap[id] = psObj;
 					return psObj;
 				}
 				// if transporter check any droids in the grp
@@ -904,6 +1011,7 @@ BASE_OBJECT *getBaseObjFromId(UDWORD id)
 					{
 						if (psTrans->id == id)
 						{
+							objIdMap[id] = psTrans;
 							return (BASE_OBJECT *)psTrans;
 						}
 					}
@@ -104,6 +104,10 @@ void freeAllAssemblyPoints();
 // Find a base object from it's id
 BASE_OBJECT *getBaseObjFromData(unsigned id, unsigned player, OBJECT_TYPE type);
 BASE_OBJECT *getBaseObjFromId(UDWORD id);
+/// Changes the id of an object, which might already be in an object list.
+void setBaseObjId(BASE_OBJECT *psObj, UDWORD id);
+/// Stops getBaseObjFromId from finding the object, called when it is destroyed or freed.
+void objmemForgetObject(BASE_OBJECT *psObj);
 bool checkValidId(UDWORD id);
 
 UDWORD getRepairIdFromFlag(FLAG_POSITION *psFlag);
@@ -0,0 +1,101 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2005-2019  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/** @file
+ *  Pool allocator for game objects.
+ */
+
+#include "lib/framework/frame.h"
+#include "objpool.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+
+ObjectPool::ObjectPool(char const *name, size_t objectSize, size_t objectsPerSlab)
+	: name(name)
+	, typeSize(objectSize)
+	, objectsPerSlab(objectsPerSlab)
+{
+	const size_t alignment = alignof(std::max_align_t);
+	this->objectSize = (std::max(objectSize, sizeof(FreeObject)) + alignment - 1) / alignment * alignment;
+}
+
+ObjectPool::~ObjectPool()
+{
+	for (char *slab : slabs)
+	{
+		free(slab);
+	}
+}
+
+void *ObjectPool::allocate(size_t size)
+{
+	if (size != typeSize)
+	{
+		return ::operator new(size);  // Not the type this pool was made for (a derived class?), so don't bother.
+	}
+
+	if (freeList == nullptr)
+	{
+		// Allocate a new slab, and put its objects on the free list, so that the first object is used first.
+		char *slab = (char *)malloc(objectSize * objectsPerSlab);
+		if (slab == nullptr)
+		{
+			debug(LOG_FATAL, "Out of memory allocating %s objects.", name);
+			throw std::bad_alloc();
+		}
+		slabs.push_back(slab);
+		for (size_t i = objectsPerSlab; i-- > 0;)
+		{
+			FreeObject *object = (FreeObject *)(slab + i * objectSize);
+			object->next = freeList;
+			freeList = object;
+		}
+	}
+
+	FreeObject *object = freeList;
+	freeList = object->next;
+	++live;
+	peak = std::max(peak, live);
+	return object;
+}
+
+void ObjectPool::deallocate(void *object, size_t size)
+{
+	if (object == nullptr)
+	{
+		return;
+	}
+	if (size != typeSize)
+	{
+		::operator delete(object);
+		return;
+	}
+
+	ASSERT(live > 0, "Freeing more %s objects than allocated.", name);
+	--live;
+	FreeObject *freeObject = (FreeObject *)object;
+	freeObject->next = freeList;
+	freeList = freeObject;
+}
+
+void ObjectPool::logStats() const
+{
+	debug(LOG_INFO, "%s pool: %u live, %u peak, %u bytes in %u slabs", name, (unsigned)live, (unsigned)peak, (unsigned)(slabs.size() * objectsPerSlab * objectSize), (unsigned)slabs.size());
+}
@@ -0,0 +1,68 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2005-2019  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/** @file
+ *  Pool allocator for game objects.
+ */
+
+#ifndef __INCLUDED_SRC_OBJPOOL_H__
+#define __INCLUDED_SRC_OBJPOOL_H__
+
+#include "lib/framework/types.h"
+
+#include <vector>
+
+/// Allocates objects of one size in slabs of many objects, reusing freed objects before allocating new slabs.
+/// Objects keep their address until freed, and objects allocated together tend to be close in memory.
+/// Not thread safe, should only be used from the main thread.
+class ObjectPool
+{
+public:
+	ObjectPool(char const *name, size_t objectSize, size_t objectsPerSlab = 256);
+	~ObjectPool();
+
+	/// Allocates an object. If size is not the size of the pool's objects, it is allocated with ::operator new instead.
+	void *allocate(size_t size);
+	/// Frees an object allocated with allocate(), size must be the same as when allocating.
+	void deallocate(void *object, size_t size);
+
+	/// Writes the number of live objects, peak number of live objects and the memory used by the pool to the debug log.
+	void logStats() const;
+
+	size_t numLive() const
+	{
+		return live;
+	}
+
+private:
+	struct FreeObject
+	{
+		FreeObject *next;
+	};
+
+	char const *name;
+	size_t typeSize;              ///< Size of the objects this pool was made for.
+	size_t objectSize;            ///< Size of each object, rounded up so that all objects are aligned.
+	size_t objectsPerSlab;
+	std::vector<char *> slabs;
+	FreeObject *freeList = nullptr;  ///< Freed objects, most recently freed first.
+	size_t live = 0;
+	size_t peak = 0;
+};
+
+#endif // __INCLUDED_SRC_OBJPOOL_H__
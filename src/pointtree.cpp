@@ -77,24 +77,72 @@ static uint64_t interleave(int32_t x, int32_t y)
 	return expandX(x) | expandY(y);
 }
 
-void PointTree::insert(void *pointData, int32_t x, int32_t y)
+void PointTree::insert(void *pointData, int32_t x, int32_t y, uint32_t order)
 {
-	points.push_back(Point(interleave(x, y), pointData));
+	Point point;
+	point.key = interleave(x, y);
+	point.data = pointData;
+	point.order = order;
+	point.generation = currentGeneration;
+	points.push_back(point);
+	++numInserted;
+}
+
+void PointTree::update(unsigned index, int32_t x, int32_t y, uint32_t order)
+{
+	points[index].key = interleave(x, y);
+	points[index].order = order;
+	points[index].generation = currentGeneration;
 }
 
 void PointTree::clear()
 {
 	points.clear();
+	numInserted = 0;
 }
 
-static bool pointTreeSortFunction(std::pair<uint64_t, void *> const &a, std::pair<uint64_t, void *> const &b)
+static bool pointTreeSortFunction(PointTree::Point const &a, PointTree::Point const &b)
 {
-	return a.first < b.first;  // Sort only by position, not by pointer address, even if two units are in the same place.
+	return a.key < b.key;  // Sort only by position, when searching.
+}
+
+static bool pointTreeOrderFunction(PointTree::Point const &a, PointTree::Point const &b)
+{
+	// Sort by position, and then by the given order, not by pointer address, even if two units are in the same place.
+	return a.key < b.key || (a.key == b.key && a.order < b.order);
 }
 
 void PointTree::sort()
 {
-	std::stable_sort(points.begin(), points.end(), pointTreeSortFunction);  // Stable sort to avoid unspecified behaviour when two objects are in exactly the same place.
+	// Remove points which are gone. Points inserted since the last sort are still at the end.
+	uint32_t generation = currentGeneration;
+	points.erase(std::remove_if(points.begin(), points.end(), [generation](Point const &p) { return p.generation != generation; }), points.end());
+	++currentGeneration;
+
+	// The old points are nearly sorted already, since few objects move past each other between sorts, so use insertion sort, unless that turns out to be slow.
+	const size_t numOld = points.size() - numInserted;
+	const size_t maxMoves = 8 * numOld + 64;
+	size_t moves = 0;
+	for (size_t i = 1; i < numOld && moves <= maxMoves; ++i)
+	{
+		Point point = points[i];
+		size_t j = i;
+		for (; j > 0 && pointTreeOrderFunction(point, points[j - 1]); --j)
+		{
+			points[j] = points[j - 1];
+		}
+		points[j] = point;
+		moves += i - j;
+	}
+	if (moves > maxMoves)
+	{
+		std::sort(points.begin(), points.begin() + numOld, pointTreeOrderFunction);
+	}
+
+	// Merge in the new points.
+	std::sort(points.begin() + numOld, points.end(), pointTreeOrderFunction);
+	std::inplace_merge(points.begin(), points.begin() + numOld, points.end(), pointTreeOrderFunction);
+	numInserted = 0;
 }
 
 //#define DUMP_IMAGE  // All x and y coordinates must be in range -500 to 499, if dumping an image.
@@ -233,16 +281,19 @@ PointTree::ResultVector &PointTree::queryMaybeFilter(Filter &filter, int32_t min
 	for (int r = 0; r != numRanges; ++r)
 	{
 		// Find range of points which may be close enough. Range is [i1 ... i2 - 1]. The pointers are ignored when searching.
-		unsigned i1 = std::lower_bound(points.begin(),      points.end(), Point(ranges[r].a, (void *)nullptr), pointTreeSortFunction) - points.begin();
-		unsigned i2 = std::upper_bound(points.begin() + i1, points.end(), Point(ranges[r].z, (void *)nullptr), pointTreeSortFunction) - points.begin();
+		Point a, z;
+		a.key = ranges[r].a;
+		z.key = ranges[r].z;
+		unsigned i1 = std::lower_bound(points.begin(),      points.end(), a, pointTreeSortFunction) - points.begin();
+		unsigned i2 = std::upper_bound(points.begin() + i1, points.end(), z, pointTreeSortFunction) - points.begin();
 
 		for (unsigned i = current<IsFiltered>(filter.data, i1); i < i2; i = current<IsFiltered>(filter.data, i + 1))
 		{
-			uint64_t px = points[i].first & 0xAAAAAAAAAAAAAAAAULL;
-			uint64_t py = points[i].first & 0x5555555555555555ULL;
+			uint64_t px = points[i].key & 0xAAAAAAAAAAAAAAAAULL;
+			uint64_t py = points[i].key & 0x5555555555555555ULL;
 			if (px >= minX && px <= maxX && py >= minY && py <= maxY)  // Only add point if it's at least in the desired square.
 			{
-				lastQueryResults.push_back(points[i].second);
+				lastQueryResults.push_back(points[i].data);
 				if (IsFiltered)
 				{
 					lastFilteredQueryIndices.push_back(i);
@@ -250,9 +301,9 @@ PointTree::ResultVector &PointTree::queryMaybeFilter(Filter &filter, int32_t min
 #ifdef DUMP_IMAGE
 				if (doDump)
 				{
-					ppm[((int32_t *)points[i].second)[1] + 500][((int32_t *)points[i].second)[0] + 500][0] = 192;
-					ppm[((int32_t *)points[i].second)[1] + 500][((int32_t *)points[i].second)[0] + 500][1] = 128;
-					ppm[((int32_t *)points[i].second)[1] + 500][((int32_t *)points[i].second)[0] + 500][2] = 0;
+					ppm[((int32_t *)points[i].data)[1] + 500][((int32_t *)points[i].data)[0] + 500][0] = 192;
+					ppm[((int32_t *)points[i].data)[1] + 500][((int32_t *)points[i].data)[0] + 500][1] = 128;
+					ppm[((int32_t *)points[i].data)[1] + 500][((int32_t *)points[i].data)[0] + 500][2] = 0;
 				}
 #endif //DUMP_IMAGE
 			}
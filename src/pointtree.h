@@ -30,6 +30,13 @@ class PointTree
 public:
 	typedef std::vector<void *> ResultVector;
 	typedef std::vector<unsigned> IndexVector;
+	struct Point
+	{
+		uint64_t key;                   ///< Morton number of the position.
+		void *data;
+		uint32_t order;                 ///< Order of points with the same key.
+		uint32_t generation;            ///< Value of currentGeneration when last inserted or updated.
+	};
 	class Filter  ///< Filters are invalidated when modifying the PointTree.
 	{
 	public:
@@ -52,9 +59,23 @@ public:
 		Data data;
 	};
 
-	void insert(void *pointData, int32_t x, int32_t y);                       ///< Inserts a point into the point tree.
+	/// Inserts a point into the point tree. Points in the same place are sorted by order.
+	void insert(void *pointData, int32_t x, int32_t y, uint32_t order);
+	/// Moves the point at index (as found by pointData()), and keeps it in the tree after the next sort().
+	void update(unsigned index, int32_t x, int32_t y, uint32_t order);
 	void clear();                                                             ///< Clears the PointTree.
-	void sort();                                                              ///< Must be done between inserting and querying, to get meaningful results.
+	/// Removes points which were neither inserted nor updated since the last sort, and sorts the rest.
+	/// Must be done between inserting/updating and querying, to get meaningful results.
+	/// Fast if the points are still nearly in the same order as after the last sort.
+	void sort();
+	unsigned size() const
+	{
+		return points.size();
+	}
+	void *pointData(unsigned index) const
+	{
+		return points[index].data;
+	}
 	/// Returns all points less than or equal to radius from (x, y), possibly plus some extra nearby points.
 	/// (More specifically, returns all objects in a square with edge length 2*radius.)
 	/// Note: Not thread safe, because it modifies lastQueryResults.
@@ -70,13 +91,14 @@ public:
 	IndexVector lastFilteredQueryIndices;
 
 private:
-	typedef std::pair<uint64_t, void *> Point;
 	typedef std::vector<Point> Vector;
 
 	template<bool IsFiltered>
 	ResultVector &queryMaybeFilter(Filter &filter, int32_t minXo, int32_t maxXo, int32_t minYo, int32_t maxYo);
 
 	Vector points;
+	unsigned numInserted = 0;           ///< Number of points at the end of points, which were inserted since the last sort.
+	uint32_t currentGeneration = 0;
 };
 
 #endif //_point_tree_h
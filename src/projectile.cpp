@@ -59,6 +59,7 @@
 
 #include <algorithm>
 #include <functional>
+#include <unordered_map>
 #ifndef GLM_ENABLE_EXPERIMENTAL
 	#define GLM_ENABLE_EXPERIMENTAL
 #endif
@@ -88,6 +89,23 @@ static std::vector<PROJECTILE *> psProjectileList;
 /* The next projectile to give out in the proj_First / proj_Next methods */
 static ProjectileIterator psProjectileNext;
 
+/// What proj_InFlightFunc() needs to know about the objects a projectile might hit, which does not change during proj_UpdateAll().
+/// Kept as separate arrays, so that the objects which can't possibly be hit can be ruled out in one tight loop.
+struct ProjectileCandidates
+{
+	std::vector<BASE_OBJECT *> psObj;
+	std::vector<int32_t> posX, posY, posZ;     ///< Where the object is now.
+	std::vector<int32_t> prevX, prevY, prevZ;  ///< Where the object was at the start of the tick.
+	std::vector<int32_t> sizeX, sizeY;         ///< Half width and breadth, or radius if circular.
+	std::vector<int32_t> height;
+	std::vector<uint8_t> isRectangular;
+	std::vector<uint8_t> onGround;             ///< Structures, features and droids which are not flying.
+	std::vector<uint8_t> mayHit;               ///< Scratch space for proj_InFlightFunc().
+};
+
+/// Objects near each region, found at most once per proj_UpdateAll().
+static std::unordered_map<uint32_t, ProjectileCandidates> projectileCandidates;
+
 /***************************************************************************/
 
 // the last unit that did damage - used by script functions
@@ -688,6 +706,64 @@ static int32_t collisionXYZ(Vector3i v1, Vector3i v2, ObjectShape shape, int32_t
 	return -1;
 }
 
+/// Finds a superset of what gridStartIterate(x, y, PROJ_NEIGHBOUR_RANGE) would find, in the same order, shared by all
+/// projectiles in the same region during a proj_UpdateAll(). Filter with gridIsFoundByIterate() to get the exact set.
+static ProjectileCandidates &proj_Candidates(int32_t x, int32_t y)
+{
+	const uint32_t key = gridRegionKey(x, y);
+
+	auto it = projectileCandidates.find(key);
+	if (it != projectileCandidates.end())
+	{
+		return it->second;
+	}
+
+	GridList const &gridList = gridStartIterateRegion(x, y, PROJ_NEIGHBOUR_RANGE);
+
+	ProjectileCandidates &candidates = projectileCandidates[key];
+	for (BASE_OBJECT *psObj : gridList)
+	{
+		const Vector3i prevPos = isDroid(psObj) ? castDroid(psObj)->prevSpacetime.pos : psObj->pos;
+		const ObjectShape shape = establishTargetShape(psObj);
+		candidates.psObj.push_back(psObj);
+		candidates.posX.push_back(psObj->pos.x);
+		candidates.posY.push_back(psObj->pos.y);
+		candidates.posZ.push_back(psObj->pos.z);
+		candidates.prevX.push_back(prevPos.x);
+		candidates.prevY.push_back(prevPos.y);
+		candidates.prevZ.push_back(prevPos.z);
+		candidates.sizeX.push_back(shape.size.x);
+		candidates.sizeY.push_back(shape.size.y);
+		candidates.height.push_back(establishTargetHeight(psObj));
+		candidates.isRectangular.push_back(shape.isRectangular);
+		candidates.onGround.push_back(psObj->type == OBJ_STRUCTURE || psObj->type == OBJ_FEATURE || (psObj->type == OBJ_DROID && !isFlying(castDroid(psObj))));
+	}
+	candidates.mayHit.resize(gridList.size());
+	return candidates;
+}
+
+/// Sets mayHit for the candidates whose bounding box the projectile passes through. collisionXYZ() can't find a
+/// collision with any other candidate, since then the path is entirely on one side of the object in some direction.
+static void proj_MarkPossibleHits(ProjectileCandidates &candidates, Vector3i from, Vector3i to)
+{
+	const size_t size = candidates.psObj.size();
+	const int32_t *posX = candidates.posX.data(), *posY = candidates.posY.data(), *posZ = candidates.posZ.data();
+	const int32_t *prevX = candidates.prevX.data(), *prevY = candidates.prevY.data(), *prevZ = candidates.prevZ.data();
+	const int32_t *sizeX = candidates.sizeX.data(), *sizeY = candidates.sizeY.data(), *height = candidates.height.data();
+	uint8_t *mayHit = candidates.mayHit.data();
+	// No branches, so that the compiler can do several candidates at once.
+	for (size_t i = 0; i < size; ++i)
+	{
+		const int32_t x1 = from.x - prevX[i], x2 = to.x - posX[i];
+		const int32_t y1 = from.y - prevY[i], y2 = to.y - posY[i];
+		const int32_t z1 = from.z - prevZ[i], z2 = to.z - posZ[i];
+		const bool missX = ((x1 > sizeX[i]) & (x2 > sizeX[i])) | ((x1 < -sizeX[i]) & (x2 < -sizeX[i]));
+		const bool missY = ((y1 > sizeY[i]) & (y2 > sizeY[i])) | ((y1 < -sizeY[i]) & (y2 < -sizeY[i]));
+		const bool missZ = ((z1 > height[i]) & (z2 > height[i])) | ((z1 < -height[i]) & (z2 < -height[i]));
+		mayHit[i] = !(missX | missY | missZ);
+	}
+}
+
 static void proj_InFlightFunc(PROJECTILE *psProj)
 {
 	/* we want a delay between Las-Sats firing and actually hitting in multiPlayer
@@ -810,11 +886,16 @@ static void proj_InFlightFunc(PROJECTILE *psProj)
 	closestCollisionSpacetime.time = 0xFFFFFFFF;
 
 	/* Check nearby objects for possible collisions */
-	static GridList gridList;  // static to avoid allocations.
-	gridList = gridStartIterate(psProj->pos.x, psProj->pos.y, PROJ_NEIGHBOUR_RANGE);
-	for (GridIterator gi = gridList.begin(); gi != gridList.end(); ++gi)
+	ProjectileCandidates &candidates = proj_Candidates(psProj->pos.x, psProj->pos.y);
+	proj_MarkPossibleHits(candidates, psProj->prevSpacetime.pos, psProj->pos);
+	for (size_t i = 0; i < candidates.psObj.size(); ++i)
 	{
-		BASE_OBJECT *psTempObj = *gi;
+		if (!candidates.mayHit[i] || !gridIsFoundByIterate(candidates.psObj[i], psProj->pos.x, psProj->pos.y, PROJ_NEIGHBOUR_RANGE))
+		{
+			// Would not be found by gridStartIterate(), or passes by without touching.
+			continue;
+		}
+		BASE_OBJECT *psTempObj = candidates.psObj[i];
 		CHECK_OBJECT(psTempObj);
 
 		if (std::find(psProj->psDamaged.begin(), psProj->psDamaged.end(), psTempObj) != psProj->psDamaged.end())
@@ -838,23 +919,16 @@ static void proj_InFlightFunc(PROJECTILE *psProj)
 			// No friendly fire unless intentional
 			continue;
 		}
-		else if (!(psStats->surfaceToAir & SHOOT_ON_GROUND) &&
-		         (psTempObj->type == OBJ_STRUCTURE ||
-		          psTempObj->type == OBJ_FEATURE ||
-		          (psTempObj->type == OBJ_DROID && !isFlying((DROID *)psTempObj))
-		         ))
+		else if (!(psStats->surfaceToAir & SHOOT_ON_GROUND) && candidates.onGround[i])
 		{
 			// AA weapons should not hit buildings and non-vtol droids
 			continue;
 		}
 
-		Vector3i psTempObjPrevPos = isDroid(psTempObj) ? castDroid(psTempObj)->prevSpacetime.pos : psTempObj->pos;
-
-		const Vector3i diff = psProj->pos - psTempObj->pos;
-		const Vector3i prevDiff = psProj->prevSpacetime.pos - psTempObjPrevPos;
-		const unsigned int targetHeight = establishTargetHeight(psTempObj);
-		const ObjectShape targetShape = establishTargetShape(psTempObj);
-		const int32_t collision = collisionXYZ(prevDiff, diff, targetShape, targetHeight);
+		const Vector3i diff = psProj->pos - Vector3i(candidates.posX[i], candidates.posY[i], candidates.posZ[i]);
+		const Vector3i prevDiff = psProj->prevSpacetime.pos - Vector3i(candidates.prevX[i], candidates.prevY[i], candidates.prevZ[i]);
+		const ObjectShape targetShape = candidates.isRectangular[i] ? ObjectShape(candidates.sizeX[i], candidates.sizeY[i]) : ObjectShape(candidates.sizeX[i]);
+		const int32_t collision = collisionXYZ(prevDiff, diff, targetShape, candidates.height[i]);
 		const uint32_t collisionTime = psProj->prevSpacetime.time + (psProj->time - psProj->prevSpacetime.time) * collision / 1024;
 
 		if (collision >= 0 && collisionTime < closestCollisionSpacetime.time)
@@ -1345,6 +1419,8 @@ void proj_UpdateAll()
 
 	// Update all projectiles. Penetrating projectiles may add to psProjectileList.
 	std::for_each(psProjectileListOld.begin(), psProjectileListOld.end(), std::mem_fun(&PROJECTILE::update));
+	// Objects only move outside proj_UpdateAll(), so the candidates found for a region were valid until now.
+	projectileCandidates.clear();
 
 	// Remove and free dead projectiles.
 	psProjectileList.erase(std::remove_if(psProjectileList.begin(), psProjectileList.end(), std::mem_fun(&PROJECTILE::deleteIfDead)), psProjectileList.end());
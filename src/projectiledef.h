@@ -42,6 +42,9 @@ struct PROJECTILE : public SIMPLE_OBJECT
 {
 	PROJECTILE(uint32_t id, unsigned player) : SIMPLE_OBJECT(OBJ_PROJECTILE, id, player) {}
 
+	static void *operator new(size_t size);                 ///< Allocated from a pool, see objmem.cpp.
+	static void operator delete(void *object, size_t size);
+
 	void            update();
 	bool            deleteIfDead()
 	{
@@ -60,6 +60,8 @@
 #include <QtScript/QScriptSyntaxCheckResult>
 #include <QtCore/QList>
 #include <QtCore/QQueue>
+#include <QtCore/QVector>
+#include <QtCore/QPair>
 #include <QtCore/QString>
 #include <QtCore/QStringList>
 #include <QtCore/QFileInfo>
@@ -169,6 +171,147 @@ typedef QHash<QString, MONITOR_BIN> MONITOR;
 static QHash<QScriptEngine *, MONITOR *> monitors;
 static QHash<QScriptEngine *, QStringList> eventNamespaces; // separate event namespaces for libraries
 
+/// Events with a fixed name, which are dispatched through the per-engine handler cache
+enum SCRIPT_EVENT
+{
+	EVENT_GAME_INIT,
+	EVENT_START_LEVEL,
+	EVENT_LAUNCH_TRANSPORTER,
+	EVENT_TRANSPORTER_LAUNCH,
+	EVENT_REINFORCEMENTS_ARRIVED,
+	EVENT_TRANSPORTER_ARRIVED,
+	EVENT_DELIVERY_POINT_MOVING,
+	EVENT_DELIVERY_POINT_MOVED,
+	EVENT_OBJECT_RECYCLED,
+	EVENT_TRANSPORTER_EXIT,
+	EVENT_TRANSPORTER_DONE,
+	EVENT_TRANSPORTER_LANDED,
+	EVENT_MISSION_TIMEOUT,
+	EVENT_VIDEO_DONE,
+	EVENT_GAME_LOADED,
+	EVENT_GAME_SAVING,
+	EVENT_GAME_SAVED,
+	EVENT_DESIGN_BODY,
+	EVENT_DESIGN_PROPULSION,
+	EVENT_DESIGN_WEAPON,
+	EVENT_DESIGN_COMMAND,
+	EVENT_DESIGN_SYSTEM,
+	EVENT_DESIGN_QUIT,
+	EVENT_MENU_BUILD_SELECTED,
+	EVENT_MENU_RESEARCH_SELECTED,
+	EVENT_MENU_BUILD,
+	EVENT_MENU_RESEARCH,
+	EVENT_MENU_DESIGN,
+	EVENT_MENU_MANUFACTURE,
+	EVENT_SELECTION_CHANGED,
+	EVENT_PLAYER_LEFT,
+	EVENT_CHEAT_MODE,
+	EVENT_DROID_IDLE,
+	EVENT_DROID_BUILT,
+	EVENT_STRUCTURE_BUILT,
+	EVENT_STRUCTURE_DEMOLISH,
+	EVENT_STRUCTURE_READY,
+	EVENT_ATTACKED,
+	EVENT_RESEARCHED,
+	EVENT_DESTROYED,
+	EVENT_PICKUP,
+	EVENT_OBJECT_SEEN,
+	EVENT_GROUP_SEEN,
+	EVENT_OBJECT_TRANSFER,
+	EVENT_CHAT,
+	EVENT_BEACON,
+	EVENT_BEACON_REMOVED,
+	EVENT_GROUP_LOSS,
+	EVENT_DESIGN_CREATED,
+	EVENT_ALLIANCE_OFFER,
+	EVENT_ALLIANCE_ACCEPTED,
+	EVENT_ALLIANCE_BROKEN,
+	EVENT_SYNC_REQUEST,
+	EVENT_KEY_PRESSED,
+	EVENT_MAX
+};
+
+static const char *eventNames[EVENT_MAX] =
+{
+	"eventGameInit",
+	"eventStartLevel",
+	"eventLaunchTransporter",
+	"eventTransporterLaunch",
+	"eventReinforcementsArrived",
+	"eventTransporterArrived",
+	"eventDeliveryPointMoving",
+	"eventDeliveryPointMoved",
+	"eventObjectRecycled",
+	"eventTransporterExit",
+	"eventTransporterDone",
+	"eventTransporterLanded",
+	"eventMissionTimeout",
+	"eventVideoDone",
+	"eventGameLoaded",
+	"eventGameSaving",
+	"eventGameSaved",
+	"eventDesignBody",
+	"eventDesignPropulsion",
+	"eventDesignWeapon",
+	"eventDesignCommand",
+	"eventDesignSystem",
+	"eventDesignQuit",
+	"eventMenuBuildSelected",
+	"eventMenuResearchSelected",
+	"eventMenuBuild",
+	"eventMenuResearch",
+	"eventMenuDesign",
+	"eventMenuManufacture",
+	"eventSelectionChanged",
+	"eventPlayerLeft",
+	"eventCheatMode",
+	"eventDroidIdle",
+	"eventDroidBuilt",
+	"eventStructureBuilt",
+	"eventStructureDemolish",
+	"eventStructureReady",
+	"eventAttacked",
+	"eventResearched",
+	"eventDestroyed",
+	"eventPickup",
+	"eventObjectSeen",
+	"eventGroupSeen",
+	"eventObjectTransfer",
+	"eventChat",
+	"eventBeacon",
+	"eventBeaconRemoved",
+	"eventGroupLoss",
+	"eventDesignCreated",
+	"eventAllianceOffer",
+	"eventAllianceAccepted",
+	"eventAllianceBroken",
+	"eventSyncRequest",
+	"eventKeyPressed",
+};
+
+/// Cached handlers for one event, in the order they are called (namespaced variants first)
+struct EVENT_HANDLERS
+{
+	uint32_t generation = 0;
+	QVector<QPair<QString, QScriptValue>> functions;
+};
+
+/// Per-engine event dispatch table. Evaluating script code, loading saved globals or changing
+/// the player bumps the generation, and entries are looked up again lazily the next time their
+/// event fires. Events without a cached handler are looked up every time, so that handlers
+/// assigned by running script code are called right away, and cached ones are checked by name
+/// before being called. Engines that do not handle an event are still skipped without
+/// converting the event arguments.
+struct EVENT_DISPATCH
+{
+	uint32_t generation = 1;
+	uint32_t playerGeneration = 0;
+	int me = -1;
+	bool receiveAll = false;
+	EVENT_HANDLERS events[EVENT_MAX];
+};
+static QHash<QScriptEngine *, EVENT_DISPATCH *> dispatchTables;
+
 static MODELMAP models;
 static QStandardItemModel *triggerModel;
 static bool globalDialog = false;
@@ -184,30 +327,19 @@ void doNotSaveGlobal(const QString &global)
 	internalNamespace.insert(global);
 }
 
-// Call a function by name
-static QScriptValue callFunction(QScriptEngine *engine, const QString &function, const QScriptValueList &args, bool event = true)
+/// Globals of this engine may have changed, look up its event handlers again
+void invalidateEventDispatch(QScriptEngine *engine)
 {
-	if (event)
+	EVENT_DISPATCH *table = dispatchTables.value(engine);
+	if (table)
 	{
-		// recurse into variants, if any
-		for (const QString &s : eventNamespaces[engine])
-		{
-			const QScriptValue &value = engine->globalObject().property(s + function);
-			if (value.isValid() && value.isFunction())
-			{
-				callFunction(engine, s + function, args, event);
-			}
-		}
-	}
-	code_part level = event ? LOG_SCRIPT : LOG_ERROR;
-	QScriptValue value = engine->globalObject().property(function);
-	if (!value.isValid() || !value.isFunction())
-	{
-		// not necessarily an error, may just be a trigger that is not defined (ie not needed)
-		// or it could be a typo in the function name or ...
-		debug(level, "called function (%s) not defined", function.toUtf8().constData());
-		return false;
+		table->generation++;
 	}
+}
+
+// Call a function value, keeping performance statistics under the given name
+static QScriptValue callFunctionValue(QScriptEngine *engine, const QString &function, QScriptValue &value, const QScriptValueList &args)
+{
 	QElapsedTimer timer;
 	timer.start();
 	QScriptValue result = value.call(QScriptValue(), args);
@@ -251,6 +383,125 @@ static QScriptValue callFunction(QScriptEngine *engine, const QString &function,
 	return result;
 }
 
+// Call a function by name
+static QScriptValue callFunction(QScriptEngine *engine, const QString &function, const QScriptValueList &args, bool event = true)
+{
+	if (event)
+	{
+		// recurse into variants, if any
+		for (const QString &s : eventNamespaces[engine])
+		{
+			const QScriptValue &value = engine->globalObject().property(s + function);
+			if (value.isValid() && value.isFunction())
+			{
+				callFunction(engine, s + function, args, event);
+			}
+		}
+	}
+	code_part level = event ? LOG_SCRIPT : LOG_ERROR;
+	QScriptValue value = engine->globalObject().property(function);
+	if (!value.isValid() || !value.isFunction())
+	{
+		// not necessarily an error, may just be a trigger that is not defined (ie not needed)
+		// or it could be a typo in the function name or ...
+		debug(level, "called function (%s) not defined", function.toUtf8().constData());
+		return false;
+	}
+	return callFunctionValue(engine, function, value, args);
+}
+
+// Collect the handlers for an event in the same order as callFunction() would call them
+static void findEventHandlers(QScriptEngine *engine, const QString &function, EVENT_HANDLERS &handlers)
+{
+	for (const QString &s : eventNamespaces[engine])
+	{
+		const QScriptValue &value = engine->globalObject().property(s + function);
+		if (value.isValid() && value.isFunction())
+		{
+			findEventHandlers(engine, s + function, handlers);
+		}
+	}
+	QScriptValue value = engine->globalObject().property(function);
+	if (value.isValid() && value.isFunction())
+	{
+		handlers.functions.append(qMakePair(function, value));
+	}
+}
+
+/// The cached handlers of an event, or nullptr if the engine has no dispatch table
+static EVENT_HANDLERS *eventHandlers(QScriptEngine *engine, SCRIPT_EVENT event)
+{
+	EVENT_DISPATCH *table = dispatchTables.value(engine);
+	if (table == nullptr)
+	{
+		return nullptr;
+	}
+	EVENT_HANDLERS &handlers = table->events[event];
+	// a miss is never trusted, as running script code may have assigned the handler since
+	if (handlers.generation != table->generation || handlers.functions.isEmpty())
+	{
+		handlers.functions.clear();
+		findEventHandlers(engine, QString(eventNames[event]), handlers);
+		handlers.generation = table->generation;
+	}
+	return &handlers;
+}
+
+/// Does this engine handle the event at all? If not, there is no need to prepare its arguments.
+static bool hasEvent(QScriptEngine *engine, SCRIPT_EVENT event)
+{
+	EVENT_HANDLERS *handlers = eventHandlers(engine, event);
+	return handlers == nullptr || !handlers->functions.isEmpty();
+}
+
+// Call an event through the dispatch table
+static void callEvent(QScriptEngine *engine, SCRIPT_EVENT event, const QScriptValueList &args)
+{
+	EVENT_HANDLERS *handlers = eventHandlers(engine, event);
+	if (handlers == nullptr)
+	{
+		callFunction(engine, QString(eventNames[event]), args);
+		return;
+	}
+	// copy, since a handler may evaluate code and so invalidate the table
+	QVector<QPair<QString, QScriptValue>> functions = handlers->functions;
+	if (functions.isEmpty())
+	{
+		debug(LOG_SCRIPT, "called function (%s) not defined", eventNames[event]);
+		return;
+	}
+	for (const auto &function : functions)
+	{
+		// the script may have replaced the handler since it was cached, check it by name as callFunction() would
+		QScriptValue value = engine->globalObject().property(function.first);
+		if (!value.isValid() || !value.isFunction())
+		{
+			continue;
+		}
+		callFunctionValue(engine, function.first, value, args);
+	}
+}
+
+/// The player this engine runs as, and whether it wants the events of all players
+static void scriptPlayer(QScriptEngine *engine, int &me, bool &receiveAll)
+{
+	EVENT_DISPATCH *table = dispatchTables.value(engine);
+	if (table == nullptr)
+	{
+		me = engine->globalObject().property("me").toInt32();
+		receiveAll = engine->globalObject().property("isReceivingAllEvents").toBool();
+		return;
+	}
+	if (table->playerGeneration != table->generation)
+	{
+		table->me = engine->globalObject().property("me").toInt32();
+		table->receiveAll = engine->globalObject().property("isReceivingAllEvents").toBool();
+		table->playerGeneration = table->generation;
+	}
+	me = table->me;
+	receiveAll = table->receiveAll;
+}
+
 //-- ## setTimer(function, milliseconds[, object])
 //--
 //-- Set a function to run repeated at some given time interval. The function to run
@@ -417,6 +668,7 @@ static QScriptValue js_namespace(QScriptContext *context, QScriptEngine *engine)
 {
 	QString prefix(context->argument(0).toString());
 	eventNamespaces[engine].append(prefix);
+	invalidateEventDispatch(engine);
 	return QScriptValue(true);
 }
 
@@ -458,6 +710,7 @@ static QScriptValue js_include(QScriptContext *context, QScriptEngine *engine)
 	context->setActivationObject(engine->globalObject());
 	context->setThisObject(engine->globalObject());
 	QScriptValue result = engine->evaluate(source, path);
+	invalidateEventDispatch(engine);
 	if (engine->hasUncaughtException())
 	{
 		int line = engine->uncaughtExceptionLineNumber();
@@ -518,11 +771,13 @@ bool shutdownScripts()
 		}
 		monitor->clear();
 		delete monitor;
+		delete dispatchTables.value(engine);
 		unregisterFunctions(engine);
 	}
 	timers.clear();
 	internalNamespace.clear();
 	monitors.clear();
+	dispatchTables.clear();
 	while (!scripts.isEmpty())
 	{
 		delete scripts.takeFirst();
@@ -537,17 +792,22 @@ bool updateScripts()
 	{
 		for (auto *engine : scripts)
 		{
+			if (!hasEvent(engine, EVENT_SELECTION_CHANGED))
+			{
+				continue;
+			}
 			QScriptValueList args;
 			args += js_enumSelected(nullptr, engine);
-			callFunction(engine, "eventSelectionChanged", args);
+			callEvent(engine, EVENT_SELECTION_CHANGED, args);
 		}
 		selectionChanged = false;
 	}
 
-	// Update gameTime
+	// Update gameTime, and pick up namespaced variants that running script code added next to a cached handler
 	for (auto *engine : scripts)
 	{
 		engine->globalObject().setProperty("gameTime", gameTime, QScriptValue::ReadOnly | QScriptValue::Undeletable);
+		invalidateEventDispatch(engine);
 	}
 	// Weed out dead timers
 	for (int i = 0; i < timers.count();)
@@ -721,6 +981,7 @@ QScriptEngine *loadPlayerScript(const WzString& path, int player, int difficulty
 
 	MONITOR *monitor = new MONITOR;
 	monitors.insert(engine, monitor);
+	dispatchTables.insert(engine, new EVENT_DISPATCH);
 
 	debug(LOG_SAVE, "Created script engine %d for player %d from %s", scripts.size() - 1, player, path.toUtf8().c_str());
 	return engine;
@@ -830,6 +1091,7 @@ bool loadScriptStates(const char *filename)
 				//			  (mapJsonToQScriptValue handles this properly.)
 				engine->globalObject().setProperty(QString::fromUtf8(keys.at(j).toUtf8().c_str()), mapJsonToQScriptValue(engine, ini.json(keys.at(j)), 0));
 			}
+			invalidateEventDispatch(engine);
 		}
 		else if (engine && list[i].startsWith("groups_"))
 		{
@@ -948,6 +1210,7 @@ bool jsEvaluate(QScriptEngine *engine, const QString &text)
 		return false;
 	}
 	QScriptValue result = engine->evaluate(text);
+	invalidateEventDispatch(engine);
 	if (engine->hasUncaughtException())
 	{
 		debug(LOG_ERROR, "Uncaught exception in %s: %s",
@@ -967,8 +1230,8 @@ void jsAutogameSpecific(const WzString &name, int player)
 		return;
 	}
 	console("Loaded the %s AI script for current player!", name.toUtf8().c_str());
-	callFunction(engine, "eventGameInit", QScriptValueList());
-	callFunction(engine, "eventStartLevel", QScriptValueList());
+	callEvent(engine, EVENT_GAME_INIT, QScriptValueList());
+	callEvent(engine, EVENT_START_LEVEL, QScriptValueList());
 }
 
 void jsAutogame()
@@ -1121,8 +1384,9 @@ bool triggerEvent(SCRIPT_TRIGGER_TYPE trigger, BASE_OBJECT *psObj)
 
 		if (psObj)
 		{
-			int player = engine->globalObject().property("me").toInt32();
-			bool receiveAll = engine->globalObject().property("isReceivingAllEvents").toBool();
+			int player;
+			bool receiveAll;
+			scriptPlayer(engine, player, receiveAll);
 			if (player != psObj->player && !receiveAll)
 			{
 				continue;
@@ -1133,92 +1397,92 @@ bool triggerEvent(SCRIPT_TRIGGER_TYPE trigger, BASE_OBJECT *psObj)
 		switch (trigger)
 		{
 		case TRIGGER_GAME_INIT:
-			callFunction(engine, "eventGameInit", QScriptValueList());
+			callEvent(engine, EVENT_GAME_INIT, QScriptValueList());
 			break;
 		case TRIGGER_START_LEVEL:
 			processVisibility(); // make sure we initialize visibility first
-			callFunction(engine, "eventStartLevel", QScriptValueList());
+			callEvent(engine, EVENT_START_LEVEL, QScriptValueList());
 			break;
 		case TRIGGER_TRANSPORTER_LAUNCH:
-			callFunction(engine, "eventLaunchTransporter", QScriptValueList()); // deprecated!
-			callFunction(engine, "eventTransporterLaunch", args);
+			callEvent(engine, EVENT_LAUNCH_TRANSPORTER, QScriptValueList()); // deprecated!
+			callEvent(engine, EVENT_TRANSPORTER_LAUNCH, args);
 			break;
 		case TRIGGER_TRANSPORTER_ARRIVED:
-			callFunction(engine, "eventReinforcementsArrived", QScriptValueList()); // deprecated!
-			callFunction(engine, "eventTransporterArrived", args);
+			callEvent(engine, EVENT_REINFORCEMENTS_ARRIVED, QScriptValueList()); // deprecated!
+			callEvent(engine, EVENT_TRANSPORTER_ARRIVED, args);
 			break;
 		case TRIGGER_DELIVERY_POINT_MOVING:
-			callFunction(engine, "eventDeliveryPointMoving", args);
+			callEvent(engine, EVENT_DELIVERY_POINT_MOVING, args);
 			break;
 		case TRIGGER_DELIVERY_POINT_MOVED:
-			callFunction(engine, "eventDeliveryPointMoved", args);
+			callEvent(engine, EVENT_DELIVERY_POINT_MOVED, args);
 			break;
 		case TRIGGER_OBJECT_RECYCLED:
-			callFunction(engine, "eventObjectRecycled", args);
+			callEvent(engine, EVENT_OBJECT_RECYCLED, args);
 			break;
 		case TRIGGER_TRANSPORTER_EXIT:
-			callFunction(engine, "eventTransporterExit", args);
+			callEvent(engine, EVENT_TRANSPORTER_EXIT, args);
 			break;
 		case TRIGGER_TRANSPORTER_DONE:
-			callFunction(engine, "eventTransporterDone", args);
+			callEvent(engine, EVENT_TRANSPORTER_DONE, args);
 			break;
 		case TRIGGER_TRANSPORTER_LANDED:
-			callFunction(engine, "eventTransporterLanded", args);
+			callEvent(engine, EVENT_TRANSPORTER_LANDED, args);
 			break;
 		case TRIGGER_MISSION_TIMEOUT:
-			callFunction(engine, "eventMissionTimeout", QScriptValueList());
+			callEvent(engine, EVENT_MISSION_TIMEOUT, QScriptValueList());
 			break;
 		case TRIGGER_VIDEO_QUIT:
-			callFunction(engine, "eventVideoDone", QScriptValueList());
+			callEvent(engine, EVENT_VIDEO_DONE, QScriptValueList());
 			break;
 		case TRIGGER_GAME_LOADED:
-			callFunction(engine, "eventGameLoaded", QScriptValueList());
+			callEvent(engine, EVENT_GAME_LOADED, QScriptValueList());
 			break;
 		case TRIGGER_GAME_SAVING:
-			callFunction(engine, "eventGameSaving", QScriptValueList());
+			callEvent(engine, EVENT_GAME_SAVING, QScriptValueList());
 			break;
 		case TRIGGER_GAME_SAVED:
-			callFunction(engine, "eventGameSaved", QScriptValueList());
+			callEvent(engine, EVENT_GAME_SAVED, QScriptValueList());
 			break;
 		case TRIGGER_DESIGN_BODY:
-			callFunction(engine, "eventDesignBody", QScriptValueList());
+			callEvent(engine, EVENT_DESIGN_BODY, QScriptValueList());
 			break;
 		case TRIGGER_DESIGN_PROPULSION:
-			callFunction(engine, "eventDesignPropulsion", QScriptValueList());
+			callEvent(engine, EVENT_DESIGN_PROPULSION, QScriptValueList());
 			break;
 		case TRIGGER_DESIGN_WEAPON:
-			callFunction(engine, "eventDesignWeapon", QScriptValueList());
+			callEvent(engine, EVENT_DESIGN_WEAPON, QScriptValueList());
 			break;
 		case TRIGGER_DESIGN_COMMAND:
-			callFunction(engine, "eventDesignCommand", QScriptValueList());
+			callEvent(engine, EVENT_DESIGN_COMMAND, QScriptValueList());
 			break;
 		case TRIGGER_DESIGN_SYSTEM:
-			callFunction(engine, "eventDesignSystem", QScriptValueList());
+			callEvent(engine, EVENT_DESIGN_SYSTEM, QScriptValueList());
 			break;
 		case TRIGGER_DESIGN_QUIT:
-			callFunction(engine, "eventDesignQuit", QScriptValueList());
+			callEvent(engine, EVENT_DESIGN_QUIT, QScriptValueList());
 			break;
 		case TRIGGER_MENU_BUILD_SELECTED:
-			callFunction(engine, "eventMenuBuildSelected", args);
+			callEvent(engine, EVENT_MENU_BUILD_SELECTED, args);
 			break;
 		case TRIGGER_MENU_RESEARCH_SELECTED:
-			callFunction(engine, "eventMenuResearchSelected", args);
+			callEvent(engine, EVENT_MENU_RESEARCH_SELECTED, args);
 			break;
 		case TRIGGER_MENU_BUILD_UP:
 			args += QScriptValue(true);
-			callFunction(engine, "eventMenuBuild", args);
+			callEvent(engine, EVENT_MENU_BUILD, args);
 			break;
 		case TRIGGER_MENU_RESEARCH_UP:
 			args += QScriptValue(true);
-			callFunction(engine, "eventMenuResearch", args);
+			callEvent(engine, EVENT_MENU_RESEARCH, args);
 			break;
 		case TRIGGER_MENU_DESIGN_UP:
 			args += QScriptValue(true);
-			callFunction(engine, "eventMenuDesign", args);
+			callEvent(engine, EVENT_MENU_DESIGN, args);
 			break;
 		case TRIGGER_MENU_MANUFACTURE_UP:
 			args += QScriptValue(true);
-			callFunction(engine, "eventMenuManufacture", args);
+			callEvent(engine, EVENT_MENU_MANUFACTURE, args);
 			break;
 		}
 	}
@@ -1243,7 +1507,7 @@ bool triggerEventPlayerLeft(int id)
 	{
 		QScriptValueList args;
 		args += id;
-		callFunction(engine, "eventPlayerLeft", args);
+		callEvent(engine, EVENT_PLAYER_LEFT, args);
 	}
 	return true;
 }
@@ -1260,7 +1524,7 @@ bool triggerEventCheatMode(bool entered)
 	{
 		QScriptValueList args;
 		args += entered;
-		callFunction(engine, "eventCheatMode", args);
+		callEvent(engine, EVENT_CHEAT_MODE, args);
 	}
 	return true;
 }
@@ -1274,12 +1538,14 @@ bool triggerEventDroidIdle(DROID *psDroid)
 	ASSERT(scriptsReady, "Scripts not initialized yet");
 	for (auto *engine : scripts)
 	{
-		int player = engine->globalObject().property("me").toInt32();
-		if (player == psDroid->player)
+		int player;
+		bool receiveAll;
+		scriptPlayer(engine, player, receiveAll);
+		if (player == psDroid->player && hasEvent(engine, EVENT_DROID_IDLE))
 		{
 			QScriptValueList args;
 			args += convDroid(psDroid, engine);
-			callFunction(engine, "eventDroidIdle", args);
+			callEvent(engine, EVENT_DROID_IDLE, args);
 		}
 	}
 	return true;
@@ -1296,9 +1562,10 @@ bool triggerEventDroidBuilt(DROID *psDroid, STRUCTURE *psFactory)
 	ASSERT(scriptsReady, "Scripts not initialized yet");
 	for (auto *engine : scripts)
 	{
-		int player = engine->globalObject().property("me").toInt32();
-		bool receiveAll = engine->globalObject().property("isReceivingAllEvents").toBool();
-		if (player == psDroid->player || receiveAll)
+		int player;
+		bool receiveAll;
+		scriptPlayer(engine, player, receiveAll);
+		if ((player == psDroid->player || receiveAll) && hasEvent(engine, EVENT_DROID_BUILT))
 		{
 			QScriptValueList args;
 			args += convDroid(psDroid, engine);
@@ -1306,7 +1573,7 @@ bool triggerEventDroidBuilt(DROID *psDroid, STRUCTURE *psFactory)
 			{
 				args += convStructure(psFactory, engine);
 			}
-			callFunction(engine, "eventDroidBuilt", args);
+			callEvent(engine, EVENT_DROID_BUILT, args);
 		}
 	}
 	return true;
@@ -1323,9 +1590,10 @@ bool triggerEventStructBuilt(STRUCTURE *psStruct, DROID *psDroid)
 	ASSERT(scriptsReady, "Scripts not initialized yet");
 	for (auto *engine : scripts)
 	{
-		int player = engine->globalObject().property("me").toInt32();
-		bool receiveAll = engine->globalObject().property("isReceivingAllEvents").toBool();
-		if (player == psStruct->player || receiveAll)
+		int player;
+		bool receiveAll;
+		scriptPlayer(engine, player, receiveAll);
+		if ((player == psStruct->player || receiveAll) && hasEvent(engine, EVENT_STRUCTURE_BUILT))
 		{
 			QScriptValueList args;
 			args += convStructure(psStruct, engine);
@@ -1333,7 +1601,7 @@ bool triggerEventStructBuilt(STRUCTURE *psStruct, DROID *psDroid)
 			{
 				args += convDroid(psDroid, engine);
 			}
-			callFunction(engine, "eventStructureBuilt", args);
+			callEvent(engine, EVENT_STRUCTURE_BUILT, args);
 		}
 	}
 	return true;
@@ -1349,9 +1617,10 @@ bool triggerEventStructDemolish(STRUCTURE *psStruct, DROID *psDroid)
 	ASSERT(scriptsReady, "Scripts not initialized yet");
 	for (auto *engine : scripts)
 	{
-		int player = engine->globalObject().property("me").toInt32();
-		bool receiveAll = engine->globalObject().property("isReceivingAllEvents").toBool();
-		if (player == psStruct->player || receiveAll)
+		int player;
+		bool receiveAll;
+		scriptPlayer(engine, player, receiveAll);
+		if ((player == psStruct->player || receiveAll) && hasEvent(engine, EVENT_STRUCTURE_DEMOLISH))
 		{
 			QScriptValueList args;
 			args += convStructure(psStruct, engine);
@@ -1359,7 +1628,7 @@ bool triggerEventStructDemolish(STRUCTURE *psStruct, DROID *psDroid)
 			{
 				args += convDroid(psDroid, engine);
 			}
-			callFunction(engine, "eventStructureDemolish", args);
+			callEvent(engine, EVENT_STRUCTURE_DEMOLISH, args);
 		}
 	}
 	return true;
@@ -1376,13 +1645,14 @@ bool triggerEventStructureReady(STRUCTURE *psStruct)
 	ASSERT(scriptsReady, "Scripts not initialized yet");
 	for (auto *engine : scripts)
 	{
-		int player = engine->globalObject().property("me").toInt32();
-		bool receiveAll = engine->globalObject().property("isReceivingAllEvents").toBool();
-		if (player == psStruct->player || receiveAll)
+		int player;
+		bool receiveAll;
+		scriptPlayer(engine, player, receiveAll);
+		if ((player == psStruct->player || receiveAll) && hasEvent(engine, EVENT_STRUCTURE_READY))
 		{
 			QScriptValueList args;
 			args += convStructure(psStruct, engine);
-			callFunction(engine, "eventStructureReady", args);
+			callEvent(engine, EVENT_STRUCTURE_READY, args);
 		}
 	}
 	return true;
@@ -1409,14 +1679,15 @@ bool triggerEventAttacked(BASE_OBJECT *psVictim, BASE_OBJECT *psAttacker, int la
 	}
 	for (auto *engine : scripts)
 	{
-		int player = engine->globalObject().property("me").toInt32();
-		bool receiveAll = engine->globalObject().property("isReceivingAllEvents").toBool();
-		if (player == psVictim->player || receiveAll)
+		int player;
+		bool receiveAll;
+		scriptPlayer(engine, player, receiveAll);
+		if ((player == psVictim->player || receiveAll) && hasEvent(engine, EVENT_ATTACKED))
 		{
 			QScriptValueList args;
 			args += convMax(psVictim, engine);
 			args += convMax(psAttacker, engine);
-			callFunction(engine, "eventAttacked", args);
+			callEvent(engine, EVENT_ATTACKED, args);
 		}
 	}
 	return true;
@@ -1440,9 +1711,10 @@ bool triggerEventResearched(RESEARCH *psResearch, STRUCTURE *psStruct, int playe
 	}
 	for (auto *engine : scripts)
 	{
-		int me = engine->globalObject().property("me").toInt32();
-		bool receiveAll = engine->globalObject().property("isReceivingAllEvents").toBool();
-		if (me == player || receiveAll)
+		int me;
+		bool receiveAll;
+		scriptPlayer(engine, me, receiveAll);
+		if ((me == player || receiveAll) && hasEvent(engine, EVENT_RESEARCHED))
 		{
 			QScriptValueList args;
 			args += convResearch(psResearch, engine, player);
@@ -1455,7 +1727,7 @@ bool triggerEventResearched(RESEARCH *psResearch, STRUCTURE *psStruct, int playe
 				args += QScriptValue::NullValue;
 			}
 			args += QScriptValue(player);
-			callFunction(engine, "eventResearched", args);
+			callEvent(engine, EVENT_RESEARCHED, args);
 		}
 	}
 	return true;
@@ -1472,9 +1744,13 @@ bool triggerEventDestroyed(BASE_OBJECT *psVictim)
 	for (int i = 0; i < scripts.size() && psVictim; ++i)
 	{
 		QScriptEngine *engine = scripts.at(i);
+		if (!hasEvent(engine, EVENT_DESTROYED))
+		{
+			continue;
+		}
 		QScriptValueList args;
 		args += convMax(psVictim, engine);
-		callFunction(engine, "eventDestroyed", args);
+		callEvent(engine, EVENT_DESTROYED, args);
 	}
 	return true;
 }
@@ -1490,10 +1766,14 @@ bool triggerEventPickup(FEATURE *psFeat, DROID *psDroid)
 	ASSERT(scriptsReady, "Scripts not initialized yet");
 	for (auto *engine : scripts)
 	{
+		if (!hasEvent(engine, EVENT_PICKUP))
+		{
+			continue;
+		}
 		QScriptValueList args;
 		args += convFeature(psFeat, engine);
 		args += convDroid(psDroid, engine);
-		callFunction(engine, "eventPickup", args);
+		callEvent(engine, EVENT_PICKUP, args);
 	}
 	return true;
 }
@@ -1520,19 +1800,19 @@ bool triggerEventSeen(BASE_OBJECT *psViewer, BASE_OBJECT *psSeen)
 	{
 		QScriptEngine *engine = scripts.at(i);
 		std::pair<bool, int> callbacks = seenLabelCheck(engine, psSeen, psViewer);
-		if (callbacks.first)
+		if (callbacks.first && hasEvent(engine, EVENT_OBJECT_SEEN))
 		{
 			QScriptValueList args;
 			args += convMax(psViewer, engine);
 			args += convMax(psSeen, engine);
-			callFunction(engine, "eventObjectSeen", args);
+			callEvent(engine, EVENT_OBJECT_SEEN, args);
 		}
-		if (callbacks.second)
+		if (callbacks.second && hasEvent(engine, EVENT_GROUP_SEEN))
 		{
 			QScriptValueList args;
 			args += convMax(psViewer, engine);
 			args += QScriptValue(callbacks.second); // group id
-			callFunction(engine, "eventGroupSeen", args);
+			callEvent(engine, EVENT_GROUP_SEEN, args);
 		}
 	}
 	return true;
@@ -1551,14 +1831,15 @@ bool triggerEventObjectTransfer(BASE_OBJECT *psObj, int from)
 	for (int i = 0; i < scripts.size() && psObj; ++i)
 	{
 		QScriptEngine *engine = scripts.at(i);
-		int me = engine->globalObject().property("me").toInt32();
-		bool receiveAll = engine->globalObject().property("isReceivingAllEvents").toBool();
-		if (me == psObj->player || me == from || receiveAll)
+		int me;
+		bool receiveAll;
+		scriptPlayer(engine, me, receiveAll);
+		if ((me == psObj->player || me == from || receiveAll) && hasEvent(engine, EVENT_OBJECT_TRANSFER))
 		{
 			QScriptValueList args;
 			args += convMax(psObj, engine);
 			args += QScriptValue(from);
-			callFunction(engine, "eventObjectTransfer", args);
+			callEvent(engine, EVENT_OBJECT_TRANSFER, args);
 		}
 	}
 	return true;
@@ -1575,15 +1856,16 @@ bool triggerEventChat(int from, int to, const char *message)
 	for (int i = 0; scriptsReady && message && i < scripts.size(); ++i)
 	{
 		QScriptEngine *engine = scripts.at(i);
-		int me = engine->globalObject().property("me").toInt32();
-		bool receiveAll = engine->globalObject().property("isReceivingAllEvents").toBool();
-		if (me == to || (receiveAll && to == from))
+		int me;
+		bool receiveAll;
+		scriptPlayer(engine, me, receiveAll);
+		if ((me == to || (receiveAll && to == from)) && hasEvent(engine, EVENT_CHAT))
 		{
 			QScriptValueList args;
 			args += QScriptValue(from);
 			args += QScriptValue(to);
 			args += QScriptValue(QString(message));
-			callFunction(engine, "eventChat", args);
+			callEvent(engine, EVENT_CHAT, args);
 		}
 	}
 	return true;
@@ -1599,9 +1881,10 @@ bool triggerEventBeacon(int from, int to, const char *message, int x, int y)
 {
 	for (auto *engine : scripts)
 	{
-		int me = engine->globalObject().property("me").toInt32();
-		bool receiveAll = engine->globalObject().property("isReceivingAllEvents").toBool();
-		if (me == to || receiveAll)
+		int me;
+		bool receiveAll;
+		scriptPlayer(engine, me, receiveAll);
+		if ((me == to || receiveAll) && hasEvent(engine, EVENT_BEACON))
 		{
 			QScriptValueList args;
 			args += QScriptValue(map_coord(x));
@@ -1612,7 +1895,7 @@ bool triggerEventBeacon(int from, int to, const char *message, int x, int y)
 			{
 				args += QScriptValue(QString(message));
 			}
-			callFunction(engine, "eventBeacon", args);
+			callEvent(engine, EVENT_BEACON, args);
 		}
 	}
 	return true;
@@ -1628,14 +1911,15 @@ bool triggerEventBeaconRemoved(int from, int to)
 	ASSERT(scriptsReady, "Scripts not initialized yet");
 	for (auto *engine : scripts)
 	{
-		int me = engine->globalObject().property("me").toInt32();
-		bool receiveAll = engine->globalObject().property("isReceivingAllEvents").toBool();
-		if (me == to || receiveAll)
+		int me;
+		bool receiveAll;
+		scriptPlayer(engine, me, receiveAll);
+		if ((me == to || receiveAll) && hasEvent(engine, EVENT_BEACON_REMOVED))
 		{
 			QScriptValueList args;
 			args += QScriptValue(from);
 			args += QScriptValue(to);
-			callFunction(engine, "eventBeaconRemoved", args);
+			callEvent(engine, EVENT_BEACON_REMOVED, args);
 		}
 	}
 	return true;
@@ -1667,11 +1951,15 @@ bool triggerEventSelected()
 bool triggerEventGroupLoss(BASE_OBJECT *psObj, int group, int size, QScriptEngine *engine)
 {
 	ASSERT(scriptsReady, "Scripts not initialized yet");
+	if (!hasEvent(engine, EVENT_GROUP_LOSS))
+	{
+		return true;
+	}
 	QScriptValueList args;
 	args += convMax(psObj, engine);
 	args += QScriptValue(group);
 	args += QScriptValue(size);
-	callFunction(engine, "eventGroupLoss", args);
+	callEvent(engine, EVENT_GROUP_LOSS, args);
 	return true;
 }
 
@@ -1712,9 +2000,13 @@ bool triggerEventDesignCreated(DROID_TEMPLATE *psTemplate)
 	ASSERT(scriptsReady, "Scripts not initialized yet");
 	for (auto *engine : scripts)
 	{
+		if (!hasEvent(engine, EVENT_DESIGN_CREATED))
+		{
+			continue;
+		}
 		QScriptValueList args;
 		args += convTemplate(psTemplate, engine);
-		callFunction(engine, "eventDesignCreated", args);
+		callEvent(engine, EVENT_DESIGN_CREATED, args);
 	}
 	return true;
 }
@@ -1730,7 +2022,7 @@ bool triggerEventAllianceOffer(uint8_t from, uint8_t to)
 		QScriptValueList args;
 		args += QScriptValue(from);
 		args += QScriptValue(to);
-		callFunction(engine, "eventAllianceOffer", args);
+		callEvent(engine, EVENT_ALLIANCE_OFFER, args);
 	}
 	return true;
 }
@@ -1746,7 +2038,7 @@ bool triggerEventAllianceAccepted(uint8_t from, uint8_t to)
 		QScriptValueList args;
 		args += QScriptValue(from);
 		args += QScriptValue(to);
-		callFunction(engine, "eventAllianceAccepted", args);
+		callEvent(engine, EVENT_ALLIANCE_ACCEPTED, args);
 	}
 	return true;
 }
@@ -1762,7 +2054,7 @@ bool triggerEventAllianceBroken(uint8_t from, uint8_t to)
 		QScriptValueList args;
 		args += QScriptValue(from);
 		args += QScriptValue(to);
-		callFunction(engine, "eventAllianceBroken", args);
+		callEvent(engine, EVENT_ALLIANCE_BROKEN, args);
 	}
 	return true;
 }
@@ -1778,6 +2070,10 @@ bool triggerEventSyncRequest(int from, int req_id, int x, int y, BASE_OBJECT *ps
 	ASSERT(scriptsReady, "Scripts not initialized yet");
 	for (auto *engine : scripts)
 	{
+		if (!hasEvent(engine, EVENT_SYNC_REQUEST))
+		{
+			continue;
+		}
 		QScriptValueList args;
 		args += QScriptValue(from);
 		args += QScriptValue(req_id);
@@ -1791,7 +2087,7 @@ bool triggerEventSyncRequest(int from, int req_id, int x, int y, BASE_OBJECT *ps
 		{
 			args += convMax(psObj2, engine);
 		}
-		callFunction(engine, "eventSyncRequest", args);
+		callEvent(engine, EVENT_SYNC_REQUEST, args);
 	}
 	return true;
 }
@@ -1808,7 +2104,7 @@ bool triggerEventKeyPressed(int meta, int key)
 		QScriptValueList args;
 		args += QScriptValue(meta);
 		args += QScriptValue(key);
-		callFunction(engine, "eventKeyPressed", args);
+		callEvent(engine, EVENT_KEY_PRESSED, args);
 	}
 	return true;
 }
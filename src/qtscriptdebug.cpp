@@ -53,7 +53,9 @@
 #include "lib/netplay/netplay.h"
 
 #include "action.h"
+#include "astar.h"
 #include "difficulty.h"
+#include "effects.h"
 #include "multiplay.h"
 #include "objects.h"
 #include "power.h"
@@ -209,6 +211,18 @@ static void fillMainModel(QStandardItemModel &m)
 	KEYVAL("difficultyLevel", difficulty_type.at(getDifficultyLevel()));
 	KEYVAL("loopPieCount", QString::number(loopPieCount));
 	KEYVAL("loopPolyCount", QString::number(loopPolyCount));
+	KEYVAL("loopDrawCallCount", QString::number(loopDrawCallCount));
+	KEYVAL("loopStateChangeCount", QString::number(loopStateChangeCount));
+	KEYVAL("loopTerrainSectorCount", QString::number(loopTerrainSectorCount));
+	KEYVAL("loopTerrainTriangleCount", QString::number(loopTerrainTriangleCount));
+	const EFFECT_COUNTERS effects = effectGetCounters();
+	KEYVAL("effectsLive", QString::number(effects.live));
+	KEYVAL("effectsSpawned", QString::number(effects.spawned));
+	KEYVAL("effectsCulled", QString::number(effects.culled));
+	unsigned routeCacheHits, routeCacheMisses;
+	fpathRouteCacheStats(&routeCacheHits, &routeCacheMisses);
+	KEYVAL("fpathRouteCacheHits", QString::number(routeCacheHits));
+	KEYVAL("fpathRouteCacheMisses", QString::number(routeCacheMisses));
 	KEYVAL("allowDesign", B2Q(allowDesign));
 	KEYVAL("includeRedundantDesigns", B2Q(includeRedundantDesigns));
 
@@ -3560,6 +3560,7 @@ static QScriptValue js_hackChangeMe(QScriptContext *context, QScriptEngine *engi
 	int me = context->argument(0).toInt32();
 	SCRIPT_ASSERT_PLAYER(context, me);
 	engine->globalObject().setProperty("me", me);
+	invalidateEventDispatch(engine);
 	return QScriptValue();
 }
 
@@ -3573,6 +3574,7 @@ static QScriptValue js_receiveAllEvents(QScriptContext *context, QScriptEngine *
 	{
 		bool value = context->argument(0).toBool();
 		engine->globalObject().setProperty("isReceivingAllEvents", value, QScriptValue::ReadOnly | QScriptValue::Undeletable);
+		invalidateEventDispatch(engine);
 	}
 	return engine->globalObject().property("isReceivingAllEvents");
 }
@@ -44,6 +44,7 @@ enum SCRIPT_TYPE
 // Private to scripting module functions below
 
 void doNotSaveGlobal(const QString &global);
+void invalidateEventDispatch(QScriptEngine *engine);
 
 void groupRemoveObject(BASE_OBJECT *psObj);
 
@@ -21,6 +21,7 @@
 #include "lib/netplay/netplay.h"
 
 static MersenneTwister gamePseudorandomNumberGenerator;
+static uint32_t gameSeed = 42;
 
 MersenneTwister::MersenneTwister(uint32_t seed)
 	: offset(624)
@@ -80,6 +81,12 @@ void MersenneTwister::generate()
 void gameSRand(uint32_t seed)
 {
 	gamePseudorandomNumberGenerator = MersenneTwister(seed);
+	gameSeed = seed;
+}
+
+uint32_t gameGetSeed()
+{
+	return gameSeed;
 }
 
 uint32_t gameRandU32()
@@ -0,0 +1,290 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2005-2019  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/**
+ * @file replay.cpp
+ *
+ * The replay file holds everything needed to set up the game like the host sent it in NET_OPTIONS,
+ * plus the players and the random seed, as JSON. AI scripts are not run when playing back, since
+ * everything they did is in the recorded game queues, like for any client which is not the host.
+ */
+#include "lib/framework/frame.h"
+#include "lib/framework/wzapp.h"
+#include "lib/framework/wzconfig.h"
+#include "lib/gamelib/gtime.h"
+#include "lib/netplay/netplay.h"
+#include "lib/netplay/netreplay.h"
+
+#include "replay.h"
+#include "ai.h"
+#include "component.h"
+#include "console.h"
+#include "multiplay.h"
+#include "random.h"
+#include "version.h"
+#include "warzoneconfig.h"
+
+#include <time.h>
+#include <algorithm>
+
+static std::string replayFilename;
+static nlohmann::json replaySettings;
+static bool reportedFinished = false;
+
+bool replayRecordStart()
+{
+	if (!war_GetRecordReplays() || NETisReplay())
+	{
+		return false;
+	}
+
+	nlohmann::json settings = nlohmann::json::object();
+	settings["version"] = version_getVersionString();
+	settings["selectedPlayer"] = selectedPlayer;
+	settings["randomSeed"] = gameGetSeed();
+
+	nlohmann::json gameSettings = nlohmann::json::object();
+	gameSettings["type"] = game.type;
+	gameSettings["map"] = game.map;
+	gameSettings["hash"] = game.hash.toString();
+	gameSettings["maxPlayers"] = game.maxPlayers;
+	gameSettings["name"] = game.name;
+	gameSettings["power"] = game.power;
+	gameSettings["base"] = game.base;
+	gameSettings["alliance"] = game.alliance;
+	gameSettings["scavengers"] = game.scavengers;
+	gameSettings["isMapMod"] = game.isMapMod;
+	gameSettings["techLevel"] = game.techLevel;
+	gameSettings["skDiff"] = std::vector<uint8_t>(game.skDiff, game.skDiff + MAX_PLAYERS);
+	gameSettings["flags"] = ingame.flags;
+	nlohmann::json limits = nlohmann::json::array();
+	for (unsigned i = 0; i < ingame.numStructureLimits; ++i)
+	{
+		limits.push_back({ingame.pStructureLimits[i].id, ingame.pStructureLimits[i].limit});
+	}
+	gameSettings["structureLimits"] = limits;
+	settings["game"] = gameSettings;
+
+	nlohmann::json players = nlohmann::json::array();
+	for (unsigned i = 0; i < MAX_PLAYERS; ++i)
+	{
+		const PLAYER &p = NetPlay.players[i];
+		nlohmann::json player = nlohmann::json::object();
+		player["name"] = p.name;
+		player["position"] = p.position;
+		player["colour"] = p.colour;
+		player["allocated"] = p.allocated;
+		player["team"] = p.team;
+		player["ai"] = p.ai;
+		player["difficulty"] = p.difficulty;
+		player["alliances"] = std::vector<uint8_t>(alliances[i], alliances[i] + MAX_PLAYERS);
+		players.push_back(player);
+	}
+	settings["players"] = players;
+
+	time_t aclock;
+	time(&aclock);
+	struct tm *t = localtime(&aclock);
+	char filename[256];
+	snprintf(filename, sizeof(filename), "replay/%04d%02d%02d_%02d%02d%02d_%s_p%u.wzrp", t->tm_year + 1900, t->tm_mon + 1, t->tm_mday, t->tm_hour, t->tm_min, t->tm_sec, game.map, selectedPlayer);
+	return NETreplaySaveStart(filename, settings.dump());
+}
+
+void replayShutdown()
+{
+	NETreplaySaveStop();
+	NETreplayLoadStop();
+	gameTimeSetFastForward(false);
+}
+
+void replaySetFilename(const char *filename)
+{
+	replayFilename = filename;
+}
+
+/// Whether every value replayApplySettings() and replayRandomSeed() read is there, with the right type.
+static bool replayCheckSettings(const nlohmann::json &settings)
+{
+	auto has = [](const nlohmann::json &obj, const char *key, bool (nlohmann::json::*isType)() const noexcept) {
+		return obj.contains(key) && (obj[key].*isType)();
+	};
+	auto hasNumbers = [](const nlohmann::json &obj, const char *key) {
+		return obj.contains(key) && obj[key].is_array()
+		       && std::all_of(obj[key].begin(), obj[key].end(), [](const nlohmann::json &v) { return v.is_number(); });
+	};
+
+	if (!settings.is_object()
+	    || !has(settings, "version", &nlohmann::json::is_string)
+	    || !has(settings, "selectedPlayer", &nlohmann::json::is_number_unsigned)
+	    || !has(settings, "randomSeed", &nlohmann::json::is_number_unsigned)
+	    || !has(settings, "game", &nlohmann::json::is_object)
+	    || !has(settings, "players", &nlohmann::json::is_array)
+	    || settings["selectedPlayer"].get<uint32_t>() >= MAX_PLAYERS)
+	{
+		return false;
+	}
+
+	const nlohmann::json &gameSettings = settings["game"];
+	for (const char *key : {"type", "maxPlayers", "power", "base", "alliance", "techLevel", "flags"})
+	{
+		if (!has(gameSettings, key, &nlohmann::json::is_number))
+		{
+			return false;
+		}
+	}
+	if (!has(gameSettings, "map", &nlohmann::json::is_string)
+	    || !has(gameSettings, "hash", &nlohmann::json::is_string)
+	    || !has(gameSettings, "name", &nlohmann::json::is_string)
+	    || !has(gameSettings, "scavengers", &nlohmann::json::is_boolean)
+	    || !has(gameSettings, "isMapMod", &nlohmann::json::is_boolean)
+	    || !hasNumbers(gameSettings, "skDiff")
+	    || !has(gameSettings, "structureLimits", &nlohmann::json::is_array))
+	{
+		return false;
+	}
+	for (const nlohmann::json &limit : gameSettings["structureLimits"])
+	{
+		if (!limit.is_array() || limit.size() != 2 || !limit[0].is_number() || !limit[1].is_number())
+		{
+			return false;
+		}
+	}
+
+	for (const nlohmann::json &player : settings["players"])
+	{
+		if (!player.is_object()
+		    || !has(player, "name", &nlohmann::json::is_string)
+		    || !has(player, "allocated", &nlohmann::json::is_boolean)
+		    || !hasNumbers(player, "alliances"))
+		{
+			return false;
+		}
+		for (const char *key : {"position", "colour", "team", "ai", "difficulty"})
+		{
+			if (!has(player, key, &nlohmann::json::is_number))
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+bool replayLoad()
+{
+	const char *filename = replayFilename.c_str();
+	std::string settings;
+	if (!NETreplayLoadStart(filename, settings))
+	{
+		return false;
+	}
+	replaySettings = nlohmann::json::parse(settings, nullptr, false);
+	if (!replayCheckSettings(replaySettings))
+	{
+		debug(LOG_ERROR, "Replay %s has a broken game setup", filename);
+		NETreplayLoadStop();
+		return false;
+	}
+	std::string version = replaySettings["version"].get<std::string>();
+	if (version != version_getVersionString())
+	{
+		debug(LOG_WARNING, "Replay was recorded with %s, playing with %s, it may go out of synch", version.c_str(), version_getVersionString());
+	}
+	reportedFinished = false;
+	gameTimeSetFastForward(true);
+	return true;
+}
+
+void replayApplySettings()
+{
+	ASSERT_OR_RETURN(, NETisReplay(), "Not playing a replay");
+	const nlohmann::json &gameSettings = replaySettings["game"];
+	game.type = gameSettings["type"].get<uint8_t>();
+	sstrcpy(game.map, gameSettings["map"].get<std::string>().c_str());
+	game.hash.fromString(gameSettings["hash"].get<std::string>());
+	game.maxPlayers = gameSettings["maxPlayers"].get<uint8_t>();
+	sstrcpy(game.name, gameSettings["name"].get<std::string>().c_str());
+	game.power = gameSettings["power"].get<uint32_t>();
+	game.base = gameSettings["base"].get<uint8_t>();
+	game.alliance = gameSettings["alliance"].get<uint8_t>();
+	game.scavengers = gameSettings["scavengers"].get<bool>();
+	game.isMapMod = gameSettings["isMapMod"].get<bool>();
+	game.techLevel = gameSettings["techLevel"].get<uint32_t>();
+	std::vector<uint8_t> skDiff = gameSettings["skDiff"].get<std::vector<uint8_t>>();
+	std::copy(skDiff.begin(), skDiff.begin() + std::min<size_t>(skDiff.size(), MAX_PLAYERS), game.skDiff);
+
+	if (ingame.numStructureLimits)
+	{
+		ingame.numStructureLimits = 0;
+		free(ingame.pStructureLimits);
+		ingame.pStructureLimits = nullptr;
+	}
+	const nlohmann::json &limits = gameSettings["structureLimits"];
+	ingame.numStructureLimits = limits.size();
+	if (ingame.numStructureLimits)
+	{
+		ingame.pStructureLimits = (MULTISTRUCTLIMITS *)malloc(ingame.numStructureLimits * sizeof(MULTISTRUCTLIMITS));
+	}
+	for (unsigned i = 0; i < ingame.numStructureLimits; ++i)
+	{
+		ingame.pStructureLimits[i].id = limits[i][0].get<uint32_t>();
+		ingame.pStructureLimits[i].limit = limits[i][1].get<uint32_t>();
+	}
+	ingame.flags = gameSettings["flags"].get<uint8_t>();
+
+	const nlohmann::json &players = replaySettings["players"];
+	for (unsigned i = 0; i < MAX_PLAYERS && i < players.size(); ++i)
+	{
+		const nlohmann::json &player = players[i];
+		PLAYER &p = NetPlay.players[i];
+		sstrcpy(p.name, player["name"].get<std::string>().c_str());
+		p.position = player["position"].get<int32_t>();
+		p.allocated = player["allocated"].get<bool>();
+		p.team = player["team"].get<int32_t>();
+		p.ai = player["ai"].get<int8_t>();
+		p.difficulty = player["difficulty"].get<int8_t>();
+		setPlayerColour(i, player["colour"].get<int32_t>());
+		std::vector<uint8_t> playerAlliances = player["alliances"].get<std::vector<uint8_t>>();
+		std::copy(playerAlliances.begin(), playerAlliances.begin() + std::min<size_t>(playerAlliances.size(), MAX_PLAYERS), alliances[i]);
+		ingame.JoiningInProgress[i] = false;
+	}
+
+	selectedPlayer = replaySettings["selectedPlayer"].get<uint32_t>();
+	realSelectedPlayer = selectedPlayer;
+}
+
+uint32_t replayRandomSeed()
+{
+	return replaySettings["randomSeed"].get<uint32_t>();
+}
+
+void replayUpdate()
+{
+	if (!NETisReplay() || !NETreplayFinished() || reportedFinished)
+	{
+		return;
+	}
+	reportedFinished = true;
+	debug(LOG_INFO, "Replay finished at game time %u", gameTime);
+	addConsoleMessage(_("The replay has ended."), DEFAULT_JUSTIFY, SYSTEM_MESSAGE);
+	if (wzIsHeadless())
+	{
+		fprintf(stdout, "Replay finished at game time %u\n", gameTime);
+		wzQuit();
+	}
+}
@@ -0,0 +1,44 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2005-2019  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/** @file
+ *  Game setup for recording and playing back replays, see lib/netplay/netreplay.h and --replay.
+ */
+
+#ifndef __INCLUDED_SRC_REPLAY_H__
+#define __INCLUDED_SRC_REPLAY_H__
+
+#include "lib/framework/types.h"
+
+/// Starts recording the game that is being fired up, if enabled in the configuration.
+bool replayRecordStart();
+/// Stops recording or playing back at the end of the game.
+void replayShutdown();
+
+/// Remembers the replay to play back, see --replay.
+void replaySetFilename(const char *filename);
+/// Opens the replay for playback, when starting the game from the multiplayer options screen.
+bool replayLoad();
+/// Sets up the game and players as they were in the recorded game, after hosting a local game.
+void replayApplySettings();
+/// Seed of the synchronised random number generator in the recorded game.
+uint32_t replayRandomSeed();
+/// Call once per frame while playing back, to notice when the replay has ended.
+void replayUpdate();
+
+#endif // __INCLUDED_SRC_REPLAY_H__
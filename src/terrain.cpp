@@ -33,6 +33,7 @@
 
 #include "lib/framework/frame.h"
 #include "lib/framework/opengl.h"
+#include "lib/framework/wzapp.h"
 #include "lib/ivis_opengl/ivisdef.h"
 #include "lib/ivis_opengl/imd.h"
 #include "lib/ivis_opengl/piefunc.h"
@@ -74,9 +75,18 @@ struct Sector
 	int *textureSize;        ///< The size of the geometry for this layer for each layer
 	int *textureIndexOffset; ///< The offset into the index VBO for the texture for each layer
 	int *textureIndexSize;   ///< The size of the indices for each layer
+	int geometryLodIndexOffset; ///< Like geometryIndexOffset, for the reduced detail triangles
+	int geometryLodIndexSize;
+	int waterLodIndexOffset;    ///< Like waterIndexOffset, for the reduced detail triangles
+	int waterLodIndexSize;
+	int *textureLodIndexOffset; ///< Like textureIndexOffset, for the reduced detail triangles
+	int *textureLodIndexSize;
 	int decalOffset;         ///< Index into the decal VBO
 	int decalSize;           ///< Size of the part of the decal VBO we are going to use
+	float minHeight;         ///< Lowest ground or water height in the sector, for frustum culling
+	float maxHeight;         ///< Highest ground or water height in the sector
 	bool draw;               ///< Do we draw this sector this frame?
+	bool lod;                ///< Do we draw the reduced detail triangles this frame?
 	bool dirty;              ///< Do we need to update the geometry for this sector?
 };
 
@@ -119,6 +129,11 @@ static int sectorSize = 15;
 static int terrainDistance;
 /// How many sectors have we actually got?
 static int xSectors, ySectors;
+/// Sectors further than this from the camera are drawn with two triangles per tile instead of four
+#define TERRAIN_LOD_DISTANCE world_coord(24)
+
+/// Sectors and triangles drawn since terrainGetResetCounts() was last called
+static unsigned int terrainSectorCount = 0, terrainTriangleCount = 0;
 
 /// Did we initialise the terrain renderer yet?
 static bool terrainInitialised = false;
@@ -163,6 +178,8 @@ static void addDrawRangeElements(GLenum mode,
 	ASSERT(mode == GL_TRIANGLES, "not supported");
 	ASSERT(type == GL_UNSIGNED_INT, "not supported");
 
+	terrainTriangleCount += count / 3;
+
 	if (end - start + 1 > GLmaxElementsVertices)
 	{
 		debug(LOG_WARNING, "A single call provided too much vertices, will operate at reduced performance or crash. Decrease the sector size to fix this.");
@@ -485,6 +502,27 @@ static void setSectorDecals(int x, int y, DecalVertex *decaldata, int *decalSize
 	}
 }
 
+/**
+ * Find the height range of the ground and water in a sector, for frustum culling.
+ */
+static void updateSectorBounds(int x, int y)
+{
+	int minHeight = 0, maxHeight = 0;  // Points on the map edge are drawn at height 0
+
+	for (int i = x * sectorSize; i < std::min(x * sectorSize + sectorSize, mapWidth); i++)
+	{
+		for (int j = y * sectorSize; j < std::min(y * sectorSize + sectorSize, mapHeight); j++)
+		{
+			int tileMax, tileMin;
+			getTileMaxMin(i, j, &tileMax, &tileMin);
+			minHeight = std::min(minHeight, tileMin);
+			maxHeight = std::max({maxHeight, tileMax, map_WaterHeight(i, j)});
+		}
+	}
+	sectors[x * ySectors + y].minHeight = minHeight;
+	sectors[x * ySectors + y].maxHeight = maxHeight;
+}
+
 /**
  * Update the sector for when the terrain is changed.
  */
@@ -588,17 +626,23 @@ bool initTerrain()
 	RenderVertex *geometry;
 	RenderVertex *water;
 	DecalVertex *decaldata;
-	int geometrySize, geometryIndexSize;
-	int waterSize, waterIndexSize;
-	int textureSize, textureIndexSize;
-	GLuint *geometryIndex;
-	GLuint *waterIndex;
-	GLuint *textureIndex;
+	int geometrySize, geometryIndexSize, geometryLodIndexSize;
+	int waterSize, waterIndexSize, waterLodIndexSize;
+	int textureSize, textureIndexSize, textureLodIndexSize;
+	GLuint *geometryIndex, *geometryLodIndex;
+	GLuint *waterIndex, *waterLodIndex;
+	GLuint *textureIndex, *textureLodIndex;
 	PIELIGHT *texture;
 	int decalSize;
 	int maxSectorSizeIndices, maxSectorSizeVertices;
 	bool decreasedSize = false;
 
+	if (wzIsHeadless())
+	{
+		// Nothing is drawn, so there is no terrain geometry to build
+		return true;
+	}
+
 	// this information is useful to prevent crashes with buggy opengl implementations
 	glGetIntegerv(GL_MAX_ELEMENTS_VERTICES, &GLmaxElementsVertices);
 	glGetIntegerv(GL_MAX_ELEMENTS_INDICES,  &GLmaxElementsIndices);
@@ -656,14 +700,19 @@ bool initTerrain()
 	////////////////////
 	// fill the geometry part of the sectors
 	geometry = (RenderVertex *)malloc(sizeof(RenderVertex) * xSectors * ySectors * (sectorSize + 1) * (sectorSize + 1) * 2);
-	geometryIndex = (GLuint *)malloc(sizeof(GLuint) * xSectors * ySectors * sectorSize * sectorSize * 12);
+	// room for the reduced detail indices (6 per tile) after the full detail ones (12 per tile)
+	geometryIndex = (GLuint *)malloc(sizeof(GLuint) * xSectors * ySectors * sectorSize * sectorSize * (12 + 6));
+	geometryLodIndex = (GLuint *)malloc(sizeof(GLuint) * xSectors * ySectors * sectorSize * sectorSize * 6);
 	geometrySize = 0;
 	geometryIndexSize = 0;
+	geometryLodIndexSize = 0;
 
 	water = (RenderVertex *)malloc(sizeof(RenderVertex) * xSectors * ySectors * (sectorSize + 1) * (sectorSize + 1) * 2);
-	waterIndex = (GLuint *)malloc(sizeof(GLuint) * xSectors * ySectors * sectorSize * sectorSize * 12);
+	waterIndex = (GLuint *)malloc(sizeof(GLuint) * xSectors * ySectors * sectorSize * sectorSize * (12 + 6));
+	waterLodIndex = (GLuint *)malloc(sizeof(GLuint) * xSectors * ySectors * sectorSize * sectorSize * 6);
 	waterSize = 0;
 	waterIndexSize = 0;
+	waterLodIndexSize = 0;
 	for (x = 0; x < xSectors; x++)
 	{
 		for (y = 0; y < ySectors; y++)
@@ -683,6 +732,9 @@ bool initTerrain()
 			sectors[x * ySectors + y].geometryIndexSize = 0;
 			sectors[x * ySectors + y].waterIndexOffset = waterIndexSize;
 			sectors[x * ySectors + y].waterIndexSize = 0;
+			sectors[x * ySectors + y].geometryLodIndexOffset = geometryLodIndexSize;
+			sectors[x * ySectors + y].waterLodIndexOffset = waterLodIndexSize;
+			updateSectorBounds(x, y);
 
 			for (i = 0; i < sectorSize; i++)
 			{
@@ -705,6 +757,16 @@ bool initTerrain()
 					 * This is the source of the '*2' and '+1' in the index math below.
 					 */
 #define q(i,j,center) ((x*ySectors+y)*(sectorSize+1)*(sectorSize+1)*2 + ((i)*(sectorSize+1)+(j))*2+(center))
+// Reduced detail tile: two triangles between the corners, leaving out the center vertex.
+// The tile edges are the same as at full detail, so neighbouring sectors do not crack.
+#define qLod(index, size) \
+	index[size + 0] = q(i, j, 0); \
+	index[size + 1] = q(i + 1, j, 0); \
+	index[size + 2] = q(i + 1, j + 1, 0); \
+	index[size + 3] = q(i, j, 0); \
+	index[size + 4] = q(i + 1, j + 1, 0); \
+	index[size + 5] = q(i, j + 1, 0); \
+	size += 6
 					// First triangle
 					geometryIndex[geometryIndexSize + 0]  = q(i  , j  , 1);	// Center vertex
 					geometryIndex[geometryIndexSize + 1]  = q(i  , j  , 0);	// Bottom left
@@ -722,6 +784,7 @@ bool initTerrain()
 					geometryIndex[geometryIndexSize + 10] = q(i + 1, j  , 0);	// Bottom right
 					geometryIndex[geometryIndexSize + 11] = q(i + 1, j + 1, 0);	// Top right
 					geometryIndexSize += 12;
+					qLod(geometryLodIndex, geometryLodIndexSize);
 					if (isWater(i + x * sectorSize, j + y * sectorSize))
 					{
 						waterIndex[waterIndexSize + 0]  = q(i  , j  , 1);
@@ -740,13 +803,29 @@ bool initTerrain()
 						waterIndex[waterIndexSize + 10] = q(i + 1, j  , 0);
 						waterIndex[waterIndexSize + 11] = q(i + 1, j + 1, 0);
 						waterIndexSize += 12;
+						qLod(waterLodIndex, waterLodIndexSize);
 					}
 				}
 			}
 			sectors[x * ySectors + y].geometryIndexSize = geometryIndexSize - sectors[x * ySectors + y].geometryIndexOffset;
 			sectors[x * ySectors + y].waterIndexSize = waterIndexSize - sectors[x * ySectors + y].waterIndexOffset;
+			sectors[x * ySectors + y].geometryLodIndexSize = geometryLodIndexSize - sectors[x * ySectors + y].geometryLodIndexOffset;
+			sectors[x * ySectors + y].waterLodIndexSize = waterLodIndexSize - sectors[x * ySectors + y].waterLodIndexOffset;
 		}
 	}
+	// Put the reduced detail indices after all full detail ones, so that neighbouring sectors drawn at
+	// the same detail still have consecutive indices and get batched by addDrawRangeElements.
+	for (x = 0; x < xSectors * ySectors; x++)
+	{
+		sectors[x].geometryLodIndexOffset += geometryIndexSize;
+		sectors[x].waterLodIndexOffset += waterIndexSize;
+	}
+	memcpy(geometryIndex + geometryIndexSize, geometryLodIndex, sizeof(GLuint) * geometryLodIndexSize);
+	geometryIndexSize += geometryLodIndexSize;
+	free(geometryLodIndex);
+	memcpy(waterIndex + waterIndexSize, waterLodIndex, sizeof(GLuint) * waterLodIndexSize);
+	waterIndexSize += waterLodIndexSize;
+	free(waterLodIndex);
 	if (geometryVBO)
 		delete geometryVBO;
 	geometryVBO = gfx_api::context::get().create_buffer_object(gfx_api::buffer::usage::vertex_buffer, gfx_api::context::buffer_storage_hint::dynamic_draw);
@@ -776,9 +855,11 @@ bool initTerrain()
 	////////////////////
 	// fill the texture part of the sectors
 	texture = (PIELIGHT *)malloc(sizeof(PIELIGHT) * xSectors * ySectors * (sectorSize + 1) * (sectorSize + 1) * 2 * numGroundTypes);
-	textureIndex = (GLuint *)malloc(sizeof(GLuint) * xSectors * ySectors * sectorSize * sectorSize * 12 * numGroundTypes);
+	textureIndex = (GLuint *)malloc(sizeof(GLuint) * xSectors * ySectors * sectorSize * sectorSize * (12 + 6) * numGroundTypes);
+	textureLodIndex = (GLuint *)malloc(sizeof(GLuint) * xSectors * ySectors * sectorSize * sectorSize * 6 * numGroundTypes);
 	textureSize = 0;
 	textureIndexSize = 0;
+	textureLodIndexSize = 0;
 	for (layer = 0; layer < numGroundTypes; layer++)
 	{
 		for (x = 0; x < xSectors; x++)
@@ -791,12 +872,15 @@ bool initTerrain()
 					sectors[x * ySectors + y].textureSize = (int *)malloc(sizeof(int) * numGroundTypes);
 					sectors[x * ySectors + y].textureIndexOffset = (int *)malloc(sizeof(int) * numGroundTypes);
 					sectors[x * ySectors + y].textureIndexSize = (int *)malloc(sizeof(int) * numGroundTypes);
+					sectors[x * ySectors + y].textureLodIndexOffset = (int *)malloc(sizeof(int) * numGroundTypes);
+					sectors[x * ySectors + y].textureLodIndexSize = (int *)malloc(sizeof(int) * numGroundTypes);
 				}
 
 				sectors[x * ySectors + y].textureOffset[layer] = textureSize;
 				sectors[x * ySectors + y].textureSize[layer] = 0;
 				sectors[x * ySectors + y].textureIndexOffset[layer] = textureIndexSize;
 				sectors[x * ySectors + y].textureIndexSize[layer] = 0;
+				sectors[x * ySectors + y].textureLodIndexOffset[layer] = textureLodIndexSize;
 				//debug(LOG_WARNING, "offset when filling %i: %i", layer, xSectors*ySectors*(sectorSize+1)*(sectorSize+1)*2*layer);
 				for (i = 0; i < sectorSize + 1; i++)
 				{
@@ -866,15 +950,27 @@ bool initTerrain()
 							textureIndex[textureIndexSize + 10] = q(i + 1, j  , 0);
 							textureIndex[textureIndexSize + 11] = q(i + 1, j + 1, 0);
 							textureIndexSize += 12;
+							qLod(textureLodIndex, textureLodIndexSize);
 						}
 
 					}
 				}
 				sectors[x * ySectors + y].textureSize[layer] = textureSize - sectors[x * ySectors + y].textureOffset[layer];
 				sectors[x * ySectors + y].textureIndexSize[layer] = textureIndexSize - sectors[x * ySectors + y].textureIndexOffset[layer];
+				sectors[x * ySectors + y].textureLodIndexSize[layer] = textureLodIndexSize - sectors[x * ySectors + y].textureLodIndexOffset[layer];
 			}
 		}
 	}
+	for (x = 0; x < xSectors * ySectors; x++)
+	{
+		for (layer = 0; layer < numGroundTypes; layer++)
+		{
+			sectors[x].textureLodIndexOffset[layer] += textureIndexSize;
+		}
+	}
+	memcpy(textureIndex + textureIndexSize, textureLodIndex, sizeof(GLuint) * textureLodIndexSize);
+	textureIndexSize += textureLodIndexSize;
+	free(textureLodIndex);
 	if (textureVBO)
 		delete textureVBO;
 	textureVBO = gfx_api::context::get().create_buffer_object(gfx_api::buffer::usage::vertex_buffer);
@@ -950,6 +1046,10 @@ bool initTerrain()
 /// free all memory and opengl buffers used by the terrain renderer
 void shutdownTerrain()
 {
+	if (wzIsHeadless())
+	{
+		return;
+	}
 	if (!sectors)
 	{
 		// This happens in some cases when loading a savegame from level init
@@ -979,6 +1079,8 @@ void shutdownTerrain()
 			free(sectors[x * ySectors + y].textureSize);
 			free(sectors[x * ySectors + y].textureIndexOffset);
 			free(sectors[x * ySectors + y].textureIndexSize);
+			free(sectors[x * ySectors + y].textureLodIndexOffset);
+			free(sectors[x * ySectors + y].textureLodIndexSize);
 		}
 	}
 	free(sectors);
@@ -1060,27 +1162,58 @@ static void updateLightMap()
 	}
 }
 
-static void cullTerrain()
+/// Is the box, in the coordinates the terrain geometry is in, at least partly inside the view frustum of ModelViewProjection?
+static bool boxInFrustum(const glm::mat4 &ModelViewProjection, const glm::vec3 &boxMin, const glm::vec3 &boxMax)
+{
+	const glm::mat4 m = glm::transpose(ModelViewProjection);  // rows of the matrix
+	const glm::vec4 planes[6] = {m[3] + m[0], m[3] - m[0], m[3] + m[1], m[3] - m[1], m[3] + m[2], m[3] - m[2]};
+	for (const glm::vec4 &plane : planes)
+	{
+		// The corner of the box furthest along the plane normal
+		const glm::vec3 corner(plane.x >= 0 ? boxMax.x : boxMin.x, plane.y >= 0 ? boxMax.y : boxMin.y, plane.z >= 0 ? boxMax.z : boxMin.z);
+		if (glm::dot(glm::vec3(plane), corner) + plane.w < 0)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+static void cullTerrain(const glm::mat4 &ModelViewProjection)
 {
+	// The camera is where the view projection sends to infinity
+	const glm::vec4 eyeHomogeneous = glm::inverse(ModelViewProjection) * glm::vec4(0.f, 0.f, 1.f, 0.f);
+	const glm::vec3 eye = glm::vec3(eyeHomogeneous) / eyeHomogeneous.w;
+
 	for (int x = 0; x < xSectors; x++)
 	{
 		for (int y = 0; y < ySectors; y++)
 		{
+			Sector &sector = sectors[x * ySectors + y];
 			float xPos = world_coord(x * sectorSize + sectorSize / 2);
 			float yPos = world_coord(y * sectorSize + sectorSize / 2);
 			float distance = pow(player.p.x - xPos, 2) + pow(player.p.z - yPos, 2);
 
-			if (distance > pow((double)world_coord(terrainDistance), 2))
+			if (sector.dirty)
+			{
+				updateSectorBounds(x, y);
+			}
+			const glm::vec3 boxMin(world_coord(x * sectorSize), sector.minHeight, -world_coord((y + 1) * sectorSize));
+			const glm::vec3 boxMax(world_coord((x + 1) * sectorSize), sector.maxHeight, -world_coord(y * sectorSize));
+
+			if (distance > pow((double)world_coord(terrainDistance), 2) || !boxInFrustum(ModelViewProjection, boxMin, boxMax))
 			{
-				sectors[x * ySectors + y].draw = false;
+				sector.draw = false;
 			}
 			else
 			{
-				sectors[x * ySectors + y].draw = true;
-				if (sectors[x * ySectors + y].dirty)
+				sector.draw = true;
+				sector.lod = glm::distance(glm::clamp(eye, boxMin, boxMax), eye) > TERRAIN_LOD_DISTANCE;
+				++terrainSectorCount;
+				if (sector.dirty)
 				{
 					updateSectorGeometry(x, y);
-					sectors[x * ySectors + y].dirty = false;
+					sector.dirty = false;
 				}
 			}
 		}
@@ -1115,14 +1248,15 @@ static void drawDepthOnly(const glm::mat4 &ModelViewProjection, const glm::vec4
 	{
 		for (int y = 0; y < ySectors; y++)
 		{
-			if (sectors[x * ySectors + y].draw)
+			const Sector &sector = sectors[x * ySectors + y];
+			if (sector.draw)
 			{
 				addDrawRangeElements(GL_TRIANGLES,
-					sectors[x * ySectors + y].geometryOffset,
-					sectors[x * ySectors + y].geometryOffset + sectors[x * ySectors + y].geometrySize,
-					sectors[x * ySectors + y].geometryIndexSize,
+					sector.geometryOffset,
+					sector.geometryOffset + sector.geometrySize,
+					sector.lod ? sector.geometryLodIndexSize : sector.geometryIndexSize,
 					GL_UNSIGNED_INT,
-					sectors[x * ySectors + y].geometryIndexOffset);
+					sector.lod ? sector.geometryLodIndexOffset : sector.geometryIndexOffset);
 			}
 		}
 	}
@@ -1192,14 +1326,15 @@ static void drawTerrainLayers(const glm::mat4 &ModelViewProjection, const glm::v
 		{
 			for (int y = 0; y < ySectors; y++)
 			{
-				if (sectors[x * ySectors + y].draw)
+				const Sector &sector = sectors[x * ySectors + y];
+				if (sector.draw)
 				{
 					addDrawRangeElements(GL_TRIANGLES,
-						sectors[x * ySectors + y].geometryOffset,
-						sectors[x * ySectors + y].geometryOffset + sectors[x * ySectors + y].geometrySize,
-						sectors[x * ySectors + y].textureIndexSize[layer],
+						sector.geometryOffset,
+						sector.geometryOffset + sector.geometrySize,
+						sector.lod ? sector.textureLodIndexSize[layer] : sector.textureIndexSize[layer],
 						GL_UNSIGNED_INT,
-						sectors[x * ySectors + y].textureIndexOffset[layer]);
+						sector.lod ? sector.textureLodIndexOffset[layer] : sector.textureIndexOffset[layer]);
 				}
 			}
 		}
@@ -1255,6 +1390,7 @@ static void drawDecals(const glm::mat4 &ModelViewProjection, const glm::vec4 &pa
 			if (size > 0)
 			{
 				glDrawArrays(GL_TRIANGLES, offset, size);
+				terrainTriangleCount += size / 3;
 			}
 			size = 0;
 			if (y < ySectors && sectors[x * ySectors + y].draw)
@@ -1300,7 +1436,7 @@ void drawTerrain(const glm::mat4 &mvp)
 
 	///////////////////////////////////
 	// terrain culling
-	cullTerrain();
+	cullTerrain(mvp);
 
 	glActiveTexture(GL_TEXTURE0);
 
@@ -1370,14 +1506,15 @@ void drawWater(const glm::mat4 &viewMatrix)
 	{
 		for (y = 0; y < ySectors; y++)
 		{
-			if (sectors[x * ySectors + y].draw)
+			const Sector &sector = sectors[x * ySectors + y];
+			if (sector.draw)
 			{
 				addDrawRangeElements(GL_TRIANGLES,
-				                     sectors[x * ySectors + y].geometryOffset,
-				                     sectors[x * ySectors + y].geometryOffset + sectors[x * ySectors + y].geometrySize,
-				                     sectors[x * ySectors + y].waterIndexSize,
+				                     sector.geometryOffset,
+				                     sector.geometryOffset + sector.geometrySize,
+				                     sector.lod ? sector.waterLodIndexSize : sector.waterIndexSize,
 				                     GL_UNSIGNED_INT,
-				                     sectors[x * ySectors + y].waterIndexOffset);
+				                     sector.lod ? sector.waterLodIndexOffset : sector.waterIndexOffset);
 			}
 		}
 	}
@@ -1402,3 +1539,12 @@ void drawWater(const glm::mat4 &viewMatrix)
 
 	//glBindBuffer(GL_ARRAY_BUFFER, 0);  // HACK Must unbind GL_ARRAY_BUFFER (don't know if it has to be unbound everywhere), otherwise text rendering may mysteriously crash.
 }
+
+void terrainGetResetCounts(unsigned int *pSectors, unsigned int *pTriangles)
+{
+	*pSectors = terrainSectorCount;
+	*pTriangles = terrainTriangleCount;
+
+	terrainSectorCount = 0;
+	terrainTriangleCount = 0;
+}
@@ -35,4 +35,7 @@ void setTileColour(int x, int y, PIELIGHT colour);
 
 void markTileDirty(int i, int j);
 
+/** Terrain sectors drawn, and triangles submitted for them, since the last call. */
+void terrainGetResetCounts(unsigned int *pSectors, unsigned int *pTriangles);
+
 #endif
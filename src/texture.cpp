@@ -24,6 +24,7 @@
  */
 
 #include "lib/framework/frame.h"
+#include "lib/framework/wzapp.h"
 #include "lib/framework/opengl.h"
 
 #include <string.h>
@@ -131,7 +132,11 @@ bool texLoad(const char *fileName)
 	mipmap_max = MIPMAP_MAX;
 	mipmap_levels = MIPMAP_LEVELS;
 
-	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &glval);
+	glval = mipmap_max * TILES_IN_PAGE_COLUMN;
+	if (!wzIsHeadless())
+	{
+		glGetIntegerv(GL_MAX_TEXTURE_SIZE, &glval);
+	}
 
 	while (glval < mipmap_max * TILES_IN_PAGE_COLUMN)
 	{
@@ -179,6 +184,12 @@ bool texLoad(const char *fileName)
 	while (k >= 3 && j + 6 < size);
 	free(buffer);
 
+	if (wzIsHeadless())
+	{
+		// Only the radar colours are used without a renderer
+		return true;
+	}
+
 	/* Now load the actual tiles */
 
 	i = mipmap_max; // i is used to keep track of the tile dimensions
@@ -24,6 +24,8 @@
  */
 #include "lib/framework/frame.h"
 #include "lib/framework/fixedpoint.h"
+#include "lib/framework/math_ext.h"
+#include "lib/framework/wzapp.h"
 
 #include "lib/gamelib/gtime.h"
 #include "lib/sound/audio.h"
@@ -47,6 +49,9 @@
 #include "multiplay.h"
 #include "qtscript.h"
 #include "wavecast.h"
+#include "warzoneconfig.h"
+
+#include <atomic>
 
 // accuracy for the height gradient
 #define GRAD_MUL 10000
@@ -99,8 +104,34 @@ struct VisibleObjectHelp_t
 static int *gNumWalls = nullptr;
 static Vector2i *gWall = nullptr;
 
+/// Objects which a viewer might see, and where to store the results of visibleObject().
+struct VisViewerJob
+{
+	BASE_OBJECT *psViewer;
+	unsigned firstCandidate, lastCandidate;  ///< Range in visCandidates and visValues.
+};
+
+// Parallel line of sight checks. The threads only fill in visValues, which is then applied in the same order as the serial version would.
+static std::vector<WZ_THREAD *> visThreads;
+static WZ_SEMAPHORE *visStartSemaphore = nullptr;
+static WZ_SEMAPHORE *visDoneSemaphore = nullptr;
+static bool visThreadsQuit = false;
+static std::vector<VisViewerJob> visJobs;
+static std::vector<BASE_OBJECT *> visCandidates;
+static std::vector<uint8_t> visValues;
+static std::atomic<unsigned> visNextJob;
+static bool visSelfCheck = false;  ///< Whether to recheck the results of the threads on the main thread.
+
+// Sensors by player, rebuilt when apsSensorList changes, and active radars by map region, rebuilt every tick for the radar detectors.
+#define RADAR_REGION_TILES 16
+static std::vector<SensorRef> sensorsByPlayer[MAX_PLAYERS];
+static bool sensorIndexValid = false;
+static std::vector<std::vector<BASE_OBJECT *>> radarRegions;
+static int radarRegionsX = 0, radarRegionsY = 0;
+
 // forward declarations
 static void setSeenBy(BASE_OBJECT *psObj, unsigned viewer, int val);
+static int visThreadFunc(void *);
 
 // initialise the visibility stuff
 bool visInitialise()
@@ -108,9 +139,74 @@ bool visInitialise()
 	visLevelInc = 1;
 	visLevelDec = 0;
 
+	ASSERT(visThreads.empty(), "visInitialise already called, without calling visShutdown.");
+	int numThreads = war_GetVisibilityThreads();
+	if (numThreads == 0)
+	{
+		numThreads = wzGetCPUCount();
+	}
+	if (numThreads > 1)
+	{
+		visThreadsQuit = false;
+		visStartSemaphore = wzSemaphoreCreate(0);
+		visDoneSemaphore = wzSemaphoreCreate(0);
+		for (int i = 1; i < numThreads; ++i)  // The main thread helps too.
+		{
+			WZ_THREAD *thread = wzThreadCreate(visThreadFunc, nullptr);
+			wzThreadStart(thread);
+			visThreads.push_back(thread);
+		}
+		debug(LOG_INFO, "Checking line of sight on %d threads", numThreads);
+	}
+
 	return true;
 }
 
+void visShutdown()
+{
+	if (!visThreads.empty())
+	{
+		visThreadsQuit = true;
+		for (size_t i = 0; i < visThreads.size(); ++i)
+		{
+			wzSemaphorePost(visStartSemaphore);  // Wake up threads, so they can quit.
+		}
+		for (WZ_THREAD *thread : visThreads)
+		{
+			wzThreadJoin(thread);
+		}
+		visThreads.clear();
+		wzSemaphoreDestroy(visStartSemaphore);
+		visStartSemaphore = nullptr;
+		wzSemaphoreDestroy(visDoneSemaphore);
+		visDoneSemaphore = nullptr;
+	}
+	visJobs.clear();
+	visCandidates.clear();
+	visValues.clear();
+	for (auto &sensors : sensorsByPlayer)
+	{
+		sensors.clear();
+	}
+	sensorIndexValid = false;
+	radarRegions.clear();
+}
+
+void visSetSelfCheck(bool check)
+{
+	visSelfCheck = check;
+}
+
+bool visGetSelfCheck()
+{
+	return visSelfCheck;
+}
+
+bool visIsParallel()
+{
+	return !visThreads.empty();
+}
+
 // update the visibility change levels
 void visUpdateLevel()
 {
@@ -757,6 +853,110 @@ static void processVisibilityVision(BASE_OBJECT *psViewer)
 	}
 }
 
+// Check line of sight for the jobs not yet taken by another thread. Only reads the game state, except for visValues.
+static void visProcessJobs()
+{
+	const unsigned numJobs = visJobs.size();
+	const unsigned jobsPerTake = 8;
+	for (unsigned first = visNextJob.fetch_add(jobsPerTake); first < numJobs; first = visNextJob.fetch_add(jobsPerTake))
+	{
+		for (unsigned job = first; job < std::min(first + jobsPerTake, numJobs); ++job)
+		{
+			BASE_OBJECT *psViewer = visJobs[job].psViewer;
+			for (unsigned i = visJobs[job].firstCandidate; i < visJobs[job].lastCandidate; ++i)
+			{
+				visValues[i] = visibleObject(psViewer, visCandidates[i], false);
+			}
+		}
+	}
+}
+
+static int visThreadFunc(void *)
+{
+	while (true)
+	{
+		wzSemaphoreWait(visStartSemaphore);  // Go to sleep until needed.
+		if (visThreadsQuit)
+		{
+			break;
+		}
+		visProcessJobs();
+		wzSemaphorePost(visDoneSemaphore);  // Signal that we are done.
+	}
+	return 0;
+}
+
+// Same as calling processVisibilityVision on all droids and structures, but with the line of sight checks done on several threads.
+// Objects only ever become more seen during this pass, so searching for all objects which are unseen before starting, and then skipping
+// the ones which became fully seen before their turn gives the same objects in the same order as the serial version.
+static void processVisibilityVisionParallel()
+{
+	static GridList gridList;  // static to avoid allocations.
+	visJobs.clear();
+	visCandidates.clear();
+	for (int player = 0; player < MAX_PLAYERS; ++player)
+	{
+		BASE_OBJECT *lists[] = {apsDroidLists[player], apsStructLists[player]};
+		for (BASE_OBJECT *list : lists)
+		{
+			for (BASE_OBJECT *psViewer = list; psViewer != nullptr; psViewer = psViewer->psNext)
+			{
+				VisViewerJob job;
+				job.psViewer = psViewer;
+				job.firstCandidate = visCandidates.size();
+				gridList = gridStartIterateUnseen(psViewer->pos.x, psViewer->pos.y, objSensorRange(psViewer), psViewer->player);
+				visCandidates.insert(visCandidates.end(), gridList.begin(), gridList.end());
+				job.lastCandidate = visCandidates.size();
+				visJobs.push_back(job);
+			}
+		}
+	}
+	visValues.resize(visCandidates.size());
+
+	visNextJob = 0;
+	for (size_t i = 0; i < visThreads.size(); ++i)
+	{
+		wzSemaphorePost(visStartSemaphore);
+	}
+	visProcessJobs();
+	for (size_t i = 0; i < visThreads.size(); ++i)
+	{
+		wzSemaphoreWait(visDoneSemaphore);
+	}
+
+	// Apply the results in the original order, since seenThisTick and the script events depend on it.
+	for (VisViewerJob const &job : visJobs)
+	{
+		BASE_OBJECT *psViewer = job.psViewer;
+		for (unsigned i = job.firstCandidate; i < job.lastCandidate; ++i)
+		{
+			BASE_OBJECT *psObj = visCandidates[i];
+			if (psObj->seenThisTick[psViewer->player] == UBYTE_MAX)
+			{
+				continue;  // Would have been filtered out by gridStartIterateUnseen, if searching now.
+			}
+
+			int val = visValues[i];
+			if (visSelfCheck)
+			{
+				int serialVal = visibleObject(psViewer, psObj, false);
+				ASSERT(val == serialVal, "Parallel visibility of object %u by object %u was %d, but should be %d.", psObj->id, psViewer->id, val, serialVal);
+				val = serialVal;
+			}
+
+			// If we've got ranged line of sight...
+			if (val > 0)
+			{
+				// Tell system that this side can see this object
+				setSeenBy(psObj, psViewer->player, val);
+
+				// Check if scripting system wants to trigger an event for this
+				triggerEventSeen(psViewer, psObj);
+			}
+		}
+	}
+}
+
 /* Find out what can see this object */
 // Fade in/out of view. Must be called after calculation of which objects are seen.
 static void processVisibilityLevel(BASE_OBJECT *psObj)
@@ -835,48 +1035,125 @@ static void processVisibilityLevel(BASE_OBJECT *psObj)
 	}
 }
 
-void processVisibility()
+void visSensorListChanged()
 {
-	updateSpotters();
-	for (int player = 0; player < MAX_PLAYERS; ++player)
+	sensorIndexValid = false;
+}
+
+std::vector<SensorRef> const &visSensorsOfPlayer(unsigned player)
+{
+	if (!sensorIndexValid)
 	{
-		BASE_OBJECT *lists[] = {apsDroidLists[player], apsStructLists[player], apsFeatureLists[player]};
-		unsigned list;
-		for (list = 0; list < sizeof(lists) / sizeof(*lists); ++list)
+		for (auto &sensors : sensorsByPlayer)
 		{
-			for (BASE_OBJECT *psObj = lists[list]; psObj != nullptr; psObj = psObj->psNext)
+			sensors.clear();
+		}
+		unsigned order = 0;
+		for (BASE_OBJECT *psObj = apsSensorList[0]; psObj != nullptr; psObj = psObj->psNextFunc)
+		{
+			ASSERT_OR_RETURN(sensorsByPlayer[0], psObj->player < MAX_PLAYERS, "Bad sensor owner %d", (int)psObj->player);
+			sensorsByPlayer[psObj->player].push_back(SensorRef{psObj, order++});
+		}
+		sensorIndexValid = true;
+	}
+	return sensorsByPlayer[player];
+}
+
+static void radarRegionClip(int x, int y, int *regionX, int *regionY)
+{
+	*regionX = clip(map_coord(x) / RADAR_REGION_TILES, 0, radarRegionsX - 1);
+	*regionY = clip(map_coord(y) / RADAR_REGION_TILES, 0, radarRegionsY - 1);
+}
+
+/// Lets radar detectors see the active radars in their range, looking only in the regions in range.
+static void processVisibilityRadarDetectors()
+{
+	static std::vector<BASE_OBJECT *> detectors;  // static to avoid allocations.
+	detectors.clear();
+
+	radarRegionsX = (mapWidth + RADAR_REGION_TILES - 1) / RADAR_REGION_TILES;
+	radarRegionsY = (mapHeight + RADAR_REGION_TILES - 1) / RADAR_REGION_TILES;
+	radarRegions.resize(radarRegionsX * radarRegionsY);
+	for (auto &region : radarRegions)
+	{
+		region.clear();
+	}
+	for (BASE_OBJECT *psObj = apsSensorList[0]; psObj != nullptr; psObj = psObj->psNextFunc)
+	{
+		if (objRadarDetector(psObj))
+		{
+			detectors.push_back(psObj);
+		}
+		if (objActiveRadar(psObj))
+		{
+			int regionX, regionY;
+			radarRegionClip(psObj->pos.x, psObj->pos.y, &regionX, &regionY);
+			radarRegions[regionX + regionY * radarRegionsX].push_back(psObj);
+		}
+	}
+	if (detectors.empty())
+	{
+		return;
+	}
+
+	for (BASE_OBJECT *psObj : detectors)
+	{
+		const int range = objSensorRange(psObj) * 10;
+		int minX, minY, maxX, maxY;
+		radarRegionClip(psObj->pos.x - range, psObj->pos.y - range, &minX, &minY);
+		radarRegionClip(psObj->pos.x + range, psObj->pos.y + range, &maxX, &maxY);
+		for (int regionY = minY; regionY <= maxY; ++regionY)
+		{
+			for (int regionX = minX; regionX <= maxX; ++regionX)
 			{
-				processVisibilitySelf(psObj);
+				for (BASE_OBJECT *psTarget : radarRegions[regionX + regionY * radarRegionsX])
+				{
+					if (psObj != psTarget && psTarget->visible[psObj->player] < UBYTE_MAX / 2
+					    && iHypot((psTarget->pos - psObj->pos).xy()) < range)
+					{
+						psTarget->visible[psObj->player] = UBYTE_MAX / 2;
+					}
+				}
 			}
 		}
 	}
+}
+
+void processVisibility()
+{
+	updateSpotters();
 	for (int player = 0; player < MAX_PLAYERS; ++player)
 	{
-		BASE_OBJECT *lists[] = {apsDroidLists[player], apsStructLists[player]};
+		BASE_OBJECT *lists[] = {apsDroidLists[player], apsStructLists[player], apsFeatureLists[player]};
 		unsigned list;
 		for (list = 0; list < sizeof(lists) / sizeof(*lists); ++list)
 		{
 			for (BASE_OBJECT *psObj = lists[list]; psObj != nullptr; psObj = psObj->psNext)
 			{
-				processVisibilityVision(psObj);
+				processVisibilitySelf(psObj);
 			}
 		}
 	}
-	for (BASE_OBJECT *psObj = apsSensorList[0]; psObj != nullptr; psObj = psObj->psNextFunc)
+	if (visIsParallel())
 	{
-		if (objRadarDetector(psObj))
+		processVisibilityVisionParallel();
+	}
+	else
+	{
+		for (int player = 0; player < MAX_PLAYERS; ++player)
 		{
-			for (BASE_OBJECT *psTarget = apsSensorList[0]; psTarget != nullptr; psTarget = psTarget->psNextFunc)
+			BASE_OBJECT *lists[] = {apsDroidLists[player], apsStructLists[player]};
+			unsigned list;
+			for (list = 0; list < sizeof(lists) / sizeof(*lists); ++list)
 			{
-				if (psObj != psTarget && psTarget->visible[psObj->player] < UBYTE_MAX / 2
-				    && objActiveRadar(psTarget)
-				    && iHypot((psTarget->pos - psObj->pos).xy()) < objSensorRange(psObj) * 10)
+				for (BASE_OBJECT *psObj = lists[list]; psObj != nullptr; psObj = psObj->psNext)
 				{
-					psTarget->visible[psObj->player] = UBYTE_MAX / 2;
+					processVisibilityVision(psObj);
 				}
 			}
 		}
 	}
+	processVisibilityRadarDetectors();
 	for (int player = 0; player < MAX_PLAYERS; ++player)
 	{
 		BASE_OBJECT *lists[] = {apsDroidLists[player], apsStructLists[player], apsFeatureLists[player]};
@@ -25,10 +25,19 @@
 #include "raycast.h"
 #include "stats.h"
 
+#include <vector>
+
 #define LINE_OF_FIRE_MINIMUM 5
 
 // initialise the visibility stuff
 bool visInitialise();
+void visShutdown();
+
+/// Whether line of sight is checked on several threads (set by the visibilityThreads option).
+bool visIsParallel();
+/// Whether to recheck the line of sight checks done on other threads, and assert if they differ.
+void visSetSelfCheck(bool check);
+bool visGetSelfCheck();
 
 /* Check which tiles can be seen by an object */
 void visTilesUpdate(BASE_OBJECT *psObj);
@@ -58,6 +67,18 @@ bool hasSharedVision(unsigned viewer, unsigned ally);
 
 void processVisibility();  ///< Calls processVisibilitySelf and processVisibilityVision on all objects.
 
+/// A sensor, and its place in apsSensorList.
+struct SensorRef
+{
+	BASE_OBJECT *psObj;
+	unsigned order;
+};
+
+/// The sensors in apsSensorList belonging to a player, in the same order.
+std::vector<SensorRef> const &visSensorsOfPlayer(unsigned player);
+/// Must be called whenever an object is added to or removed from apsSensorList, the objects in it are freed, or the list is swapped out.
+void visSensorListChanged();
+
 // update the visibility reduction
 void visUpdateLevel();
 
@@ -58,6 +58,11 @@ struct WARZONE_GLOBALS
 	int cameraSpeed = CAMERASPEED_DEFAULT;
 	int scrollEvent = 0; // map/radar zoom
 	bool radarJump = false;
+	int pathThreads = 0; // 0 = one less than the number of cores
+	bool hierarchicalPathfinding = false;
+	int visibilityThreads = 1; // 1 = no extra threads, 0 = one per core
+	bool recordReplays = false;
+	bool binarySaves = false;
 };
 
 static WARZONE_GLOBALS warGlobs;
@@ -311,3 +316,53 @@ void war_SetRadarJump(bool radarJump)
 {
 	warGlobs.radarJump = radarJump;
 }
+
+int war_GetPathThreads()
+{
+	return warGlobs.pathThreads;
+}
+
+void war_SetPathThreads(int threads)
+{
+	warGlobs.pathThreads = std::max(threads, 0);
+}
+
+bool war_GetHierarchicalPathfinding()
+{
+	return warGlobs.hierarchicalPathfinding;
+}
+
+void war_SetHierarchicalPathfinding(bool enabled)
+{
+	warGlobs.hierarchicalPathfinding = enabled;
+}
+
+int war_GetVisibilityThreads()
+{
+	return warGlobs.visibilityThreads;
+}
+
+void war_SetVisibilityThreads(int threads)
+{
+	warGlobs.visibilityThreads = std::max(threads, 0);
+}
+
+bool war_GetRecordReplays()
+{
+	return warGlobs.recordReplays;
+}
+
+void war_SetRecordReplays(bool enabled)
+{
+	warGlobs.recordReplays = enabled;
+}
+
+bool war_GetBinarySaves()
+{
+	return warGlobs.binarySaves;
+}
+
+void war_SetBinarySaves(bool enabled)
+{
+	warGlobs.binarySaves = enabled;
+}
@@ -85,6 +85,16 @@ int war_GetRadarZoom();
 void war_SetRadarZoom(int radarZoom);
 bool war_GetRadarJump();
 void war_SetRadarJump(bool radarJump);
+int war_GetPathThreads();
+void war_SetPathThreads(int threads);
+bool war_GetHierarchicalPathfinding();
+void war_SetHierarchicalPathfinding(bool enabled);
+int war_GetVisibilityThreads();
+void war_SetVisibilityThreads(int threads);
+bool war_GetRecordReplays();
+void war_SetRecordReplays(bool enabled);
+bool war_GetBinarySaves();
+void war_SetBinarySaves(bool enabled);
 int war_GetCameraSpeed();
 void war_SetCameraSpeed(int cameraSpeed);
 int war_GetScrollEvent();